@@ -0,0 +1,505 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+/*
+ * Compares two results files written by bench_suite_write_json, usually one
+ * from before a change and one from after:
+ *
+ *   ILC_REPORT_DIR=build/before make bench
+ *   (make the change)
+ *   ILC_REPORT_DIR=build/after make bench
+ *   build/bench/bench_compare build/before/string_benchmarks.json build/after/string_benchmarks.json
+ *
+ * Each benchmark's repetitions in the two files are compared with a
+ * Mann-Whitney U test, which doesn't assume the times are normally
+ * distributed. A benchmark has regressed when the difference is significant
+ * and its median got slower by more than the threshold. Exits 1 if any
+ * benchmark regressed, 2 if the files couldn't be read, and 0 otherwise.
+ */
+
+#define DEFAULT_ALPHA 0.05
+#define DEFAULT_THRESHOLD 5.0  /* percent */
+
+typedef enum {
+    JSON_NULL,
+    JSON_BOOL,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT
+} JsonType;
+
+typedef struct _json_value {
+    JsonType type;
+    double number;  /* also 0 or 1 for bools */
+    char *string;
+    char **keys;  /* names of an object's members, parallel to items */
+    struct _json_value **items;
+    size_t num_items;
+} JsonValue;
+
+typedef struct {
+    const char *name;
+    double median;  /* ns per iteration */
+    double *samples;
+    size_t num_samples;
+} BenchResult;
+
+
+/* just enough JSON for files bench_suite_write_json writes */
+
+static JsonValue *parse_value(const char **text);
+
+static void free_json(JsonValue *value) {
+    if (value == NULL) {
+        return;
+    }
+
+    size_t i;
+    for (i = 0; i < value->num_items; i++) {
+        free_json(value->items[i]);
+        if (value->keys != NULL) {
+            free(value->keys[i]);
+        }
+    }
+
+    free(value->string);
+    free(value->keys);
+    free(value->items);
+    free(value);
+}
+
+static void skip_space(const char **text) {
+    while (isspace((unsigned char) **text)) {
+        (*text)++;
+    }
+}
+
+static char *parse_string(const char **text) {
+    if (**text != '"') {
+        return NULL;
+    }
+    (*text)++;
+
+    char *str = malloc(strlen(*text) + 1);  /* escapes only ever shrink */
+    if (str == NULL) {
+        return NULL;
+    }
+
+    size_t len = 0;
+    while (**text != '"') {
+        char c = **text;
+        if (c == '\0') {
+            free(str);
+            return NULL;
+        }
+
+        if (c == '\\') {
+            (*text)++;
+            switch (**text) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'u': {  /* only control characters are written this way */
+                    char hex[5] = {0};
+                    int k;
+                    for (k = 0; k < 4 && isxdigit((unsigned char) (*text)[1]); k++) {
+                        hex[k] = *++*text;
+                    }
+                    c = (char) strtol(hex, NULL, 16);
+                    break;
+                }
+                case '\0':
+                    free(str);
+                    return NULL;
+                default: c = **text;  /* \" \\ \/ */
+            }
+        }
+
+        str[len++] = c;
+        (*text)++;
+    }
+
+    (*text)++;
+    str[len] = '\0';
+    return str;
+}
+
+static int append_item(JsonValue *container, JsonValue *item, char *key) {
+    JsonValue **items = realloc(container->items, (container->num_items + 1) * sizeof(JsonValue *));
+    if (items == NULL) {
+        return 0;
+    }
+    container->items = items;
+
+    if (container->type == JSON_OBJECT) {
+        char **keys = realloc(container->keys, (container->num_items + 1) * sizeof(char *));
+        if (keys == NULL) {
+            return 0;
+        }
+        container->keys = keys;
+        container->keys[container->num_items] = key;
+    }
+
+    container->items[container->num_items++] = item;
+    return 1;
+}
+
+/* arrays and objects, text is at the opening bracket */
+static JsonValue *parse_container(const char **text, JsonValue *container, char close) {
+    (*text)++;
+    skip_space(text);
+    if (**text == close) {
+        (*text)++;
+        return container;
+    }
+
+    for (;;) {
+        char *key = NULL;
+        skip_space(text);
+        if (container->type == JSON_OBJECT) {
+            key = parse_string(text);
+            skip_space(text);
+            if (key == NULL || **text != ':') {
+                free(key);
+                free_json(container);
+                return NULL;
+            }
+            (*text)++;
+        }
+
+        JsonValue *item = parse_value(text);
+        if (item == NULL || !append_item(container, item, key)) {
+            free(key);
+            free_json(item);
+            free_json(container);
+            return NULL;
+        }
+
+        skip_space(text);
+        if (**text == ',') {
+            (*text)++;
+        } else if (**text == close) {
+            (*text)++;
+            return container;
+        } else {
+            free_json(container);
+            return NULL;
+        }
+    }
+}
+
+static JsonValue *parse_value(const char **text) {
+    skip_space(text);
+
+    JsonValue *value = calloc(1, sizeof(JsonValue));
+    if (value == NULL) {
+        return NULL;
+    }
+
+    if (**text == '{') {
+        value->type = JSON_OBJECT;
+        return parse_container(text, value, '}');
+    } else if (**text == '[') {
+        value->type = JSON_ARRAY;
+        return parse_container(text, value, ']');
+    } else if (**text == '"') {
+        value->type = JSON_STRING;
+        value->string = parse_string(text);
+        if (value->string == NULL) {
+            free(value);
+            return NULL;
+        }
+    } else if (strncmp(*text, "true", 4) == 0 || strncmp(*text, "false", 5) == 0) {
+        value->type = JSON_BOOL;
+        value->number = **text == 't';
+        *text += **text == 't' ? 4 : 5;
+    } else if (strncmp(*text, "null", 4) == 0) {
+        value->type = JSON_NULL;
+        *text += 4;
+    } else {
+        char *end;
+        value->type = JSON_NUMBER;
+        value->number = strtod(*text, &end);
+        if (end == *text) {
+            free(value);
+            return NULL;
+        }
+        *text = end;
+    }
+
+    return value;
+}
+
+static const JsonValue *json_member(const JsonValue *object, const char *key, JsonType type) {
+    if (object == NULL || object->type != JSON_OBJECT) {
+        return NULL;
+    }
+
+    size_t i;
+    for (i = 0; i < object->num_items; i++) {
+        if (strcmp(object->keys[i], key) == 0) {
+            return object->items[i]->type == type ? object->items[i] : NULL;
+        }
+    }
+
+    return NULL;
+}
+
+static JsonValue *read_json_file(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return NULL;
+    }
+
+    size_t len = 0, capacity = 4096;
+    char *text = malloc(capacity);
+    size_t bytes_read;
+    while (text != NULL && (bytes_read = fread(text + len, 1, capacity - len - 1, file)) > 0) {
+        len += bytes_read;
+        if (len == capacity - 1) {
+            capacity *= 2;
+            char *bigger = realloc(text, capacity);
+            if (bigger == NULL) {
+                free(text);
+            }
+            text = bigger;
+        }
+    }
+    fclose(file);
+
+    if (text == NULL) {
+        fprintf(stderr, "%s: out of memory\n", path);
+        return NULL;
+    }
+    text[len] = '\0';
+
+    const char *cursor = text;
+    JsonValue *root = parse_value(&cursor);
+    free(text);
+
+    if (root == NULL) {
+        fprintf(stderr, "%s: not valid JSON\n", path);
+    }
+
+    return root;
+}
+
+static void free_results(BenchResult *results, size_t num_results) {
+    size_t i;
+    for (i = 0; results != NULL && i < num_results; i++) {
+        free(results[i].samples);
+    }
+    free(results);
+}
+
+/* the benchmarks in a results file, pointing into root */
+static BenchResult *read_results(const char *path, JsonValue *root, size_t *num_results) {
+    const JsonValue *benchmarks = json_member(root, "benchmarks", JSON_ARRAY);
+    if (benchmarks == NULL) {
+        fprintf(stderr, "%s: no \"benchmarks\" array, not a bench_suite_write_json file?\n", path);
+        return NULL;
+    }
+
+    BenchResult *results = calloc(benchmarks->num_items + 1, sizeof(BenchResult));
+    size_t i, j;
+    for (i = 0; results != NULL && i < benchmarks->num_items; i++) {
+        const JsonValue *name = json_member(benchmarks->items[i], "name", JSON_STRING);
+        const JsonValue *median = json_member(benchmarks->items[i], "median_ns", JSON_NUMBER);
+        const JsonValue *samples = json_member(benchmarks->items[i], "samples_ns", JSON_ARRAY);
+        if (name == NULL || median == NULL || samples == NULL) {
+            fprintf(stderr, "%s: benchmark %lu is missing its name, median_ns, or samples_ns\n", path, i);
+            free_results(results, i);
+            return NULL;
+        }
+
+        results[i].name = name->string;
+        results[i].median = median->number;
+        results[i].num_samples = samples->num_items;
+        results[i].samples = malloc((samples->num_items + 1) * sizeof(double));
+        if (results[i].samples == NULL) {
+            fprintf(stderr, "%s: out of memory\n", path);
+            exit(2);
+        }
+        for (j = 0; j < samples->num_items; j++) {
+            results[i].samples[j] = samples->items[j]->number;
+        }
+    }
+
+    *num_results = benchmarks->num_items;
+    return results;
+}
+
+
+typedef struct {
+    double value;
+    int from_a;
+} RankedSample;
+
+static int compare_ranked(const void *a, const void *b) {
+    double x = ((const RankedSample *) a)->value, y = ((const RankedSample *) b)->value;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Two sided p-value of the Mann-Whitney U test that a and b come from the
+ * same distribution. Uses the normal approximation with corrections for ties
+ * and continuity, which is close enough from about 8 samples each on.
+ */
+static double mann_whitney_p(const double *a, size_t n_a, const double *b, size_t n_b) {
+    size_t n = n_a + n_b, i, j;
+    if (n_a == 0 || n_b == 0) {
+        return 1;
+    }
+
+    RankedSample *all = malloc(n * sizeof(RankedSample));
+    if (all == NULL) {
+        return 1;
+    }
+    for (i = 0; i < n_a; i++) {
+        all[i].value = a[i];
+        all[i].from_a = 1;
+    }
+    for (i = 0; i < n_b; i++) {
+        all[n_a + i].value = b[i];
+        all[n_a + i].from_a = 0;
+    }
+    qsort(all, n, sizeof(RankedSample), compare_ranked);
+
+    /* tied samples all get the average of the ranks they span */
+    double rank_sum_a = 0, tie_term = 0;
+    for (i = 0; i < n; i = j) {
+        for (j = i + 1; j < n && all[j].value == all[i].value; j++) {
+        }
+
+        double ties = j - i;
+        double rank = (i + 1 + j) / 2.0;
+        size_t k;
+        for (k = i; k < j; k++) {
+            rank_sum_a += all[k].from_a ? rank : 0;
+        }
+        tie_term += ties * ties * ties - ties;
+    }
+    free(all);
+
+    double u = rank_sum_a - n_a * (n_a + 1) / 2.0;
+    double mean = n_a * n_b / 2.0;
+    double variance = n_a * n_b / 12.0 * ((n + 1) - tie_term / ((double) n * (n - 1)));
+    if (variance <= 0) {
+        return 1;  /* every sample is the same */
+    }
+
+    double distance = fabs(u - mean) - 0.5;
+    double z = (distance > 0 ? distance : 0) / sqrt(variance);
+    return erfc(z / sqrt(2));
+}
+
+static const BenchResult *find_result(const BenchResult *results, size_t num_results, const char *name) {
+    size_t i;
+    for (i = 0; i < num_results; i++) {
+        if (strcmp(results[i].name, name) == 0) {
+            return &results[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void usage(const char *program, FILE *out) {
+    fprintf(
+        out,
+        "Usage: %s [--alpha A] [--threshold PERCENT] OLD.json NEW.json\n"
+        "    --alpha A\n"
+        "        Largest p-value that counts as a real difference (default %.2f)\n"
+        "    --threshold PERCENT\n"
+        "        How much slower the median must get to count as a regression (default %.1f)\n",
+        program, DEFAULT_ALPHA, DEFAULT_THRESHOLD
+    );
+}
+
+int main(int argc, char **argv) {
+    double alpha = DEFAULT_ALPHA, threshold = DEFAULT_THRESHOLD;
+    const char *paths[2];
+    int num_paths = 0, i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--alpha") == 0 && i + 1 < argc) {
+            alpha = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--help") == 0) {
+            usage(argv[0], stdout);
+            exit(EXIT_SUCCESS);
+        } else if (argv[i][0] != '-' && num_paths < 2) {
+            paths[num_paths++] = argv[i];
+        } else {
+            usage(argv[0], stderr);
+            exit(2);
+        }
+    }
+    if (num_paths != 2) {
+        usage(argv[0], stderr);
+        exit(2);
+    }
+
+    JsonValue *old_root = read_json_file(paths[0]);
+    JsonValue *new_root = read_json_file(paths[1]);
+    size_t num_old = 0, num_new = 0;
+    BenchResult *old_results = old_root != NULL ? read_results(paths[0], old_root, &num_old) : NULL;
+    BenchResult *new_results = new_root != NULL ? read_results(paths[1], new_root, &num_new) : NULL;
+    if (old_results == NULL || new_results == NULL) {
+        free_results(old_results, num_old);
+        free_results(new_results, num_new);
+        free_json(old_root);
+        free_json(new_root);
+        exit(2);
+    }
+
+    printf("%-40s %12s %12s %9s %9s\n", "benchmark", "old (ns)", "new (ns)", "change", "p");
+
+    size_t j, num_regressions = 0;
+    for (j = 0; j < num_new; j++) {
+        const BenchResult *new_result = &new_results[j];
+        const BenchResult *old_result = find_result(old_results, num_old, new_result->name);
+        if (old_result == NULL) {
+            printf("%-40s %12s %12.2f %9s %9s  new\n", new_result->name, "-", new_result->median, "-", "-");
+            continue;
+        }
+
+        double change = old_result->median > 0 ? (new_result->median / old_result->median - 1) * 100 : 0;
+        double p = mann_whitney_p(old_result->samples, old_result->num_samples,
+                                  new_result->samples, new_result->num_samples);
+
+        const char *verdict = "";
+        if (p < alpha && change > threshold) {
+            verdict = "REGRESSION";
+            num_regressions++;
+        } else if (p < alpha && change < -threshold) {
+            verdict = "faster";
+        }
+
+        printf("%-40s %12.2f %12.2f %+8.1f%% %9.4f  %s\n", new_result->name, old_result->median,
+               new_result->median, change, p, verdict);
+    }
+
+    for (j = 0; j < num_old; j++) {
+        if (find_result(new_results, num_new, old_results[j].name) == NULL) {
+            printf("%-40s %12.2f %12s %9s %9s  removed\n", old_results[j].name, old_results[j].median, "-", "-", "-");
+        }
+    }
+
+    printf("\n%lu regression%s (p < %g and over %g%% slower)\n", num_regressions, num_regressions == 1 ? "" : "s",
+           alpha, threshold);
+
+    free_results(old_results, num_old);
+    free_results(new_results, num_new);
+    free_json(old_root);
+    free_json(new_root);
+
+    return num_regressions > 0 ? 1 : 0;
+}
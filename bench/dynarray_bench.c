@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ilc/dynarray.h>
+#include <ilc/bench.h>
+
+#define NUM_ITEMS 1000  /* lfold and rfold recurse once per item, so keep this modest */
+
+
+static DynArray *filled;  /* 0 through NUM_ITEMS - 1, built once in main */
+
+
+static DynArray *make_filled(size_t n) {
+    DynArray *arr = create_dynarray(sizeof(int));
+    int i;
+    for (i = 0; i < (int) n; i++) {
+        dynarray_append(arr, &i);
+    }
+
+    return arr;
+}
+
+static int int_equal(const void *a, const void *b) {
+    return *(const int *) a == *(const int *) b;
+}
+
+static void increment(void *item) {
+    (*(int *) item)++;
+}
+
+/* folds with the accumulator in place, so the benchmark measures the traversal and not malloc */
+static void *sum_left(void *acc, void *item) {
+    *(long *) acc += *(int *) item;
+    return acc;
+}
+
+static void *sum_right(void *item, void *acc) {
+    *(long *) acc += *(int *) item;
+    return acc;
+}
+
+
+static void create_dynarray_bench(Bench *b) {
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        DynArray *arr = create_dynarray(sizeof(int));
+        bench_do_not_optimize(arr);
+        free_dynarray(arr);
+    }
+}
+
+static void create_dynarray_sized_bench(Bench *b) {
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        DynArray *arr = create_dynarray_sized(sizeof(int), NUM_ITEMS);
+        bench_do_not_optimize(arr);
+        free_dynarray(arr);
+    }
+}
+
+static void dynarray_append_bench(Bench *b) {
+    bench_pause_timer(b);
+    DynArray *arr = create_dynarray(sizeof(int));
+    bench_resume_timer(b);
+    bench_set_items(b, 1);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        int item = (int) i;
+        dynarray_append(arr, &item);
+    }
+
+    bench_pause_timer(b);
+    free_dynarray(arr);
+}
+
+/* inserting at the front moves everything, so refill from empty every NUM_ITEMS */
+static void dynarray_insert_front_bench(Bench *b) {
+    bench_pause_timer(b);
+    DynArray *arr = create_dynarray(sizeof(int));
+    bench_resume_timer(b);
+    bench_set_items(b, 1);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        if (i % NUM_ITEMS == 0) {
+            bench_pause_timer(b);
+            free_dynarray(arr);
+            arr = create_dynarray(sizeof(int));
+            bench_resume_timer(b);
+        }
+
+        int item = (int) i;
+        dynarray_insert(arr, &item, 0);
+    }
+
+    bench_pause_timer(b);
+    free_dynarray(arr);
+}
+
+static void dynarray_remove_at_front_bench(Bench *b) {
+    bench_pause_timer(b);
+    DynArray *arr = make_filled(NUM_ITEMS);
+    bench_resume_timer(b);
+    bench_set_items(b, 1);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        if (dynarray_length(arr) == 0) {
+            bench_pause_timer(b);
+            free_dynarray(arr);
+            arr = make_filled(NUM_ITEMS);
+            bench_resume_timer(b);
+        }
+
+        dynarray_remove_at(arr, 0);
+    }
+
+    bench_pause_timer(b);
+    free_dynarray(arr);
+}
+
+/* remove and re-add the last item, so the search covers the whole array */
+static void dynarray_remove_bench(Bench *b) {
+    bench_pause_timer(b);
+    DynArray *arr = make_filled(NUM_ITEMS);
+    bench_resume_timer(b);
+    bench_set_items(b, NUM_ITEMS);
+
+    int last = NUM_ITEMS - 1;
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        dynarray_remove(arr, &last, int_equal, 0);
+        dynarray_append(arr, &last);
+    }
+
+    bench_pause_timer(b);
+    free_dynarray(arr);
+}
+
+static void dynarray_replace_bench(Bench *b) {
+    bench_pause_timer(b);
+    DynArray *arr = make_filled(NUM_ITEMS);
+    bench_resume_timer(b);
+    bench_set_items(b, NUM_ITEMS);
+
+    int last = NUM_ITEMS - 1;
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        dynarray_replace(arr, &last, &last, int_equal, 1);
+    }
+
+    bench_pause_timer(b);
+    free_dynarray(arr);
+}
+
+static void dynarray_replace_at_bench(Bench *b) {
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        int item = (int) i;
+        dynarray_replace_at(filled, i % NUM_ITEMS, &item);
+    }
+
+    bench_pause_timer(b);
+    for (i = 0; i < NUM_ITEMS; i++) {
+        int item = (int) i;
+        dynarray_replace_at(filled, i, &item);  /* put the fixture back */
+    }
+}
+
+static void dynarray_length_bench(Bench *b) {
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        size_t length = dynarray_length(filled);
+        bench_do_not_optimize(&length);
+    }
+}
+
+static void dynarray_item_at_bench(Bench *b) {
+    bench_set_items(b, NUM_ITEMS);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        long sum = 0;
+        size_t j;
+        for (j = 0; j < NUM_ITEMS; j++) {
+            sum += *(int *) dynarray_item_at(filled, j);
+        }
+        bench_do_not_optimize(&sum);
+    }
+}
+
+static void dynarray_map_bench(Bench *b) {
+    bench_pause_timer(b);
+    DynArray *arr = make_filled(NUM_ITEMS);
+    bench_resume_timer(b);
+    bench_set_items(b, NUM_ITEMS);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        dynarray_map(arr, increment);
+    }
+
+    bench_pause_timer(b);
+    free_dynarray(arr);
+}
+
+static void dynarray_lfold_bench(Bench *b) {
+    bench_set_items(b, NUM_ITEMS);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        long sum = 0;
+        dynarray_lfold(filled, sum_left, &sum);
+        bench_do_not_optimize(&sum);
+    }
+}
+
+static void dynarray_rfold_bench(Bench *b) {
+    bench_set_items(b, NUM_ITEMS);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        long sum = 0;
+        dynarray_rfold(filled, sum_right, &sum);
+        bench_do_not_optimize(&sum);
+    }
+}
+
+int main(int argc, char **argv) {
+    int verbose = 0, counters = 0;
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
+            verbose = 1;
+        } else if (strcmp(argv[i], "--counters") == 0) {
+            counters = 1;
+        } else if (strcmp(argv[i], "--pin") == 0 && i + 1 < argc) {
+            if (bench_pin_cpu(atoi(argv[++i])) != 0) {
+                perror("bench_pin_cpu");
+            }
+        } else {
+            printf(
+                "Usage: %s [-v|--verbose] [--counters] [--pin CPU]\n"
+                "    -v, --verbose\n"
+                "        Show the time of every repetition\n"
+                "    --counters\n"
+                "        Also show IPC, cache misses, and branch misses from the cpu's counters\n"
+                "    --pin CPU\n"
+                "        Run on only the given cpu\n",
+                argv[0]
+            );
+            exit(strcmp(argv[i], "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+
+    filled = make_filled(NUM_ITEMS);
+
+    BenchSuite *dynarray_benches = create_bench_suite("dynarray benchmarks");
+    if (counters) {
+        int err = bench_suite_enable_counters(dynarray_benches);
+        if (err != 0) {
+            fprintf(stderr, "hardware counters unavailable (%s), timing only\n", strerror(err));
+        }
+    }
+    suite_add_bench(dynarray_benches, "create_dynarray + free", create_dynarray_bench);
+    suite_add_bench(dynarray_benches, "create_dynarray_sized + free", create_dynarray_sized_bench);
+    suite_add_bench(dynarray_benches, "dynarray_append", dynarray_append_bench);
+    suite_add_bench(dynarray_benches, "dynarray_insert (front)", dynarray_insert_front_bench);
+    suite_add_bench(dynarray_benches, "dynarray_remove_at (front)", dynarray_remove_at_front_bench);
+    suite_add_bench(dynarray_benches, "dynarray_remove (last item)", dynarray_remove_bench);
+    suite_add_bench(dynarray_benches, "dynarray_replace (all)", dynarray_replace_bench);
+    suite_add_bench(dynarray_benches, "dynarray_replace_at", dynarray_replace_at_bench);
+    suite_add_bench(dynarray_benches, "dynarray_length", dynarray_length_bench);
+    suite_add_bench(dynarray_benches, "dynarray_item_at", dynarray_item_at_bench);
+    suite_add_bench(dynarray_benches, "dynarray_map", dynarray_map_bench);
+    suite_add_bench(dynarray_benches, "dynarray_lfold", dynarray_lfold_bench);
+    suite_add_bench(dynarray_benches, "dynarray_rfold", dynarray_rfold_bench);
+    run_bench_suite(dynarray_benches, verbose);
+    free_bench_suite(dynarray_benches);
+
+    free_dynarray(filled);
+
+    return 0;
+}
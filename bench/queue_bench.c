@@ -0,0 +1,236 @@
+#define _POSIX_C_SOURCE 200809L  /* clock_gettime, sched_yield */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <ilc/queue.h>
+
+/*
+ * Throughput and latency of SpscQueue and MpmcQueue under contention. Run
+ * with an item count to change how long each case takes:
+ *
+ *   build/bench/queue_bench [num_items]
+ */
+
+#define QUEUE_CAPACITY 1024
+#define BATCH_SIZE 32
+#define MAX_THREADS 8
+#define LATENCY_ROUNDS 20000
+
+typedef struct {
+    SpscQueue *spsc;
+    MpmcQueue *mpmc;
+    size_t num_items;  /* per thread */
+    size_t batch;  /* 1 pushes/pops one item at a time */
+} BenchArgs;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* spin a while before giving up the core, so a one core machine still makes progress */
+static void backoff(unsigned int *failures) {
+    if (++*failures % 64 == 0) {
+        sched_yield();
+    }
+}
+
+static void *spsc_producer(void *arg) {
+    BenchArgs *args = arg;
+    size_t items[BATCH_SIZE] = {0};
+    size_t sent = 0;
+    unsigned int failures = 0;
+    while (sent < args->num_items) {
+        size_t count = args->num_items - sent < args->batch ? args->num_items - sent : args->batch;
+        size_t pushed = spsc_queue_push_batch(args->spsc, items, count);
+        if (pushed == 0) {
+            backoff(&failures);
+        }
+        sent += pushed;
+    }
+
+    return NULL;
+}
+
+static void *spsc_consumer(void *arg) {
+    BenchArgs *args = arg;
+    size_t items[BATCH_SIZE];
+    size_t received = 0;
+    unsigned int failures = 0;
+    while (received < args->num_items) {
+        size_t popped = spsc_queue_pop_batch(args->spsc, items, args->batch);
+        if (popped == 0) {
+            backoff(&failures);
+        }
+        received += popped;
+    }
+
+    return NULL;
+}
+
+static void *mpmc_producer(void *arg) {
+    BenchArgs *args = arg;
+    size_t items[BATCH_SIZE] = {0};
+    size_t sent = 0;
+    unsigned int failures = 0;
+    while (sent < args->num_items) {
+        size_t count = args->num_items - sent < args->batch ? args->num_items - sent : args->batch;
+        size_t pushed = mpmc_queue_push_batch(args->mpmc, items, count);
+        if (pushed == 0) {
+            backoff(&failures);
+        }
+        sent += pushed;
+    }
+
+    return NULL;
+}
+
+static void *mpmc_consumer(void *arg) {
+    BenchArgs *args = arg;
+    size_t items[BATCH_SIZE];
+    size_t received = 0;
+    unsigned int failures = 0;
+    while (received < args->num_items) {
+        size_t max_count = args->num_items - received < args->batch ? args->num_items - received : args->batch;
+        size_t popped = mpmc_queue_pop_batch(args->mpmc, items, max_count);
+        if (popped == 0) {
+            backoff(&failures);
+        }
+        received += popped;
+    }
+
+    return NULL;
+}
+
+static void report_throughput(const char *name, size_t total_items, double seconds) {
+    printf("%-28s %10.2f M items/s  (%.3f s)\n", name, total_items / seconds / 1e6, seconds);
+}
+
+static void bench_spsc_throughput(size_t num_items, size_t batch) {
+    BenchArgs args = {create_spsc_queue(sizeof(size_t), QUEUE_CAPACITY), NULL, num_items, batch};
+
+    double start = now_seconds();
+    pthread_t producer, consumer;
+    pthread_create(&consumer, NULL, spsc_consumer, &args);
+    pthread_create(&producer, NULL, spsc_producer, &args);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    double seconds = now_seconds() - start;
+
+    char name[64];
+    sprintf(name, "spsc batch %lu", batch);
+    report_throughput(name, num_items, seconds);
+
+    free_spsc_queue(args.spsc);
+}
+
+/* each producer pushes num_items and each consumer pops num_items */
+static void bench_mpmc_throughput(size_t num_items, size_t num_threads, size_t batch) {
+    BenchArgs args = {NULL, create_mpmc_queue(sizeof(size_t), QUEUE_CAPACITY), num_items, batch};
+
+    double start = now_seconds();
+    pthread_t producers[MAX_THREADS], consumers[MAX_THREADS];
+    size_t i;
+    for (i = 0; i < num_threads; i++) {
+        pthread_create(&consumers[i], NULL, mpmc_consumer, &args);
+        pthread_create(&producers[i], NULL, mpmc_producer, &args);
+    }
+    for (i = 0; i < num_threads; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+    }
+    double seconds = now_seconds() - start;
+
+    char name[64];
+    sprintf(name, "mpmc %lux%lu batch %lu", num_threads, num_threads, batch);
+    report_throughput(name, num_items * num_threads, seconds);
+
+    free_mpmc_queue(args.mpmc);
+}
+
+typedef struct {
+    SpscQueue *ping;
+    SpscQueue *pong;
+} PingPong;
+
+static void *echo(void *arg) {
+    PingPong *queues = arg;
+    size_t i, item;
+    for (i = 0; i < LATENCY_ROUNDS; i++) {
+        unsigned int failures = 0;
+        while (spsc_queue_pop(queues->ping, &item) != 0) {
+            backoff(&failures);
+        }
+        failures = 0;
+        while (spsc_queue_push(queues->pong, &item) != 0) {
+            backoff(&failures);
+        }
+    }
+
+    return NULL;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/* one item back and forth between two threads, timing each round trip */
+static void bench_spsc_latency(void) {
+    PingPong queues = {create_spsc_queue(sizeof(size_t), 16), create_spsc_queue(sizeof(size_t), 16)};
+    double *round_trips = malloc(LATENCY_ROUNDS * sizeof(double));
+
+    pthread_t echo_thread;
+    pthread_create(&echo_thread, NULL, echo, &queues);
+
+    size_t i, item;
+    for (i = 0; i < LATENCY_ROUNDS; i++) {
+        double start = now_seconds();
+        unsigned int failures = 0;
+        while (spsc_queue_push(queues.ping, &i) != 0) {
+            backoff(&failures);
+        }
+        failures = 0;
+        while (spsc_queue_pop(queues.pong, &item) != 0) {
+            backoff(&failures);
+        }
+        round_trips[i] = (now_seconds() - start) * 1e9;
+    }
+    pthread_join(echo_thread, NULL);
+
+    qsort(round_trips, LATENCY_ROUNDS, sizeof(double), compare_doubles);
+    printf("%-28s median %.0f ns  p99 %.0f ns\n", "spsc round trip",
+           round_trips[LATENCY_ROUNDS / 2], round_trips[LATENCY_ROUNDS * 99 / 100]);
+
+    free(round_trips);
+    free_spsc_queue(queues.ping);
+    free_spsc_queue(queues.pong);
+}
+
+int main(int argc, char **argv) {
+    size_t num_items = 5000000;
+    if (argc == 2) {
+        num_items = strtoul(argv[1], NULL, 10);
+    } else if (argc > 2) {
+        fprintf(stderr, "Usage: %s [num_items]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    bench_spsc_throughput(num_items, 1);
+    bench_spsc_throughput(num_items, BATCH_SIZE);
+
+    size_t num_threads;
+    for (num_threads = 1; num_threads <= 4; num_threads *= 2) {
+        bench_mpmc_throughput(num_items / num_threads, num_threads, 1);
+        bench_mpmc_throughput(num_items / num_threads, num_threads, BATCH_SIZE);
+    }
+
+    bench_spsc_latency();
+
+    return 0;
+}
@@ -0,0 +1,522 @@
+#define _POSIX_C_SOURCE 200809L  /* unlink */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ilc/string.h>
+#include <ilc/dynarray.h>
+#include <ilc/bench.h>
+
+#define TEXT_LEN (64 * 1024)
+#define BIG_TEXT_LEN (8 * 1024 * 1024)  /* big enough for string_split_parallel to use threads */
+#define MAP_FILE "string_bench_map_file.tmp"
+
+
+/* fixtures shared by the benchmarks, built once in main */
+static String *text;  /* words separated by spaces, a comma every so often */
+static String *big_text;
+static String *padded;  /* a short string with whitespace on both sides */
+static char space_chars[] = " ";
+static char word_chars[] = "needle";
+static char replacement_chars[] = "NEEDLE!";
+static char missing_chars[] = "zzzzzzzzzzzzzzzz";  /* never in text, so searches scan all of it */
+static String space = {space_chars, 1};
+static String word = {word_chars, 6};
+static String replacement = {replacement_chars, 7};
+static String missing = {missing_chars, 16};
+static StringList *words;  /* text split by spaces */
+static StringList *whitespace;
+static StringList *patterns;
+static StringMatcher *matcher;
+static StringTrimmer *trimmer;
+
+
+/* deterministic words from a small alphabet, with "needle" every 50th word */
+static String *make_text(size_t len) {
+    char *chars = malloc(len);
+    unsigned int seed = 42;
+    size_t i = 0, num_words = 0;
+    while (i < len) {
+        const char *w = "needle";
+        size_t w_len = 6;
+        char buf[12];
+        if (++num_words % 50 != 0) {
+            w_len = 2 + (seed >> 16) % 9;
+            size_t j;
+            for (j = 0; j < w_len; j++) {
+                seed = seed * 1103515245 + 12345;
+                buf[j] = 'a' + (seed >> 16) % 26;
+            }
+            buf[w_len++] = num_words % 7 == 0 ? ',' : 'e';
+            w = buf;
+        }
+
+        size_t j;
+        for (j = 0; j < w_len && i < len; j++) {
+            chars[i++] = w[j];
+        }
+        if (i < len) {
+            chars[i++] = ' ';
+        }
+    }
+
+    String *str = create_string(chars, len);
+    free(chars);
+    return str;
+}
+
+static StringList *make_list(const char **strs, size_t len) {
+    StringList *list = malloc(sizeof(StringList));
+    list->strs = malloc(len * sizeof(String));
+    list->len = len;
+
+    size_t i;
+    for (i = 0; i < len; i++) {
+        list->strs[i].chars = (char *) strs[i];
+        list->strs[i].len = strlen(strs[i]);
+    }
+
+    return list;
+}
+
+static void free_list(StringList *list) {
+    free(list->strs);
+    free(list);
+}
+
+
+static void create_string_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *str = create_string(text->chars, text->len);
+        bench_do_not_optimize(str->chars);
+        free_string(str);
+    }
+}
+
+static void string_copy_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *copy = string_copy(text);
+        bench_do_not_optimize(copy->chars);
+        free_string(copy);
+    }
+}
+
+static void string_reverse_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *reversed = string_reverse(text);
+        bench_do_not_optimize(reversed->chars);
+        free_string(reversed);
+    }
+}
+
+static void string_map_file_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *mapped = string_map_file(MAP_FILE, STRING_MAP_SEQUENTIAL);
+        bench_do_not_optimize(mapped->chars);
+        string_unmap_file(mapped);
+    }
+}
+
+static void substring_bench(Bench *b) {
+    bench_set_bytes(b, text->len / 2);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *sub = substring(text, text->len / 4, -(long) (text->len / 4));
+        bench_do_not_optimize(sub->chars);
+        free_string(sub);
+    }
+}
+
+static void string_to_c_string_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        char *cstr = string_to_c_string(text);
+        bench_do_not_optimize(cstr);
+        free(cstr);
+    }
+}
+
+static void string_equal_bench(Bench *b) {
+    bench_pause_timer(b);
+    String *copy = string_copy(text);
+    bench_resume_timer(b);
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        int equal = string_equal(text, copy);
+        bench_do_not_optimize(&equal);
+    }
+
+    bench_pause_timer(b);
+    free_string(copy);
+}
+
+static void string_compare_bench(Bench *b) {
+    bench_pause_timer(b);
+    String *copy = string_copy(text);
+    copy->chars[copy->len - 1] = '~';  /* differ only at the very end */
+    bench_resume_timer(b);
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        int order = string_compare(text, copy);
+        bench_do_not_optimize(&order);
+    }
+
+    bench_pause_timer(b);
+    free_string(copy);
+}
+
+static void string_contains_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        int found = string_contains(text, &missing);
+        bench_do_not_optimize(&found);
+    }
+}
+
+static void string_contains_at_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        size_t idx;
+        int found = string_contains_at(text, &missing, &idx);
+        bench_do_not_optimize(&found);
+    }
+}
+
+static void string_find_all_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        DynArray *offsets = create_dynarray(sizeof(size_t));
+        string_find_all(text, &word, offsets);
+        bench_do_not_optimize(offsets);
+        free_dynarray(offsets);
+    }
+}
+
+static void string_count_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        size_t count = string_count(text, &word);
+        bench_do_not_optimize(&count);
+    }
+}
+
+static void string_replace_all_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *replaced = string_replace_all(text, &word, &replacement);
+        bench_do_not_optimize(replaced->chars);
+        free_string(replaced);
+    }
+}
+
+static void string_concat_bench(Bench *b) {
+    bench_set_bytes(b, 2 * text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *both = string_concat(text, text);
+        bench_do_not_optimize(both->chars);
+        free_string(both);
+    }
+}
+
+/* many small appends onto one growing string */
+static void string_append_bench(Bench *b) {
+    bench_pause_timer(b);
+    String *str = create_string("", 0);
+    bench_resume_timer(b);
+    bench_set_bytes(b, word.len);
+    bench_set_items(b, 1);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        string_append(str, &word);
+    }
+    bench_do_not_optimize(str->chars);
+
+    bench_pause_timer(b);
+    free_string(str);
+}
+
+static void string_list_equal_bench(Bench *b) {
+    bench_pause_timer(b);
+    StringList *copy = string_split(text, &space);
+    bench_resume_timer(b);
+    bench_set_items(b, words->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        int equal = string_list_equal(words, copy);
+        bench_do_not_optimize(&equal);
+    }
+
+    bench_pause_timer(b);
+    free(copy);
+}
+
+static void string_split_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+    bench_set_items(b, words->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        StringList *list = string_split(text, &space);
+        bench_do_not_optimize(list->strs);
+        free(list);
+    }
+}
+
+static void string_split_parallel_bench(Bench *b) {
+    bench_set_bytes(b, big_text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        StringList *list = string_split_parallel(big_text, &space, 0);
+        bench_do_not_optimize(list->strs);
+        free(list);
+    }
+}
+
+static void string_join_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+    bench_set_items(b, words->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *joined = string_join(&space, words);
+        bench_do_not_optimize(joined->chars);
+        free_string(joined);
+    }
+}
+
+static void string_ltrim_bench(Bench *b) {
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *trimmed = string_ltrim(padded, whitespace);
+        bench_do_not_optimize(trimmed->chars);
+        free_string(trimmed);
+    }
+}
+
+static void string_rtrim_bench(Bench *b) {
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *trimmed = string_rtrim(padded, whitespace);
+        bench_do_not_optimize(trimmed->chars);
+        free_string(trimmed);
+    }
+}
+
+static void string_trim_bench(Bench *b) {
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *trimmed = string_trim(padded, whitespace);
+        bench_do_not_optimize(trimmed->chars);
+        free_string(trimmed);
+    }
+}
+
+static void create_string_matcher_bench(Bench *b) {
+    bench_set_items(b, patterns->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        StringMatcher *m = create_string_matcher(patterns);
+        bench_do_not_optimize(m);
+        free_string_matcher(m);
+    }
+}
+
+static void string_matcher_find_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        StringMatch match;
+        int found = string_matcher_find(matcher, text, &match);
+        bench_do_not_optimize(&found);
+    }
+}
+
+static void string_matcher_find_all_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        DynArray *matches = create_dynarray(sizeof(StringMatch));
+        string_matcher_find_all(matcher, text, matches);
+        bench_do_not_optimize(matches);
+        free_dynarray(matches);
+    }
+}
+
+static void string_matcher_count_bench(Bench *b) {
+    bench_set_bytes(b, text->len);
+
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        size_t count = string_matcher_count(matcher, text);
+        bench_do_not_optimize(&count);
+    }
+}
+
+static void create_string_trimmer_bench(Bench *b) {
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        StringTrimmer *t = create_string_trimmer(whitespace);
+        bench_do_not_optimize(t);
+        free_string_trimmer(t);
+    }
+}
+
+static void string_trim_view_bench(Bench *b) {
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String view;
+        string_trim_view(padded, trimmer, STRING_TRIM_BOTH, &view);
+        bench_do_not_optimize(&view);
+    }
+}
+
+static void string_trim_with_bench(Bench *b) {
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *trimmed = string_trim_with(padded, trimmer);
+        bench_do_not_optimize(trimmed->chars);
+        free_string(trimmed);
+    }
+}
+
+static void string_trim_whitespace_bench(Bench *b) {
+    size_t i;
+    for (i = 0; i < bench_iterations(b); i++) {
+        String *trimmed = string_trim_whitespace(padded);
+        bench_do_not_optimize(trimmed->chars);
+        free_string(trimmed);
+    }
+}
+
+int main(int argc, char **argv) {
+    int verbose = 0, counters = 0;
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0) {
+            verbose = 1;
+        } else if (strcmp(argv[i], "--counters") == 0) {
+            counters = 1;
+        } else if (strcmp(argv[i], "--pin") == 0 && i + 1 < argc) {
+            if (bench_pin_cpu(atoi(argv[++i])) != 0) {
+                perror("bench_pin_cpu");
+            }
+        } else {
+            printf(
+                "Usage: %s [-v|--verbose] [--counters] [--pin CPU]\n"
+                "    -v, --verbose\n"
+                "        Show the time of every repetition\n"
+                "    --counters\n"
+                "        Also show IPC, cache misses, and branch misses from the cpu's counters\n"
+                "    --pin CPU\n"
+                "        Run on only the given cpu\n",
+                argv[0]
+            );
+            exit(strcmp(argv[i], "--help") == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+
+    const char *whitespace_strs[] = {" ", "\t", "\n", "\r"};
+    const char *pattern_strs[] = {"needle", "haystack", "abc", "zq", "eee", "pin"};
+    text = make_text(TEXT_LEN);
+    big_text = make_text(BIG_TEXT_LEN);
+    padded = create_string("  \t\t  \n a short line in the middle \r\n   ", 40);
+    words = string_split(text, &space);
+    whitespace = make_list(whitespace_strs, 4);
+    patterns = make_list(pattern_strs, 6);
+    matcher = create_string_matcher(patterns);
+    trimmer = create_string_trimmer(whitespace);
+
+    FILE *f = fopen(MAP_FILE, "wb");
+    fwrite(text->chars, 1, text->len, f);
+    fclose(f);
+
+    BenchSuite *string_benches = create_bench_suite("string benchmarks");
+    if (counters) {
+        int err = bench_suite_enable_counters(string_benches);
+        if (err != 0) {
+            fprintf(stderr, "hardware counters unavailable (%s), timing only\n", strerror(err));
+        }
+    }
+    suite_add_bench(string_benches, "create_string + free_string", create_string_bench);
+    suite_add_bench(string_benches, "string_copy", string_copy_bench);
+    suite_add_bench(string_benches, "string_reverse", string_reverse_bench);
+    suite_add_bench(string_benches, "string_map_file + unmap", string_map_file_bench);
+    suite_add_bench(string_benches, "substring", substring_bench);
+    suite_add_bench(string_benches, "string_to_c_string", string_to_c_string_bench);
+    suite_add_bench(string_benches, "string_equal", string_equal_bench);
+    suite_add_bench(string_benches, "string_compare", string_compare_bench);
+    suite_add_bench(string_benches, "string_contains (missing)", string_contains_bench);
+    suite_add_bench(string_benches, "string_contains_at (missing)", string_contains_at_bench);
+    suite_add_bench(string_benches, "string_find_all", string_find_all_bench);
+    suite_add_bench(string_benches, "string_count", string_count_bench);
+    suite_add_bench(string_benches, "string_replace_all", string_replace_all_bench);
+    suite_add_bench(string_benches, "string_concat", string_concat_bench);
+    suite_add_bench(string_benches, "string_append (6 bytes)", string_append_bench);
+    suite_add_bench(string_benches, "string_list_equal", string_list_equal_bench);
+    suite_add_bench(string_benches, "string_split", string_split_bench);
+    suite_add_bench(string_benches, "string_split_parallel (8 MiB)", string_split_parallel_bench);
+    suite_add_bench(string_benches, "string_join", string_join_bench);
+    suite_add_bench(string_benches, "string_ltrim", string_ltrim_bench);
+    suite_add_bench(string_benches, "string_rtrim", string_rtrim_bench);
+    suite_add_bench(string_benches, "string_trim", string_trim_bench);
+    suite_add_bench(string_benches, "create_string_matcher + free", create_string_matcher_bench);
+    suite_add_bench(string_benches, "string_matcher_find", string_matcher_find_bench);
+    suite_add_bench(string_benches, "string_matcher_find_all", string_matcher_find_all_bench);
+    suite_add_bench(string_benches, "string_matcher_count", string_matcher_count_bench);
+    suite_add_bench(string_benches, "create_string_trimmer + free", create_string_trimmer_bench);
+    suite_add_bench(string_benches, "string_trim_view", string_trim_view_bench);
+    suite_add_bench(string_benches, "string_trim_with", string_trim_with_bench);
+    suite_add_bench(string_benches, "string_trim_whitespace", string_trim_whitespace_bench);
+    run_bench_suite(string_benches, verbose);
+    free_bench_suite(string_benches);
+
+    unlink(MAP_FILE);
+    free_string(text);
+    free_string(big_text);
+    free_string(padded);
+    free(words);
+    free_list(whitespace);
+    free_list(patterns);
+    free_string_matcher(matcher);
+    free_string_trimmer(trimmer);
+
+    return 0;
+}
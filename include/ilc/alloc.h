@@ -0,0 +1,101 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+/*
+ * Allocation tracking. Building with "make TRACK_ALLOCS=1" defines
+ * ILC_TRACK_ALLOCS, and every library source includes this header after the
+ * standard ones, so their malloc, calloc, realloc, and free calls go through
+ * the counting versions below. Without it this header only declares them,
+ * nothing is redirected, and alloc_stats reports all zeros.
+ *
+ * Only the library's own calls are seen. Memory the library hands out that
+ * the caller frees with free() (string_to_c_string's buffer, for example)
+ * stays counted as live. Live bytes are malloc_usable_size bytes, so they're
+ * 0 where that isn't available (anything but glibc).
+ */
+
+typedef struct {
+    size_t allocations;  /* malloc and calloc calls, and realloc calls given NULL */
+    size_t reallocations;  /* realloc calls given a block */
+    size_t frees;  /* free calls given a block */
+    size_t bytes_requested;  /* summed over allocations and reallocations */
+    size_t live_bytes;
+    size_t peak_live_bytes;  /* since the start or the last alloc_reset_peak */
+} AllocStats;
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * AllocStats alloc_stats(void)
+ * AllocStats alloc_stats_diff(AllocStats before, AllocStats after)
+ * void alloc_reset_peak(void)
+ * void alloc_print_sites(FILE *out, unsigned int max_sites)
+ * void *alloc_tracked_malloc(size_t size, const char *file, int line)
+ * void *alloc_tracked_calloc(size_t count, size_t size, const char *file, int line)
+ * void *alloc_tracked_realloc(void *ptr, size_t size, const char *file, int line)
+ * void alloc_tracked_free(void *ptr)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * A snapshot of the counters. Safe to call while other threads allocate, but
+ * the fields are read one at a time so they may be a few calls apart.
+ */
+AllocStats alloc_stats(void);
+
+
+/*
+ * What happened between two snapshots, so a test can assert a call's cost:
+ *
+ *   AllocStats before = alloc_stats();
+ *   StringList *list = string_split(str, delim);
+ *   AllocStats used = alloc_stats_diff(before, alloc_stats());
+ *   (used.allocations is how many blocks string_split allocated)
+ *
+ * live_bytes is how much more is live after than before (0 if less), and
+ * peak_live_bytes is how far the peak rose above before's live bytes, which
+ * only means something if alloc_reset_peak was called right before before.
+ */
+AllocStats alloc_stats_diff(AllocStats before, AllocStats after);
+
+
+/*
+ * Start measuring the peak again from the current live bytes.
+ */
+void alloc_reset_peak(void);
+
+
+/*
+ * Print the call sites that allocated the most, with their number of calls
+ * and bytes requested, up to max_sites of them (0 for all).
+ */
+void alloc_print_sites(FILE *out, unsigned int max_sites);
+
+
+/*
+ * The counting versions of malloc, calloc, realloc, and free, which behave
+ * exactly like them otherwise. file and line name the call site for
+ * alloc_print_sites and should be string literals (__FILE__ and __LINE__).
+ */
+void *alloc_tracked_malloc(size_t size, const char *file, int line);
+void *alloc_tracked_calloc(size_t count, size_t size, const char *file, int line);
+void *alloc_tracked_realloc(void *ptr, size_t size, const char *file, int line);
+void alloc_tracked_free(void *ptr);
+
+/* after stdlib.h, or these would rename its declarations too */
+#ifdef ILC_TRACK_ALLOCS
+#define malloc(size) alloc_tracked_malloc(size, __FILE__, __LINE__)
+#define calloc(count, size) alloc_tracked_calloc(count, size, __FILE__, __LINE__)
+#define realloc(ptr, size) alloc_tracked_realloc(ptr, size, __FILE__, __LINE__)
+#define free(ptr) alloc_tracked_free(ptr)
+#endif
+
+#endif
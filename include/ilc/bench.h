@@ -0,0 +1,88 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define BENCH_DEFAULT_REPETITIONS 10
+#define BENCH_DEFAULT_MIN_TIME 0.05  /* seconds each repetition should take at least */
+
+typedef struct _bench_suite BenchSuite;
+typedef struct _bench Bench;
+
+/*
+ * A benchmark is a function that does what it measures bench_iterations(b)
+ * times. run_bench_suite calls it with growing iteration counts until one
+ * call takes at least the suite's min time, does one more call as a warmup,
+ * then times a number of repetitions at that count and reports the median,
+ * p99, and standard deviation of the time per iteration:
+ *
+ *   static void string_copy_bench(Bench *b) {
+ *       String *str = ...;  (setup is timed too unless the timer is paused)
+ *       bench_set_bytes(b, str->len);
+ *
+ *       size_t i;
+ *       for (i = 0; i < bench_iterations(b); i++) {
+ *           String *copy = string_copy(str);
+ *           bench_do_not_optimize(copy);
+ *           free_string(copy);
+ *       }
+ *   }
+ *
+ * Like TestSuite, names should be string literals that outlive the suite.
+ */
+
+BenchSuite *create_bench_suite(const char *name);
+void free_bench_suite(BenchSuite *suite);
+void suite_add_bench(BenchSuite *suite, const char *bench_name, void (*run)(Bench *));
+void bench_suite_set_repetitions(BenchSuite *suite, unsigned int repetitions);
+void bench_suite_set_min_time(BenchSuite *suite, double seconds);
+
+/*
+ * Also count cycles, instructions, cache misses, and branch misses while
+ * each benchmark's timer runs, and report IPC, misses per iteration, and the
+ * branch misprediction rate. Uses Linux perf events, so only the calling
+ * thread is counted, and perf_event_paranoid must be 2 or lower (or the
+ * process privileged). Counters the cpu lacks are shown as "-".
+ *
+ * Errors (errno values):
+ *     ENOSYS - not Linux, or the kernel has no perf events
+ *     ENOENT - no hardware counters here (common in virtual machines)
+ *     EACCES - not allowed to count (perf_event_paranoid too high)
+ *
+ * Returns:
+ *     0 if counting, or an errno value above, in which case the suite runs as if this wasn't called
+ */
+int bench_suite_enable_counters(BenchSuite *suite);
+void run_bench_suite(BenchSuite *suite, int verbose);
+
+/*
+ * Results of the last run_bench_suite as JSON: the summary and every
+ * repetition's time for each benchmark, plus the date, host, cpu, compiler,
+ * and flags they were measured with. run_bench_suite writes this to
+ * $ILC_REPORT_DIR/<suite name>.json on its own when that variable is set, and
+ * build/bench/bench_compare tells whether one such file is slower than another.
+ */
+void bench_suite_write_json(const BenchSuite *suite, FILE *out);
+
+/* for use inside a benchmark */
+size_t bench_iterations(const Bench *b);
+void bench_pause_timer(Bench *b);  /* exclude setup or cleanup from the measurement */
+void bench_resume_timer(Bench *b);
+void bench_set_bytes(Bench *b, size_t bytes_per_iteration);  /* report throughput in bytes/s */
+void bench_set_items(Bench *b, size_t items_per_iteration);  /* report throughput in items/s */
+
+/* pin the calling thread to one cpu so runs don't migrate between cores, 0 or errno */
+int bench_pin_cpu(int cpu);
+
+/* make the compiler assume the pointed to memory is read, so the work producing it is kept */
+static inline void bench_do_not_optimize(const void *p) {
+    __asm__ __volatile__("" : : "g"(p) : "memory");
+}
+
+/* make the compiler assume all memory was written, so values can't be cached across it */
+static inline void bench_clobber(void) {
+    __asm__ __volatile__("" : : : "memory");
+}
+
+#endif
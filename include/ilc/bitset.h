@@ -0,0 +1,225 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct bitset Bitset;
+typedef struct roaring_bitmap RoaringBitmap;
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * Bitset *create_bitset(size_t num_bits)
+ * void free_bitset(Bitset *bits)
+ * size_t bitset_size(const Bitset *bits)
+ * int bitset_set(Bitset *bits, size_t pos)
+ * int bitset_clear(Bitset *bits, size_t pos)
+ * int bitset_test(const Bitset *bits, size_t pos)
+ * size_t bitset_count(const Bitset *bits)
+ * size_t bitset_rank(Bitset *bits, size_t pos)
+ * int bitset_select(Bitset *bits, size_t k, size_t *pos)
+ * int bitset_and(Bitset *dest, const Bitset *src)
+ * int bitset_or(Bitset *dest, const Bitset *src)
+ * int bitset_xor(Bitset *dest, const Bitset *src)
+ *
+ * RoaringBitmap *create_roaring_bitmap(void)
+ * void free_roaring_bitmap(RoaringBitmap *r)
+ * int roaring_add(RoaringBitmap *r, uint32_t value)
+ * int roaring_remove(RoaringBitmap *r, uint32_t value)
+ * int roaring_contains(const RoaringBitmap *r, uint32_t value)
+ * size_t roaring_cardinality(const RoaringBitmap *r)
+ * RoaringBitmap *roaring_and(const RoaringBitmap *r1, const RoaringBitmap *r2)
+ * RoaringBitmap *roaring_or(const RoaringBitmap *r1, const RoaringBitmap *r2)
+ * size_t roaring_to_array(const RoaringBitmap *r, uint32_t *values)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates a dense bitset of num_bits bits (numbered 0 to num_bits - 1), all
+ * of which start cleared. Bits are stored in 64-bit words so counting and the
+ * set operations below work a word at a time.
+ *
+ * Errors (errno values):
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: a pointer to the bitset on success and NULL on failure.
+ */
+Bitset *create_bitset(size_t num_bits);
+
+
+/*
+ * Frees the memory allocated for a bitset. Calling on a NULL pointer does
+ * nothing.
+ */
+void free_bitset(Bitset *bits);
+
+
+/*
+ * Returns: the number of bits in the bitset (0 and errno = EFAULT if NULL).
+ */
+size_t bitset_size(const Bitset *bits);
+
+
+/*
+ * Set (to 1) or clear (to 0) the bit at pos.
+ *
+ * Errors (errno values):
+ *   EFAULT: the bits argument was NULL
+ *   EDOM: pos is not less than the size of the bitset
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int bitset_set(Bitset *bits, size_t pos);
+int bitset_clear(Bitset *bits, size_t pos);
+
+
+/*
+ * Errors (errno values):
+ *   EFAULT: the bits argument was NULL
+ *   EDOM: pos is not less than the size of the bitset
+ *
+ * Returns: 1 if the bit at pos is set, 0 if it isn't or on failure.
+ */
+int bitset_test(const Bitset *bits, size_t pos);
+
+
+/*
+ * Returns: the number of set bits (0 and errno = EFAULT if NULL).
+ */
+size_t bitset_count(const Bitset *bits);
+
+
+/*
+ * Count the set bits before pos (i.e. in the range [0, pos)). pos may equal
+ * the size of the bitset, which counts every bit.
+ *
+ * Rank and select keep a directory of cumulative counts (one per 512 bits)
+ * which is rebuilt lazily after the bitset changes, so a run of queries costs
+ * one popcount pass plus a few word popcounts per query. This is why bits is
+ * not const.
+ *
+ * Errors (errno values):
+ *   EFAULT: the bits argument was NULL
+ *   EDOM: pos is greater than the size of the bitset
+ *   ENOMEM: failed to allocate space for the directory (out of memory)
+ *
+ * Returns: the number of set bits before pos, 0 on failure.
+ */
+size_t bitset_rank(Bitset *bits, size_t pos);
+
+
+/*
+ * Find the position of the set bit with rank k, that is the (k + 1)th set bit
+ * from the start, and write it to pos. Like bitset_rank, this rebuilds the
+ * directory if the bitset has changed, which is why bits is not const.
+ *
+ * Errors (errno values):
+ *   EFAULT: bits, pos, or both were NULL
+ *   EDOM: fewer than k + 1 bits are set
+ *   ENOMEM: failed to allocate space for the directory (out of memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int bitset_select(Bitset *bits, size_t k, size_t *pos);
+
+
+/*
+ * Combine src into dest in place, word by word (dest = dest & src, etc.). The
+ * loops are simple enough for the compiler to vectorize.
+ *
+ * Errors (errno values):
+ *   EFAULT: dest, src, or both were NULL
+ *   EINVAL: the bitsets have different sizes
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int bitset_and(Bitset *dest, const Bitset *src);
+int bitset_or(Bitset *dest, const Bitset *src);
+int bitset_xor(Bitset *dest, const Bitset *src);
+
+
+/*
+ * Allocates an empty compressed bitmap of 32-bit values. Values are grouped by
+ * their upper 16 bits and each group is stored as a sorted array of the lower
+ * 16 bits while it holds at most 4096 values, or as a 65536 bit dense bitmap
+ * otherwise (the roaring bitmap layout). This keeps sparse sets small while
+ * dense regions still get word-at-a-time operations. A bitmap that shrinks
+ * only goes back to an array below 3072 values, so adding and removing values
+ * around 4096 doesn't convert the group every time.
+ *
+ * Errors (errno values):
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: a pointer to the bitmap on success and NULL on failure.
+ */
+RoaringBitmap *create_roaring_bitmap(void);
+
+
+/*
+ * Frees the memory allocated for a bitmap. Calling on a NULL pointer does
+ * nothing.
+ */
+void free_roaring_bitmap(RoaringBitmap *r);
+
+
+/*
+ * Add value to or remove value from the bitmap. Adding a value that is already
+ * present or removing one that isn't does nothing.
+ *
+ * Errors (errno values):
+ *   EFAULT: the r argument was NULL
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int roaring_add(RoaringBitmap *r, uint32_t value);
+int roaring_remove(RoaringBitmap *r, uint32_t value);
+
+
+/*
+ * Errors (errno values):
+ *   EFAULT: the r argument was NULL
+ *
+ * Returns: 1 if the bitmap contains value, 0 if it doesn't.
+ */
+int roaring_contains(const RoaringBitmap *r, uint32_t value);
+
+
+/*
+ * Returns: the number of values in the bitmap (0 and errno = EFAULT if NULL).
+ */
+size_t roaring_cardinality(const RoaringBitmap *r);
+
+
+/*
+ * Create a new bitmap holding the intersection (and) or union (or) of two
+ * bitmaps.
+ *
+ * Errors (errno values):
+ *   EFAULT: r1, r2, or both were NULL
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: a pointer to the new bitmap on success and NULL on failure.
+ */
+RoaringBitmap *roaring_and(const RoaringBitmap *r1, const RoaringBitmap *r2);
+RoaringBitmap *roaring_or(const RoaringBitmap *r1, const RoaringBitmap *r2);
+
+
+/*
+ * Write the values of the bitmap to values in increasing order. values must
+ * have room for roaring_cardinality(r) values.
+ *
+ * Errors (errno values):
+ *   EFAULT: r, values, or both were NULL
+ *
+ * Returns: the number of values written.
+ */
+size_t roaring_to_array(const RoaringBitmap *r, uint32_t *values);
+
+#endif
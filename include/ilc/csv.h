@@ -0,0 +1,94 @@
+#ifndef CSV_H
+#define CSV_H
+
+#include <stddef.h>
+#include <ilc/string.h>
+#include <ilc/dynarray.h>
+
+typedef struct csv_parser CsvParser;
+typedef int (*csv_record_fn)(const String *fields, size_t num_fields, void *ctx);
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * CsvParser *create_csv_parser(char delim)
+ * void free_csv_parser(CsvParser *parser)
+ * int csv_parse(CsvParser *parser, const String *input, csv_record_fn on_record, void *ctx)
+ * int csv_parse_columns(CsvParser *parser, const String *input, DynArray **columns, size_t num_columns)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates a parser for delimited text with fields separated by delim (','
+ * for CSV, '\t' for TSV, etc.). The parser holds buffers that are reused from
+ * record to record, so one parser should be used for all of the input.
+ *
+ * Quoting follows RFC 4180: a field may be wrapped in double quotes, inside
+ * which delim and newlines are part of the field and "" stands for one ".
+ * Records end with "\n" or "\r\n", and a newline at the end of the input does
+ * not start another record. An empty line is a record with one empty field.
+ *
+ * Errors (errno values):
+ *   EINVAL: delim is '"', '\n', or '\r'
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the parser on success, NULL on failure.
+ */
+CsvParser *create_csv_parser(char delim);
+
+
+/*
+ * Frees the memory allocated for a parser, including the characters of any
+ * unescaped fields given out by csv_parse_columns. Calling on a NULL pointer
+ * does nothing.
+ */
+void free_csv_parser(CsvParser *parser);
+
+
+/*
+ * Parse input, calling on_record with the fields of each record in order.
+ * Quotes are removed from quoted fields. Fields point into input when they
+ * needed no unescaping and into the parser's buffer otherwise, so they are
+ * only valid until on_record returns. Parsing stops early (successfully) if
+ * on_record returns non-zero.
+ *
+ * input is classified 64 bytes at a time into bitmasks of quotes, delimiters,
+ * and newlines. A prefix xor of the quote mask marks the bytes inside quotes,
+ * which leaves only the delimiters and newlines that end fields, so nothing
+ * is done per byte except building the masks.
+ *
+ * Errors (errno values):
+ *   EFAULT: parser, input, on_record, or a combination were NULL
+ *   EINVAL: input ends inside a quoted field
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int csv_parse(CsvParser *parser, const String *input, csv_record_fn on_record, void *ctx);
+
+
+/*
+ * Parse input into columns: field i of each record is appended to columns[i],
+ * which must have been created with an item size of sizeof(String). Fields
+ * point into input or, when they needed unescaping, into memory owned by the
+ * parser, so they are valid until input or the parser is freed (whichever is
+ * first). Every record must have num_columns fields. On failure, the records
+ * before the one that failed have been appended.
+ *
+ * Errors (errno values):
+ *   EFAULT: parser, input, columns, or a combination were NULL
+ *   EINVAL: input ends inside a quoted field, or a record doesn't have
+ *           num_columns fields
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int csv_parse_columns(CsvParser *parser, const String *input, DynArray **columns,
+                      size_t num_columns);
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef DEQUE_H
+#define DEQUE_H
+
+#include <stddef.h>
+
+typedef struct deque Deque;
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * Deque *create_deque(size_t item_size)
+ * Deque *create_deque_sized(size_t item_size, size_t initial_capacity)
+ * void free_deque(Deque *deque)
+ * int deque_push_front(Deque *deque, const void *item)
+ * int deque_push_back(Deque *deque, const void *item)
+ * int deque_pop_front(Deque *deque, void *item)
+ * int deque_pop_back(Deque *deque, void *item)
+ * size_t deque_length(const Deque *deque)
+ * void *deque_item_at(const Deque *deque, size_t index)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates an empty double ended queue of items that are item_size bytes
+ * each. Items are copied in and out like DynArray, but the items live in a
+ * ring buffer, so adding or removing at either end is O(1) instead of moving
+ * every item the way dynarray_insert(arr, item, 0) does. The capacity is
+ * always a power of 2 so positions wrap with a mask instead of a division.
+ *
+ * Errors (errno values):
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the deque on success, NULL on failure.
+ */
+Deque *create_deque(size_t item_size);
+
+
+/*
+ * Same as create_deque, but with room for at least initial_capacity items
+ * (rounded up to a power of 2) before the deque grows.
+ */
+Deque *create_deque_sized(size_t item_size, size_t initial_capacity);
+
+
+/*
+ * Frees the memory allocated for a deque. Calling on a NULL pointer does
+ * nothing.
+ */
+void free_deque(Deque *deque);
+
+
+/*
+ * Add a copy of item before the first item (push_front) or after the last
+ * item (push_back). The deque doubles in size when full.
+ *
+ * Errors (errno values):
+ *   EFAULT: deque, item, or both were NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int deque_push_front(Deque *deque, const void *item);
+int deque_push_back(Deque *deque, const void *item);
+
+
+/*
+ * Remove the first item (pop_front) or last item (pop_back), copying it to
+ * item first unless item is NULL.
+ *
+ * Errors (errno values):
+ *   EFAULT: the deque argument was NULL
+ *   EINVAL: the deque is empty
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int deque_pop_front(Deque *deque, void *item);
+int deque_pop_back(Deque *deque, void *item);
+
+
+/*
+ * Returns: the number of items in the deque (0 and errno = EFAULT if NULL).
+ */
+size_t deque_length(const Deque *deque);
+
+
+/*
+ * Get the item at index, counting from the front. The pointer is into the
+ * deque, so it is only valid until the deque is next changed.
+ *
+ * Errors (errno values):
+ *   EFAULT: the deque argument was NULL
+ *   EINVAL: index is not less than the deque's length
+ *
+ * Returns: a pointer to the item on success, NULL on failure.
+ */
+void *deque_item_at(const Deque *deque, size_t index);
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef GAP_BUFFER_H
+#define GAP_BUFFER_H
+
+#include <stddef.h>
+
+typedef struct gap_buffer GapBuffer;
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * GapBuffer *create_gap_buffer(size_t item_size)
+ * GapBuffer *create_gap_buffer_sized(size_t item_size, size_t initial_capacity)
+ * void free_gap_buffer(GapBuffer *buf)
+ * size_t gap_buffer_length(const GapBuffer *buf)
+ * size_t gap_buffer_cursor(const GapBuffer *buf)
+ * int gap_buffer_move_cursor(GapBuffer *buf, size_t index)
+ * int gap_buffer_insert(GapBuffer *buf, const void *items, size_t count)
+ * int gap_buffer_delete_before(GapBuffer *buf, size_t count)
+ * int gap_buffer_delete_after(GapBuffer *buf, size_t count)
+ * void *gap_buffer_item_at(const GapBuffer *buf, size_t index)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates an empty gap buffer of items that are item_size bytes each. A gap
+ * buffer is an array with a cursor, like the cursor in a text editor, and all
+ * edits happen at the cursor. The unused space is kept as a gap at the
+ * cursor, so inserting or deleting there is O(1) amortized instead of moving
+ * the rest of the array like dynarray_insert and dynarray_remove_at do. Moving
+ * the cursor moves only the items it passes over, so a run of edits close
+ * together is cheap.
+ *
+ * Errors (errno values):
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the gap buffer on success, NULL on failure.
+ */
+GapBuffer *create_gap_buffer(size_t item_size);
+
+
+/*
+ * Same as create_gap_buffer, but with room for initial_capacity items before
+ * the gap buffer grows.
+ */
+GapBuffer *create_gap_buffer_sized(size_t item_size, size_t initial_capacity);
+
+
+/*
+ * Frees the memory allocated for a gap buffer. Calling on a NULL pointer does
+ * nothing.
+ */
+void free_gap_buffer(GapBuffer *buf);
+
+
+/*
+ * Returns: the number of items in the gap buffer (0 and errno = EFAULT if
+ * NULL).
+ */
+size_t gap_buffer_length(const GapBuffer *buf);
+
+
+/*
+ * Returns: the cursor, which is the index the next inserted item will have
+ * (0 and errno = EFAULT if NULL).
+ */
+size_t gap_buffer_cursor(const GapBuffer *buf);
+
+
+/*
+ * Move the cursor to index, which may equal the length to move it to the end.
+ *
+ * Errors (errno values):
+ *   EFAULT: the buf argument was NULL
+ *   EINVAL: index is greater than the gap buffer's length
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int gap_buffer_move_cursor(GapBuffer *buf, size_t index);
+
+
+/*
+ * Insert copies of count items (an array of them) at the cursor and move the
+ * cursor past them, the way typing moves a text cursor.
+ *
+ * Errors (errno values):
+ *   EFAULT: buf, items, or both were NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int gap_buffer_insert(GapBuffer *buf, const void *items, size_t count);
+
+
+/*
+ * Remove count items just before the cursor (like backspace) or just after it
+ * (like delete). delete_before moves the cursor back by count.
+ *
+ * Errors (errno values):
+ *   EFAULT: the buf argument was NULL
+ *   EINVAL: there are fewer than count items on that side of the cursor
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int gap_buffer_delete_before(GapBuffer *buf, size_t count);
+int gap_buffer_delete_after(GapBuffer *buf, size_t count);
+
+
+/*
+ * Get the item at index. The pointer is into the gap buffer, so it is only
+ * valid until the gap buffer is next changed or its cursor moves.
+ *
+ * Errors (errno values):
+ *   EFAULT: the buf argument was NULL
+ *   EINVAL: index is not less than the gap buffer's length
+ *
+ * Returns: a pointer to the item on success, NULL on failure.
+ */
+void *gap_buffer_item_at(const GapBuffer *buf, size_t index);
+
+#endif
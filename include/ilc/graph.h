@@ -0,0 +1,222 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stddef.h>
+
+#define GRAPH_UNREACHABLE ((size_t) -1)  /* distance/parent of vertices a search never reached */
+
+typedef struct graph_builder GraphBuilder;
+typedef struct graph Graph;
+typedef struct graph_scratch GraphScratch;
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * GraphBuilder *create_graph_builder(size_t num_vertices, int directed)
+ * void free_graph_builder(GraphBuilder *builder)
+ * int graph_builder_add_edge(GraphBuilder *builder, size_t from, size_t to, double weight)
+ * Graph *graph_builder_freeze(const GraphBuilder *builder)
+ * void free_graph(Graph *graph)
+ * size_t graph_num_vertices(const Graph *graph)
+ * size_t graph_num_edges(const Graph *graph)
+ * int graph_is_directed(const Graph *graph)
+ * const size_t *graph_neighbors(const Graph *graph, size_t vertex, const double **weights, size_t *degree)
+ * GraphScratch *create_graph_scratch(const Graph *graph)
+ * void free_graph_scratch(GraphScratch *scratch)
+ * int graph_bfs(const Graph *graph, GraphScratch *scratch, size_t source, size_t *dist, size_t *parent)
+ * int graph_dijkstra(const Graph *graph, GraphScratch *scratch, size_t source, double *dist, size_t *parent)
+ * size_t graph_connected_components(const Graph *graph, GraphScratch *scratch, size_t *component)
+ * int graph_topological_sort(const Graph *graph, GraphScratch *scratch, size_t *order)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates a graph builder for a graph with vertices numbered 0 to
+ * num_vertices - 1. Edges are accumulated in the builder (in any order) and
+ * then frozen into an immutable Graph with graph_builder_freeze. If directed is
+ * 0, every edge added is traversable in both directions.
+ *
+ * Errors (errno values):
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: a pointer to the builder on success and NULL on failure.
+ */
+GraphBuilder *create_graph_builder(size_t num_vertices, int directed);
+
+
+/*
+ * Frees the memory allocated for a builder. Graphs previously frozen from the
+ * builder are not affected. Calling on a NULL pointer does nothing.
+ */
+void free_graph_builder(GraphBuilder *builder);
+
+
+/*
+ * Adds an edge from one vertex to another with the given weight. Weights are
+ * only used by graph_dijkstra, which requires them to be non-negative.
+ *
+ * Errors (errno values):
+ *   EFAULT: the builder argument was NULL
+ *   EINVAL: from or to is not a vertex of the graph
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int graph_builder_add_edge(GraphBuilder *builder, size_t from, size_t to, double weight);
+
+
+/*
+ * Creates a graph from the edges currently in the builder. The graph is stored
+ * in compressed sparse row form: one contiguous array of neighbors (and one of
+ * weights) ordered by source vertex, plus an array of offsets into it. The
+ * neighbors of each vertex keep the order in which their edges were added.
+ *
+ * Errors (errno values):
+ *   EFAULT: the builder argument was NULL
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: a pointer to the graph on success and NULL on failure.
+ */
+Graph *graph_builder_freeze(const GraphBuilder *builder);
+
+
+/*
+ * Frees the memory allocated for a graph. Calling on a NULL pointer does
+ * nothing.
+ */
+void free_graph(Graph *graph);
+
+
+/*
+ * Returns: the number of vertices in the graph (0 and errno = EFAULT if NULL).
+ */
+size_t graph_num_vertices(const Graph *graph);
+
+
+/*
+ * Returns: the number of stored (directed) edges in the graph. Each edge of an
+ * undirected graph is stored twice, once per direction. Returns 0 and sets
+ * errno to EFAULT if graph is NULL.
+ */
+size_t graph_num_edges(const Graph *graph);
+
+
+/*
+ * Returns: 1 if the graph is directed, 0 if it isn't (0 and errno = EFAULT if
+ * graph is NULL).
+ */
+int graph_is_directed(const Graph *graph);
+
+
+/*
+ * Get the neighbors of a vertex. The returned pointer points directly into the
+ * graph's adjacency array and is valid for as long as the graph is. If weights
+ * is not NULL, a pointer to the matching edge weights is written to it. The
+ * number of neighbors is written to degree, which must not be NULL.
+ *
+ * Errors (errno values):
+ *   EFAULT: graph or degree was NULL
+ *   EINVAL: vertex is not a vertex of the graph
+ *
+ * Returns: a pointer to the neighbors on success, NULL on failure.
+ */
+const size_t *graph_neighbors(const Graph *graph, size_t vertex, const double **weights,
+                              size_t *degree);
+
+
+/*
+ * Allocates the working memory (queue, heap, etc.) used by the traversal
+ * functions below, sized for the given graph. A scratch can be reused for any
+ * number of traversals of that graph (or of a graph with no more vertices), so
+ * that traversals themselves never allocate. A scratch must not be shared by
+ * concurrent traversals.
+ *
+ * Errors (errno values):
+ *   EFAULT: the graph argument was NULL
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: a pointer to the scratch on success and NULL on failure.
+ */
+GraphScratch *create_graph_scratch(const Graph *graph);
+
+
+/*
+ * Frees the memory allocated for a scratch. Calling on a NULL pointer does
+ * nothing.
+ */
+void free_graph_scratch(GraphScratch *scratch);
+
+
+/*
+ * Breadth first search from the source vertex. The number of edges on a
+ * shortest path from the source to each vertex is written to dist and the
+ * previous vertex on that path to parent. Vertices that can't be reached have
+ * both set to GRAPH_UNREACHABLE, as does the parent of the source. Either
+ * output array may be NULL, otherwise it must hold one entry per vertex.
+ *
+ * Errors (errno values):
+ *   EFAULT: graph or scratch was NULL
+ *   EINVAL: source is not a vertex of the graph, or the scratch is too small
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int graph_bfs(const Graph *graph, GraphScratch *scratch, size_t source, size_t *dist,
+              size_t *parent);
+
+
+/*
+ * Single source shortest paths using Dijkstra's algorithm with an indexed
+ * 4-ary heap. The total weight of a shortest path from the source to each
+ * vertex is written to dist (HUGE_VAL if unreachable) and the previous vertex
+ * on that path to parent (GRAPH_UNREACHABLE for the source and unreachable
+ * vertices). dist must hold one entry per vertex, parent may be NULL.
+ *
+ * Edge weights must be non-negative, otherwise the results are meaningless.
+ *
+ * Errors (errno values):
+ *   EFAULT: graph, scratch, or dist was NULL
+ *   EINVAL: source is not a vertex of the graph, or the scratch is too small
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int graph_dijkstra(const Graph *graph, GraphScratch *scratch, size_t source, double *dist,
+                   size_t *parent);
+
+
+/*
+ * Label the connected components of the graph. Edge directions are ignored,
+ * so for directed graphs these are the weakly connected components.
+ * Components are numbered from 0 in order of their lowest vertex and each
+ * vertex's component number is written to component, which must hold one
+ * entry per vertex.
+ *
+ * Errors (errno values):
+ *   EFAULT: graph, scratch, or component was NULL
+ *   EINVAL: the scratch is too small
+ *
+ * Returns: the number of components on success, 0 on failure.
+ */
+size_t graph_connected_components(const Graph *graph, GraphScratch *scratch, size_t *component);
+
+
+/*
+ * Write the vertices of a directed acyclic graph to order such that every edge
+ * goes from a vertex earlier in order to one later in it (Kahn's algorithm,
+ * vertices without incoming edges are visited in increasing order). order must
+ * hold one entry per vertex.
+ *
+ * Errors (errno values):
+ *   EFAULT: graph, scratch, or order was NULL
+ *   EINVAL: the graph is undirected, or the scratch is too small
+ *   EDOM: the graph has a cycle (order holds a partial ordering)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int graph_topological_sort(const Graph *graph, GraphScratch *scratch, size_t *order);
+
+#endif
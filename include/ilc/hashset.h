@@ -0,0 +1,154 @@
+#ifndef HASHSET_H
+#define HASHSET_H
+
+#include <stddef.h>
+#include <ilc/dynarray.h>
+
+typedef struct hashset HashSet;
+typedef size_t (*hash_fn)(const void *);
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * HashSet *create_hashset(size_t item_size, hash_fn hash, compare_fn equal)
+ * HashSet *create_hashset_sized(size_t item_size, hash_fn hash, compare_fn equal, size_t initial_capacity)
+ * void free_hashset(HashSet *set)
+ * int hashset_add(HashSet *set, const void *item)
+ * int hashset_remove(HashSet *set, const void *item)
+ * int hashset_contains(const HashSet *set, const void *item)
+ * void *hashset_get(const HashSet *set, const void *item)
+ * size_t hashset_length(const HashSet *set)
+ * void *hashset_next(const HashSet *set, size_t *cursor)
+ * void hashset_clear(HashSet *set)
+ * size_t hash_bytes(const void *data, size_t len)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates an empty hash set of items that are item_size bytes each. Items
+ * are copied into the set (like DynArray), hashed with the given hash function
+ * and compared with the given equality function, which returns non-zero when
+ * two items are equal. Items that are equal must have the same hash.
+ *
+ * The set uses open addressing with linear probing over one contiguous slot
+ * array, so lookups touch few cache lines and removals leave no tombstones.
+ *
+ * Errors (errno values):
+ *   EFAULT: hash or equal was NULL
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: a pointer to the set on success and NULL on failure.
+ */
+HashSet *create_hashset(size_t item_size, hash_fn hash, compare_fn equal);
+
+
+/*
+ * Same as create_hashset, but sized so that initial_capacity items can be
+ * added without the set growing.
+ */
+HashSet *create_hashset_sized(size_t item_size, hash_fn hash, compare_fn equal,
+                              size_t initial_capacity);
+
+
+/*
+ * Frees the memory allocated for a set. Calling on a NULL pointer does nothing.
+ */
+void free_hashset(HashSet *set);
+
+
+/*
+ * Add a copy of item to the set if no equal item is in it already.
+ *
+ * Errors (errno values):
+ *   EFAULT: set, item, or both were NULL
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: 0 if the item was added, EEXIST if an equal item was already in the
+ * set (nothing is changed and errno is not set), errno of error on failure
+ * (errno is set too).
+ */
+int hashset_add(HashSet *set, const void *item);
+
+
+/*
+ * Remove the item equal to the given item from the set, if there is one.
+ * Pointers previously returned by hashset_get and hashset_next are invalidated.
+ *
+ * Errors (errno values):
+ *   EFAULT: set, item, or both were NULL
+ *
+ * Returns: 0 on success (even if no item was removed), errno of error on
+ * failure (errno is set too).
+ */
+int hashset_remove(HashSet *set, const void *item);
+
+
+/*
+ * Check if an item equal to the given item is in the set.
+ *
+ * Errors (errno values):
+ *   EFAULT: set, item, or both were NULL
+ *
+ * Returns: 1 if the set contains the item, 0 if it doesn't.
+ */
+int hashset_contains(const HashSet *set, const void *item);
+
+
+/*
+ * Get a pointer to the item in the set which is equal to the given item. The
+ * pointer is valid until the set is next modified.
+ *
+ * Errors (errno values):
+ *   EFAULT: set, item, or both were NULL
+ *
+ * Returns: a pointer to the item, or NULL if there is no such item.
+ */
+void *hashset_get(const HashSet *set, const void *item);
+
+
+/*
+ * Returns: the number of items in the set (0 and errno = EFAULT if NULL).
+ */
+size_t hashset_length(const HashSet *set);
+
+
+/*
+ * Iterate over the items of a set in no particular order. cursor should point
+ * to a size_t that is 0 before the first call and is only updated by this
+ * function afterwards. The set must not be modified during iteration.
+ *
+ * ex: size_t cursor = 0; void *item;
+ *     while ((item = hashset_next(set, &cursor)) != NULL) { ... }
+ *
+ * Errors (errno values):
+ *   EFAULT: set, cursor, or both were NULL
+ *
+ * Returns: a pointer to the next item, or NULL when there are no more items.
+ */
+void *hashset_next(const HashSet *set, size_t *cursor);
+
+
+/*
+ * Remove all items from a set without releasing its memory.
+ *
+ * No errors possible (a NULL set is ignored).
+ */
+void hashset_clear(HashSet *set);
+
+
+/*
+ * Hash len bytes of data (64-bit FNV-1a folded with a final avalanche step).
+ * Useful for writing a hash_fn for plain old data items.
+ *
+ * No errors possible.
+ *
+ * Returns: the hash.
+ */
+size_t hash_bytes(const void *data, size_t len);
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include <stddef.h>
+#include <ilc/string.h>
+
+#define LINE_READER_DEFAULT_BUFFER_SIZE (64 * 1024)
+
+typedef struct line_reader LineReader;
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * LineReader *create_line_reader(int fd, const String *delim, size_t buffer_size)
+ * void free_line_reader(LineReader *reader)
+ * int line_reader_next(LineReader *reader, String *record)  (0 per record, then ENODATA at the end)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates a reader that splits everything read from the file descriptor fd
+ * (a file, pipe, socket, stdin, etc.) into records separated by delim, like
+ * string_split, but without needing the whole input in memory. Use a delim of
+ * "\n" to read lines.
+ *
+ * Input is read in chunks of up to buffer_size bytes into one buffer that is
+ * reused for every record (0 means LINE_READER_DEFAULT_BUFFER_SIZE). Records
+ * longer than the buffer are still read whole, the buffer grows to fit them.
+ * delim is copied, and the reader never closes fd.
+ *
+ * Errors (errno values):
+ *   EFAULT: the delim argument was NULL
+ *   EINVAL: delim is the empty string
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the reader on success, NULL on failure.
+ */
+LineReader *create_line_reader(int fd, const String *delim, size_t buffer_size);
+
+
+/*
+ * Frees the memory allocated for a reader (but does not close its fd). Calling
+ * on a NULL pointer does nothing.
+ */
+void free_line_reader(LineReader *reader);
+
+
+/*
+ * Read the next record (without its delimiter) into record. record is set to
+ * point into the reader's buffer rather than a copy, so it is only valid until
+ * the next call to line_reader_next or free_line_reader, and it must not be
+ * freed. Use string_copy to keep it longer.
+ *
+ * Unlike string_split, a delimiter at the very end of the input does not
+ * produce an empty last record ("a\nb\n" and "a\nb" both give "a" then "b").
+ * Reads interrupted by signals are retried.
+ *
+ * Reading every record looks like:
+ *
+ *   while ((result = line_reader_next(reader, &record)) == 0) {
+ *       ...use record...
+ *   }
+ *   if (result != ENODATA) {
+ *       ...a read failed...
+ *   }
+ *
+ * Errors (errno values):
+ *   ENODATA: there are no more records (the end of input, not a failure)
+ *   EFAULT: reader, record, or both were NULL
+ *   ENOMEM: failed to grow the buffer for a long record (no memory)
+ *   Any errno set by read (e.g. EBADF, EAGAIN on a non-blocking fd)
+ *
+ * Returns: 0 if a record was read, errno of error otherwise (errno is set too).
+ */
+int line_reader_next(LineReader *reader, String *record);
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stddef.h>
+
+#define LOGGER_LEVEL_DEBUG 0
+#define LOGGER_LEVEL_INFO 1
+#define LOGGER_LEVEL_WARN 2
+#define LOGGER_LEVEL_ERROR 3
+
+#define LOGGER_MAX_ARGS 8  /* format arguments kept per record, the rest of the format is written as is */
+#define LOGGER_TEXT_BYTES 128  /* room for a record's %s arguments, longer ones are cut short */
+#define LOGGER_LINE_MAX 512  /* longest line written, including the prefix */
+#define LOGGER_BATCH 64  /* records the writer takes from a thread at a time, one writev for all */
+
+/*
+ * Calls below LOGGER_COMPILE_LEVEL are removed by the preprocessor, arguments
+ * and all. Define it before including this header (or with -D) to a number
+ * from the levels above, e.g. -DLOGGER_COMPILE_LEVEL=1 drops LOGGER_DEBUG.
+ */
+#ifndef LOGGER_COMPILE_LEVEL
+#define LOGGER_COMPILE_LEVEL LOGGER_LEVEL_DEBUG
+#endif
+
+typedef struct logger Logger;
+
+/*
+ * Logging that doesn't make the caller wait on stdio or the file. A call like
+ *
+ *   LOGGER_INFO(logger, "read %zu rows from %s", num_rows, path);
+ *
+ * only copies the format string's address and the arguments into a record
+ * and pushes it onto the calling thread's own SpscQueue. A background thread
+ * pops the records, formats them into lines like
+ *
+ *   2026-01-31T12:00:00.123456Z INFO  [thread 2] read 120 rows from data.csv
+ *
+ * and writes each batch with one writev. Lines from one thread are written
+ * in order, lines from different threads may interleave in any order.
+ *
+ * Each thread's queue holds a fixed number of records, so a logger uses
+ * bounded memory. When a thread logs faster than the writer keeps up, the
+ * records that don't fit are dropped and counted (see logger_dropped), and
+ * the writer notes how many it missed in the log.
+ */
+#if LOGGER_COMPILE_LEVEL <= LOGGER_LEVEL_DEBUG
+#define LOGGER_DEBUG(logger, ...) logger_log(logger, LOGGER_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOGGER_DEBUG(logger, ...) ((void) 0)
+#endif
+
+#if LOGGER_COMPILE_LEVEL <= LOGGER_LEVEL_INFO
+#define LOGGER_INFO(logger, ...) logger_log(logger, LOGGER_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOGGER_INFO(logger, ...) ((void) 0)
+#endif
+
+#if LOGGER_COMPILE_LEVEL <= LOGGER_LEVEL_WARN
+#define LOGGER_WARN(logger, ...) logger_log(logger, LOGGER_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOGGER_WARN(logger, ...) ((void) 0)
+#endif
+
+#if LOGGER_COMPILE_LEVEL <= LOGGER_LEVEL_ERROR
+#define LOGGER_ERROR(logger, ...) logger_log(logger, LOGGER_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOGGER_ERROR(logger, ...) ((void) 0)
+#endif
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * Logger *create_logger(int fd, size_t records_per_thread)
+ * void free_logger(Logger *logger)
+ * int logger_log(Logger *logger, int level, const char *fmt, ...)
+ * void logger_set_level(Logger *logger, int level)
+ * void logger_flush(Logger *logger)
+ * size_t logger_dropped(const Logger *logger)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates a logger that writes to fd (which it doesn't close) and starts
+ * its writer thread. Every thread that logs gets a queue of
+ * records_per_thread records (rounded up to a power of 2) the first time it
+ * does. When a thread exits its queue goes to the next thread to start
+ * logging, so memory grows with the most threads logging at once, not with
+ * every thread ever started.
+ *
+ * Errors (errno values):
+ *   EINVAL: records_per_thread is 0
+ *   ENOMEM: failed to allocate space (no memory)
+ *   EAGAIN: the writer thread couldn't be started
+ *
+ * Returns: a pointer to the logger on success, NULL on failure.
+ */
+Logger *create_logger(int fd, size_t records_per_thread);
+
+
+/*
+ * Writes everything logged so far, stops the writer thread, and frees the
+ * logger and every thread's queue. No thread may log to it once this is
+ * called. Calling on a NULL pointer does nothing.
+ */
+void free_logger(Logger *logger);
+
+
+/*
+ * What the LOGGER_ macros call. fmt is a printf format that must outlive the
+ * logger (a string literal), since only its address is kept until the line
+ * is written. The arguments are copied, %s strings included (up to
+ * LOGGER_TEXT_BYTES for all of a record's strings together).
+ *
+ * Supported conversions are d i o u x X c s p f F e E g G a A and %%, with
+ * flags, a width and precision given as numbers, and the hh h l ll z j t
+ * length modifiers. At the first conversion that isn't supported (like %n,
+ * %Lf, or a * width), or after LOGGER_MAX_ARGS arguments, the rest of the
+ * format is written as it is.
+ *
+ * Errors (errno values):
+ *   EFAULT: logger, fmt, or both were NULL
+ *   EAGAIN: the thread's queue was full, the record was dropped
+ *   ENOMEM: the thread's queue couldn't be allocated, the record was dropped
+ *
+ * Returns: 0 on success (or if level is below the logger's level), errno of
+ * error on failure (errno is set too).
+ */
+int logger_log(Logger *logger, int level, const char *fmt, ...);
+
+
+/*
+ * Drop records below level from now on. Unlike LOGGER_COMPILE_LEVEL, the
+ * filtered calls still evaluate their arguments. Starts at LOGGER_LEVEL_DEBUG.
+ */
+void logger_set_level(Logger *logger, int level);
+
+
+/*
+ * Wait until every record logged before the call (by any thread) has been
+ * written.
+ */
+void logger_flush(Logger *logger);
+
+
+/*
+ * The number of records dropped so far because a queue was full or couldn't
+ * be allocated.
+ */
+size_t logger_dropped(const Logger *logger);
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef PACKED_STRING_LIST_H
+#define PACKED_STRING_LIST_H
+
+#include <stddef.h>
+#include <ilc/string.h>
+
+typedef struct packed_string_list PackedStringList;
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * PackedStringList *create_packed_string_list(void)
+ * void free_packed_string_list(PackedStringList *list)
+ * int packed_string_list_append(PackedStringList *list, const String *str)
+ * size_t packed_string_list_length(const PackedStringList *list)
+ * size_t packed_string_list_bytes(const PackedStringList *list)
+ * int packed_string_list_get(const PackedStringList *list, size_t index, String *view)
+ * PackedStringList *packed_string_list_from_string_list(const StringList *strs)
+ * StringList *packed_string_list_to_string_list(const PackedStringList *list)
+ * int packed_string_list_sort(PackedStringList *list)
+ * const char *packed_string_list_chars(const PackedStringList *list)
+ * const void *packed_string_list_offsets(const PackedStringList *list, size_t *offset_size)
+ * PackedStringList *create_packed_string_list_from_buffers(const char *chars, const void *offsets,
+ *                                                           size_t offset_size, size_t length)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates an empty packed string list. Where a StringList holds a String
+ * (pointer and length, 16 bytes) per string and usually a separate buffer for
+ * each string's chars, a packed list copies all of the chars back to back into
+ * one buffer and keeps only where each string starts. Those offsets are 4
+ * bytes each until the chars pass 4 GiB, then 8 bytes. The two arrays are the
+ * whole list, so writing them out is all it takes to save one (see
+ * packed_string_list_chars, packed_string_list_offsets, and
+ * create_packed_string_list_from_buffers).
+ *
+ * Errors (errno values):
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the list on success, NULL on failure.
+ */
+PackedStringList *create_packed_string_list(void);
+
+
+/*
+ * Frees the memory allocated for a list. Calling on a NULL pointer does
+ * nothing.
+ */
+void free_packed_string_list(PackedStringList *list);
+
+
+/*
+ * Copy str onto the end of the list.
+ *
+ * Errors (errno values):
+ *   EFAULT: list, str, or both were NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int packed_string_list_append(PackedStringList *list, const String *str);
+
+
+/*
+ * Returns: the number of strings in the list (0 and errno = EFAULT if NULL).
+ */
+size_t packed_string_list_length(const PackedStringList *list);
+
+
+/*
+ * Returns: the total length of the strings in the list (0 and errno = EFAULT
+ * if NULL).
+ */
+size_t packed_string_list_bytes(const PackedStringList *list);
+
+
+/*
+ * Set view to the string at index. view points into the list's buffer, so it
+ * is only valid until the list is next appended to, sorted, or freed, and
+ * must not be freed itself. Getting each index in order is the way to iterate
+ * over the list.
+ *
+ * Errors (errno values):
+ *   EFAULT: list, view, or both were NULL
+ *   EDOM: index is not less than the list's length
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int packed_string_list_get(const PackedStringList *list, size_t index, String *view);
+
+
+/*
+ * Create a packed list holding copies of the strings in strs, in order.
+ *
+ * Errors (errno values):
+ *   EFAULT: the strs argument was NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the new list on success, NULL on failure.
+ */
+PackedStringList *packed_string_list_from_string_list(const StringList *strs);
+
+
+/*
+ * Create a string list of views into the packed list (like the list from
+ * string_split). The string list is valid until the packed list is next
+ * appended to, sorted, or freed, and is freed by freeing its strs and then
+ * itself.
+ *
+ * Errors (errno values):
+ *   EFAULT: the list argument was NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the string list on success, NULL on failure.
+ */
+StringList *packed_string_list_to_string_list(const PackedStringList *list);
+
+
+/*
+ * Sort the list in byte order (comparing chars as unsigned bytes, shorter
+ * strings first when one is a prefix of the other). The sort is stable. The
+ * first 8 bytes of every string are cached as one integer while sorting, so
+ * most comparisons are a single integer compare that doesn't touch the chars.
+ *
+ * Errors (errno values):
+ *   EFAULT: the list argument was NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int packed_string_list_sort(PackedStringList *list);
+
+
+/*
+ * Returns: the list's chars buffer, every string back to back and
+ * packed_string_list_bytes long (NULL and errno = EFAULT if list is NULL).
+ * Like a view from packed_string_list_get, it is only valid until the list is
+ * next appended to, sorted, or freed.
+ */
+const char *packed_string_list_chars(const PackedStringList *list);
+
+
+/*
+ * Get the list's offsets: length + 1 unsigned integers in native byte order,
+ * where string i is chars[offsets[i], offsets[i + 1]). offset_size is set to
+ * their size in bytes, 4 or 8. Valid for as long as packed_string_list_chars.
+ *
+ * Errors (errno values):
+ *   EFAULT: list, offset_size, or both were NULL
+ *
+ * Returns: the offsets on success, NULL on failure.
+ */
+const void *packed_string_list_offsets(const PackedStringList *list, size_t *offset_size);
+
+
+/*
+ * Create a list from buffers like the ones packed_string_list_chars and
+ * packed_string_list_offsets return, e.g. after reading them back from a
+ * file. offsets holds length + 1 offsets of offset_size bytes each, starting
+ * at 0 and never decreasing, and chars holds offsets[length] bytes. Both are
+ * copied.
+ *
+ * Errors (errno values):
+ *   EFAULT: offsets was NULL, or chars was NULL with offsets[length] > 0
+ *   EINVAL: offset_size isn't 4 or 8, or the offsets don't start at 0 and
+ *           never decrease
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the new list on success, NULL on failure.
+ */
+PackedStringList *create_packed_string_list_from_buffers(const char *chars, const void *offsets,
+                                                          size_t offset_size, size_t length);
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef PROPERTY_H
+#define PROPERTY_H
+
+#include <stddef.h>
+#include <ilc/string.h>
+#include <ilc/dynarray.h>
+
+#define PROP_SEED_ENV "ILC_PROP_SEED"  /* when set, the seed to use instead of a random one */
+#define PROP_RUNS_ENV "ILC_PROP_RUNS"  /* when set, overrides how many inputs each property is given */
+#define PROP_MAX_BYTES 4096  /* random bytes the largest generated input is drawn from */
+#define PROP_SHRINK_ATTEMPTS 20000  /* reruns spent shrinking a failure before giving up */
+
+typedef struct prop_source PropSource;
+
+/*
+ * A property takes its inputs from src with the draw_ functions, checks
+ * something that should hold for every input, and returns 1 if it held or 0
+ * if not. Anything drawn is freed after the property returns.
+ */
+typedef int (*property_fn)(PropSource *src);
+
+/*
+ * Property based testing. Instead of a few hand picked inputs, a property is
+ * run on many generated ones and compared against a simple reference:
+ *
+ *   static int split_matches_naive(PropSource *src) {
+ *       String *str = draw_string(src, 40, "ab,");
+ *       String *delim = draw_string(src, 3, "ab,");
+ *       ...split str both ways, return whether the lists are equal...
+ *   }
+ *
+ *   return check_property("split matches naive", split_matches_naive, 500, VERBOSE);
+ *
+ * Every draw reads from a buffer of bytes (random ones while testing), and
+ * running out of bytes draws zeros, which the generators turn into their
+ * smallest values. When a property fails, the buffer is shrunk (chunks
+ * deleted, bytes lowered) for as long as it keeps failing, so the reported
+ * input is a small one rather than whatever random input found the bug.
+ *
+ * Since a property is just a function of bytes, it is also a fuzz target,
+ * see run_property_on_bytes.
+ */
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * int check_property(const char *name, property_fn property, unsigned int runs, int verbose)
+ * int run_property_on_bytes(property_fn property, const unsigned char *data, size_t size)
+ * int prop_reporting(const PropSource *src)
+ * unsigned long long draw_uint(PropSource *src, unsigned long long max)
+ * char draw_char(PropSource *src, const char *alphabet)
+ * String *draw_string(PropSource *src, size_t max_len, const char *alphabet)
+ * StringList *draw_string_list(PropSource *src, size_t max_strings, size_t max_len, const char *alphabet)
+ * DynArray *draw_int_dynarray(PropSource *src, size_t max_len, int max_value)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Run property on runs generated inputs, small ones first. The inputs come
+ * from a random seed, or from $ILC_PROP_SEED so a failure can be replayed.
+ * On the first failure the input is shrunk, the seed and shrinking are
+ * printed, and the property is run once more on the smallest failing input
+ * with prop_reporting true so it can print what it was given.
+ *
+ * Returns: SUCCESS if the property held for every input, FAILURE if not (for
+ * use as a test suite's test).
+ */
+int check_property(const char *name, property_fn property, unsigned int runs, int verbose);
+
+
+/*
+ * Run property once with data as the bytes it draws from, e.g. from a
+ * libFuzzer entry point:
+ *
+ *   int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+ *       if (!run_property_on_bytes(split_matches_naive, data, size)) {
+ *           abort();
+ *       }
+ *       return 0;
+ *   }
+ *
+ * Returns: 1 if the property held, 0 if not.
+ */
+int run_property_on_bytes(property_fn property, const unsigned char *data, size_t size);
+
+
+/*
+ * Returns: 1 during check_property's final run on the shrunk input, when a
+ * property should print its inputs and what went wrong, 0 otherwise.
+ */
+int prop_reporting(const PropSource *src);
+
+
+/*
+ * A number from 0 to max (inclusive), 0 once the bytes run out.
+ */
+unsigned long long draw_uint(PropSource *src, unsigned long long max);
+
+
+/*
+ * A byte from alphabet (a C string), or any byte if alphabet is NULL. Small
+ * alphabets make matches likely, e.g. "ab," for testing splits on ",".
+ */
+char draw_char(PropSource *src, const char *alphabet);
+
+
+/*
+ * A string of 0 to max_len chars drawn with draw_char.
+ *
+ * Returns: the string, or NULL if it couldn't be allocated.
+ */
+String *draw_string(PropSource *src, size_t max_len, const char *alphabet);
+
+
+/*
+ * A list of 0 to max_strings strings drawn with draw_string.
+ *
+ * Returns: the list, or NULL if it couldn't be allocated.
+ */
+StringList *draw_string_list(PropSource *src, size_t max_strings, size_t max_len, const char *alphabet);
+
+
+/*
+ * An array of 0 to max_len ints from 0 to max_value.
+ *
+ * Returns: the array, or NULL if it couldn't be allocated.
+ */
+DynArray *draw_int_dynarray(PropSource *src, size_t max_len, int max_value);
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <stddef.h>
+
+#define QUEUE_CACHE_LINE 64  /* hot indices are padded apart by this much to avoid false sharing */
+
+typedef struct spsc_queue SpscQueue;
+typedef struct mpmc_queue MpmcQueue;
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * SpscQueue *create_spsc_queue(size_t item_size, size_t capacity)
+ * void free_spsc_queue(SpscQueue *queue)
+ * int spsc_queue_push(SpscQueue *queue, const void *item)
+ * int spsc_queue_pop(SpscQueue *queue, void *item)
+ * size_t spsc_queue_push_batch(SpscQueue *queue, const void *items, size_t count)
+ * size_t spsc_queue_pop_batch(SpscQueue *queue, void *items, size_t max_count)
+ *
+ * MpmcQueue *create_mpmc_queue(size_t item_size, size_t capacity)
+ * void free_mpmc_queue(MpmcQueue *queue)
+ * int mpmc_queue_push(MpmcQueue *queue, const void *item)
+ * int mpmc_queue_pop(MpmcQueue *queue, void *item)
+ * size_t mpmc_queue_push_batch(MpmcQueue *queue, const void *items, size_t count)
+ * size_t mpmc_queue_pop_batch(MpmcQueue *queue, void *items, size_t max_count)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates an empty single producer, single consumer queue of items that are
+ * item_size bytes each, for handing items from one thread to another. Items
+ * are copied in and out like DynArray. The queue is a fixed size ring buffer
+ * of capacity items (rounded up to a power of 2) and never blocks or locks:
+ * pushing to a full queue or popping from an empty one fails with EAGAIN and
+ * the caller decides whether to retry, spin, or sleep.
+ *
+ * Exactly one thread may push and exactly one (other) thread may pop at a
+ * time. Each side keeps its own copy of the other side's index and only
+ * reloads it when the queue looks full (or empty), so most pushes and pops
+ * touch no cache line the other thread is writing.
+ *
+ * Errors (errno values):
+ *   EINVAL: capacity is 0
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the queue on success, NULL on failure.
+ */
+SpscQueue *create_spsc_queue(size_t item_size, size_t capacity);
+
+
+/*
+ * Frees the memory allocated for a queue, including any items left in it.
+ * Calling on a NULL pointer does nothing.
+ */
+void free_spsc_queue(SpscQueue *queue);
+
+
+/*
+ * Push a copy of item onto the back of the queue (producer thread only).
+ *
+ * Errors (errno values):
+ *   EFAULT: queue, item, or both were NULL
+ *   EAGAIN: the queue is full
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int spsc_queue_push(SpscQueue *queue, const void *item);
+
+
+/*
+ * Pop the item at the front of the queue, copying it to item (consumer thread
+ * only).
+ *
+ * Errors (errno values):
+ *   EFAULT: queue, item, or both were NULL
+ *   EAGAIN: the queue is empty
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int spsc_queue_pop(SpscQueue *queue, void *item);
+
+
+/*
+ * Push as many of the count items (an array of them) as fit, in order, and
+ * publish them all at once. Pushing many items this way costs about the same
+ * synchronization as pushing one.
+ *
+ * Errors (errno values):
+ *   EFAULT: queue, items, or both were NULL
+ *
+ * Returns: the number of items pushed, which is less than count if the queue
+ * filled up (0 on failure).
+ */
+size_t spsc_queue_push_batch(SpscQueue *queue, const void *items, size_t count);
+
+
+/*
+ * Pop up to max_count items from the front of the queue into items (an array
+ * with room for max_count of them).
+ *
+ * Errors (errno values):
+ *   EFAULT: queue, items, or both were NULL
+ *
+ * Returns: the number of items popped, 0 if the queue was empty (or on
+ * failure).
+ */
+size_t spsc_queue_pop_batch(SpscQueue *queue, void *items, size_t max_count);
+
+
+/*
+ * Allocates an empty multiple producer, multiple consumer queue. It works
+ * like SpscQueue, but any number of threads may push and pop at the same
+ * time. Each slot has a sequence number that says whether it is waiting for a
+ * producer or a consumer and for which lap around the ring, so a thread
+ * claims a slot with one compare and swap and never waits on a lock.
+ *
+ * Errors (errno values):
+ *   EINVAL: capacity is 0
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the queue on success, NULL on failure.
+ */
+MpmcQueue *create_mpmc_queue(size_t item_size, size_t capacity);
+
+
+/*
+ * Frees the memory allocated for a queue, including any items left in it.
+ * Calling on a NULL pointer does nothing.
+ */
+void free_mpmc_queue(MpmcQueue *queue);
+
+
+/*
+ * Push a copy of item onto the back of the queue.
+ *
+ * Errors (errno values):
+ *   EFAULT: queue, item, or both were NULL
+ *   EAGAIN: the queue is full
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int mpmc_queue_push(MpmcQueue *queue, const void *item);
+
+
+/*
+ * Pop the item at the front of the queue, copying it to item.
+ *
+ * Errors (errno values):
+ *   EFAULT: queue, item, or both were NULL
+ *   EAGAIN: the queue is empty
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int mpmc_queue_pop(MpmcQueue *queue, void *item);
+
+
+/*
+ * Push as many of the count items as there are free slots for, claiming them
+ * together with one compare and swap. The items stay in order and next to
+ * each other in the queue.
+ *
+ * Errors (errno values):
+ *   EFAULT: queue, items, or both were NULL
+ *
+ * Returns: the number of items pushed (0 on failure).
+ */
+size_t mpmc_queue_push_batch(MpmcQueue *queue, const void *items, size_t count);
+
+
+/*
+ * Pop up to max_count items that are ready, claiming them together with one
+ * compare and swap.
+ *
+ * Errors (errno values):
+ *   EFAULT: queue, items, or both were NULL
+ *
+ * Returns: the number of items popped (0 if none were ready, or on failure).
+ */
+size_t mpmc_queue_pop_batch(MpmcQueue *queue, void *items, size_t max_count);
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef RADIX_TREE_H
+#define RADIX_TREE_H
+
+#include <stddef.h>
+#include <ilc/string.h>
+
+typedef struct radix_tree RadixTree;
+typedef int (*radix_visit_fn)(const String *key, void *value, void *ctx);
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * RadixTree *create_radix_tree(void)
+ * void free_radix_tree(RadixTree *tree)
+ * int radix_tree_insert(RadixTree *tree, const String *key, void *value)
+ * int radix_tree_insert_all(RadixTree *tree, const StringList *keys, void **values)
+ * int radix_tree_get(const RadixTree *tree, const String *key, void **value)
+ * int radix_tree_longest_prefix(const RadixTree *tree, const String *str, size_t *prefix_len, void **value)
+ * int radix_tree_iterate_prefix(const RadixTree *tree, const String *prefix, radix_visit_fn visit, void *ctx)
+ * size_t radix_tree_length(const RadixTree *tree)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates an empty radix tree mapping String keys to pointer values. The
+ * tree is an adaptive radix tree (ART): common key segments are collapsed into
+ * a single node (path compression) and each node grows through 4, 16, 48 and
+ * 256 child layouts as it gains children, so sparse nodes stay small while
+ * dense ones index their children directly by byte.
+ *
+ * Keys are copied into the tree. Values are stored as given and never freed by
+ * the tree.
+ *
+ * Errors (errno values):
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: a pointer to the tree on success and NULL on failure.
+ */
+RadixTree *create_radix_tree(void);
+
+
+/*
+ * Frees the memory allocated for a tree (but not the values stored in it).
+ * Calling on a NULL pointer does nothing.
+ */
+void free_radix_tree(RadixTree *tree);
+
+
+/*
+ * Map key to value, replacing the value of key if it is already in the tree.
+ * Any string, including the empty string, can be a key, and keys may be
+ * prefixes of each other.
+ *
+ * Errors (errno values):
+ *   EFAULT: tree, key, or both were NULL
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int radix_tree_insert(RadixTree *tree, const String *key, void *value);
+
+
+/*
+ * Insert every string of keys, mapping keys->strs[i] to values[i]. If values
+ * is NULL then every key is mapped to NULL (useful for plain sets of prefixes).
+ * On failure, the keys before the one that failed have been inserted.
+ *
+ * Errors (errno values):
+ *   EFAULT: tree, keys, or both were NULL
+ *   ENOMEM: failed to allocate space (out of memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int radix_tree_insert_all(RadixTree *tree, const StringList *keys, void **values);
+
+
+/*
+ * Look up the value of key and write it to value (if value isn't NULL).
+ *
+ * Errors (errno values):
+ *   EFAULT: tree, key, or both were NULL
+ *
+ * Returns: 1 if key is in the tree, 0 if it isn't.
+ */
+int radix_tree_get(const RadixTree *tree, const String *key, void **value);
+
+
+/*
+ * Find the longest key in the tree that is a prefix of str (e.g. the most
+ * specific route for a request path). Its length is written to prefix_len and
+ * its value to value, either of which may be NULL.
+ *
+ * Errors (errno values):
+ *   EFAULT: tree, str, or both were NULL
+ *
+ * Returns: 1 if some key is a prefix of str, 0 if none is.
+ */
+int radix_tree_longest_prefix(const RadixTree *tree, const String *str, size_t *prefix_len,
+                              void **value);
+
+
+/*
+ * Call visit for each key in the tree that starts with prefix, in
+ * lexicographic (byte) order. The key passed to visit is only valid during the
+ * call. Iteration stops early if visit returns non-zero. The tree must not be
+ * modified during iteration. Use the empty string as prefix to visit every key.
+ *
+ * Errors (errno values):
+ *   EFAULT: tree, prefix, visit, or a combination were NULL
+ *   ENOMEM: failed to allocate space for the key buffer (out of memory)
+ *
+ * Returns: 0 on success (including when stopped early), errno of error on
+ * failure (errno is set too).
+ */
+int radix_tree_iterate_prefix(const RadixTree *tree, const String *prefix, radix_visit_fn visit,
+                              void *ctx);
+
+
+/*
+ * Returns: the number of keys in the tree (0 and errno = EFAULT if NULL).
+ */
+size_t radix_tree_length(const RadixTree *tree);
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef ROPE_H
+#define ROPE_H
+
+#include <stddef.h>
+#include <ilc/string.h>
+
+#define ROPE_LEAF_SIZE 1024  /* most chars a leaf holds */
+
+typedef struct rope Rope;
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * Rope *create_rope(void)
+ * void free_rope(Rope *rope)
+ * size_t rope_length(const Rope *rope)
+ * int rope_insert(Rope *rope, size_t index, const String *str)
+ * int rope_append(Rope *rope, const String *str)
+ * int rope_delete(Rope *rope, size_t start, size_t end)
+ * int rope_char_at(const Rope *rope, size_t index, char *c)
+ * String *rope_substring(const Rope *rope, size_t start, size_t end)
+ * int rope_next_chunk(const Rope *rope, size_t *cursor, String *chunk)
+ * String *rope_to_string(const Rope *rope)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates an empty rope. A rope holds a large string that is edited in
+ * place: its chars are kept in chunks of up to ROPE_LEAF_SIZE chars at the
+ * leaves of a balanced (AVL) tree, and each inner node knows the length of
+ * everything under it. Inserting, deleting, and finding the char at an index
+ * take O(log n) time instead of copying the whole string like string_append
+ * or substring + string_concat would.
+ *
+ * Errors (errno values):
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the rope on success, NULL on failure.
+ */
+Rope *create_rope(void);
+
+
+/*
+ * Frees the memory allocated for a rope. Calling on a NULL pointer does
+ * nothing.
+ */
+void free_rope(Rope *rope);
+
+
+/*
+ * Returns: the number of chars in the rope (0 and errno = EFAULT if NULL).
+ */
+size_t rope_length(const Rope *rope);
+
+
+/*
+ * Insert a copy of str before the char at index, so that it starts at index.
+ * An index equal to the rope's length appends. Small inserts go straight into
+ * the leaf at index when there is room.
+ *
+ * Errors (errno values):
+ *   EFAULT: rope, str, or both were NULL
+ *   EDOM: index is greater than the rope's length
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int rope_insert(Rope *rope, size_t index, const String *str);
+
+
+/*
+ * Same as rope_insert at the rope's length.
+ */
+int rope_append(Rope *rope, const String *str);
+
+
+/*
+ * Remove the chars from start (inclusive) to end (exclusive).
+ *
+ * Errors (errno values):
+ *   EFAULT: the rope argument was NULL
+ *   EDOM: end is greater than the rope's length or start is greater than end
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int rope_delete(Rope *rope, size_t start, size_t end);
+
+
+/*
+ * Write the char at index to c.
+ *
+ * Errors (errno values):
+ *   EFAULT: rope, c, or both were NULL
+ *   EDOM: index is not less than the rope's length
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int rope_char_at(const Rope *rope, size_t index, char *c);
+
+
+/*
+ * Create a new string from the chars between start (inclusive) and end
+ * (exclusive).
+ *
+ * Errors (errno values):
+ *   EFAULT: the rope argument was NULL
+ *   EDOM: end is greater than the rope's length or start is greater than end
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the new string on success, NULL on failure.
+ */
+String *rope_substring(const Rope *rope, size_t start, size_t end);
+
+
+/*
+ * Iterate over the rope's chunks in order, without copying. Start with
+ * *cursor = 0; each call sets chunk to the chars from *cursor to the end of
+ * that leaf and moves *cursor past them. chunk points into the rope, so it is
+ * only valid until the rope is next changed and must not be freed.
+ *
+ * Errors (errno values):
+ *   EFAULT: rope, cursor, chunk, or a combination were NULL
+ *
+ * Returns: 1 if chunk was set, 0 once the cursor reaches the end.
+ */
+int rope_next_chunk(const Rope *rope, size_t *cursor, String *chunk);
+
+
+/*
+ * Create a new string of all of the rope's chars.
+ *
+ * Errors (errno values):
+ *   EFAULT: the rope argument was NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the new string on success, NULL on failure.
+ */
+String *rope_to_string(const Rope *rope);
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef SEGMENTED_ARRAY_H
+#define SEGMENTED_ARRAY_H
+
+#include <stddef.h>
+
+#define SEGMENTED_ARRAY_FIRST_BLOCK_BITS 4  /* the first block holds 1 << 4 = 16 items */
+#define SEGMENTED_ARRAY_MAX_BLOCKS (64 - SEGMENTED_ARRAY_FIRST_BLOCK_BITS)
+
+typedef struct segmented_array SegmentedArray;
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * SegmentedArray *create_segmented_array(size_t item_size)
+ * void free_segmented_array(SegmentedArray *arr)
+ * int segmented_array_append(SegmentedArray *arr, const void *item)
+ * int segmented_array_append_concurrent(SegmentedArray *arr, const void *item)
+ * int segmented_array_reserve(SegmentedArray *arr, size_t capacity)
+ * size_t segmented_array_length(const SegmentedArray *arr)
+ * void *segmented_array_item_at(const SegmentedArray *arr, size_t index)
+ * void *segmented_array_run(const SegmentedArray *arr, size_t index, size_t *count)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * Allocates an empty segmented array of items that are item_size bytes each.
+ * Like DynArray, items are copied in, but instead of one buffer that is
+ * realloc'd (moving every item) the items are stored in blocks that double
+ * in size: 16 items, then 32, 64, and so on. Blocks are never moved or freed
+ * until the array is, so:
+ *
+ *   - pointers from segmented_array_item_at stay valid as the array grows
+ *   - growing only allocates the new block, so there is no moment where the
+ *     old and new copies both exist (realloc can need 2x the memory)
+ *   - other threads can read items while one thread appends (see below)
+ *
+ * Finding an item is O(1), the block and position in it come from the
+ * index's highest set bit.
+ *
+ * Errors (errno values):
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the array on success, NULL on failure.
+ */
+SegmentedArray *create_segmented_array(size_t item_size);
+
+
+/*
+ * Frees the memory allocated for an array, including every block. Calling on
+ * a NULL pointer does nothing.
+ */
+void free_segmented_array(SegmentedArray *arr);
+
+
+/*
+ * Add a copy of item to the end of the array. Only one thread may append at a
+ * time (see segmented_array_append_concurrent for more), but any number of
+ * threads may call segmented_array_length, segmented_array_item_at, and
+ * segmented_array_run while it does without locking. The new length is
+ * published only after the item is written, so readers never see a partly
+ * written item.
+ *
+ * Errors (errno values):
+ *   EFAULT: arr, item, or both were NULL
+ *   ENOMEM: failed to allocate a new block (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int segmented_array_append(SegmentedArray *arr, const void *item);
+
+
+/*
+ * Same as segmented_array_append, except any number of threads may call it at
+ * once (but not at the same time as segmented_array_append). Each appender
+ * claims a slot with an atomic compare and swap, copies its item in without
+ * any lock, and then marks the slot ready. Items are not in the length until
+ * every item before them is ready, so readers still only see fully written
+ * items. Whichever appender finishes the item at the length moves the length
+ * past it and any later items that are already ready.
+ *
+ * New blocks are allocated while appends and reads keep going, and an
+ * appender that reaches the middle of a block allocates the next one early.
+ * The order of items from different threads is whatever order they claimed
+ * slots in, items from one thread keep their order.
+ *
+ * Errors (errno values):
+ *   EFAULT: arr, item, or both were NULL
+ *   ENOMEM: failed to allocate a new block (no memory), nothing was claimed
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int segmented_array_append_concurrent(SegmentedArray *arr, const void *item);
+
+
+/*
+ * Allocate every block needed to hold capacity items now, so appends up to
+ * that many never allocate. Safe to call alongside any other function.
+ *
+ * Errors (errno values):
+ *   EFAULT: the arr argument was NULL
+ *   ENOMEM: failed to allocate a block (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int segmented_array_reserve(SegmentedArray *arr, size_t capacity);
+
+
+/*
+ * Returns: the number of items in the array (0 and errno = EFAULT if NULL).
+ * Every item below this length may be read, even while another thread
+ * appends.
+ */
+size_t segmented_array_length(const SegmentedArray *arr);
+
+
+/*
+ * Get the item at index. The pointer stays valid until the array is freed.
+ *
+ * Errors (errno values):
+ *   EFAULT: the arr argument was NULL
+ *   EINVAL: index is not less than the array's length
+ *
+ * Returns: a pointer to the item on success, NULL on failure.
+ */
+void *segmented_array_item_at(const SegmentedArray *arr, size_t index);
+
+
+/*
+ * Get the item at index and set count to the number of items from it to the
+ * end of its block (or the end of the array if that comes first). Those items
+ * are contiguous, so a loop can go through the array a block at a time:
+ *
+ *   size_t i = 0, count;
+ *   while (i < segmented_array_length(arr)) {
+ *       int *items = segmented_array_run(arr, i, &count);
+ *       ... items[0] through items[count - 1] ...
+ *       i += count;
+ *   }
+ *
+ * Errors (errno values):
+ *   EFAULT: arr, count, or both were NULL
+ *   EINVAL: index is not less than the array's length
+ *
+ * Returns: a pointer to the item on success, NULL on failure.
+ */
+void *segmented_array_run(const SegmentedArray *arr, size_t index, size_t *count);
+
+#endif
@@ -2,6 +2,7 @@
 #define STRING_H
 
 #include <stddef.h>
+#include <ilc/dynarray.h>
 
 typedef struct {
     char *chars;  /* NOT a c string (no null terminator) */
@@ -13,6 +14,23 @@ typedef struct {
     size_t len;
 } StringList;
 
+typedef struct string_matcher StringMatcher;
+typedef struct string_trimmer StringTrimmer;
+
+#define STRING_TRIM_LEFT 1
+#define STRING_TRIM_RIGHT 2
+#define STRING_TRIM_BOTH (STRING_TRIM_LEFT | STRING_TRIM_RIGHT)
+
+/* string_map_file flags */
+#define STRING_MAP_SEQUENTIAL 1  /* read ahead aggressively, drop pages behind */
+#define STRING_MAP_WILLNEED 2  /* start reading the whole file in now */
+#define STRING_MAP_HUGEPAGE 4  /* back the mapping with huge pages where supported */
+
+typedef struct {
+    size_t start;  /* index in the searched string where the match begins */
+    size_t pattern;  /* index of the matched pattern in the matcher's pattern list */
+} StringMatch;
+
 /****************************/
 /* FUNCTION QUICK REFERENCE */
 /****************************/
@@ -22,6 +40,8 @@ typedef struct {
  * String *string_copy(const String *str)
  * String *string_reverse(const String *str)
  * void free_string(String *str)
+ * String *string_map_file(const char *path, int flags)
+ * int string_unmap_file(String *str)
  * String *substring(const String *str, long start, long end)
  * char *string_to_c_string(const String *str)
  * int string_compare(const String *str1, const String *str2)
@@ -29,16 +49,30 @@ typedef struct {
  * void string_debug_print(const String *str)
  * int string_contains(const String *str, const String *substr)
  * int string_contains_at(const String *str, const String *substr, size_t *idx)
+ * int string_find_all(const String *str, const String *substr, DynArray *offsets)
+ * size_t string_count(const String *str, const String *substr)
+ * String *string_replace_all(const String *str, const String *substr, const String *replacement)
  * String *string_concat(const String *first, const String *second)
  * int string_append(String *str, const String *to_append)
  * int string_list_equal(const StringList *list1, const StringList *list2)
  * void string_list_print(const StringList *list)
  * void string_list_debug_print(const StringList *list)
  * StringList *string_split(const String *str, const String *delim)
+ * StringList *string_split_parallel(const String *str, const String *delim, size_t num_threads)
  * String *string_join(const String *delim, const StringList *list)
  * String *string_ltrim(const String *str, const StringList *to_trim)
  * String *string_rtrim(const String *str, const StringList *to_trim)
  * String *string_trim(const String *str, const StringList *to_trim)
+ * StringMatcher *create_string_matcher(const StringList *patterns)
+ * void free_string_matcher(StringMatcher *matcher)
+ * int string_matcher_find(const StringMatcher *matcher, const String *str, StringMatch *match)
+ * int string_matcher_find_all(const StringMatcher *matcher, const String *str, DynArray *matches)
+ * size_t string_matcher_count(const StringMatcher *matcher, const String *str)
+ * StringTrimmer *create_string_trimmer(const StringList *to_trim)
+ * void free_string_trimmer(StringTrimmer *trimmer)
+ * int string_trim_view(const String *str, const StringTrimmer *trimmer, int sides, String *view)
+ * String *string_trim_with(const String *str, const StringTrimmer *trimmer)
+ * String *string_trim_whitespace(const String *str)
  */
 
 /******************************************/
@@ -95,6 +129,50 @@ String *string_reverse(const String *str);
 void free_string(String *str);
 
 
+/*
+ * Map the file at path into memory read-only and return a string whose
+ * characters are the file's contents, without reading or copying the file.
+ * Pages are loaded on demand as the string is used, so functions that only
+ * look at the string (string_split, string_contains, string_find_all, etc.)
+ * can run on files far larger than memory. Splitting a mapped string gives
+ * a list of views into the mapping.
+ *
+ * flags is 0 or any of these or'd together (they are hints, so failure to
+ * apply them is not an error):
+ *   STRING_MAP_SEQUENTIAL: the string will be read front to back
+ *   STRING_MAP_WILLNEED: the whole string will be needed soon
+ *   STRING_MAP_HUGEPAGE: use huge pages for the mapping where supported
+ *
+ * The characters are read-only and must not be modified. The string must be
+ * released with string_unmap_file, never free_string or string_append. An
+ * empty file gives the empty string (with NULL chars, nothing is mapped).
+ * Changes to the file while it is mapped may show up in the string, and
+ * truncating it may crash the program.
+ *
+ * Errors (errno values):
+ *   EFAULT: the path argument was NULL
+ *   EINVAL: path is not a regular file
+ *   ENOMEM: failed to allocate space (no memory)
+ *   Any errno set by open, fstat, or mmap (e.g. ENOENT, EACCES)
+ *
+ * Returns: a pointer to the string on success, NULL on failure.
+ */
+String *string_map_file(const char *path, int flags);
+
+
+/*
+ * Unmap and free a string from string_map_file. Any views into it (e.g. from
+ * string_split) must not be used afterward. Calling on a NULL pointer does
+ * nothing.
+ *
+ * Errors (errno values):
+ *   Any errno set by munmap (EINVAL if str was not from string_map_file)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int string_unmap_file(String *str);
+
+
 /*
  * Create a new string which has chars copied from the given string within the
  * range of the given start and end indices. The start index is inclusive
@@ -239,6 +317,53 @@ int string_contains(const String *str, const String *substr);
 int string_contains_at(const String *str, const String *substr, size_t *idx);
 
 
+/*
+ * Append the index of every occurrence of substr in str to the offsets array,
+ * which must have been created with an item size of sizeof(size_t). Only
+ * non-overlapping occurrences are found, scanning left to right (like
+ * string_split), e.g. "aa" is found at 0 and 2 in "aaaaa". The search is a
+ * single pass over str that never backs up.
+ *
+ * Errors (errno values):
+ *   EFAULT: str, substr, offsets, or a combination were NULL
+ *   EINVAL: substr is the empty string
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int string_find_all(const String *str, const String *substr, DynArray *offsets);
+
+
+/*
+ * Count the non-overlapping occurrences of substr in str (the number of
+ * offsets string_find_all would append).
+ *
+ * Errors (errno values):
+ *   EFAULT: str, substr, or both were NULL
+ *   EINVAL: substr is the empty string
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: the number of occurrences, or 0 on failure.
+ */
+size_t string_count(const String *str, const String *substr);
+
+
+/*
+ * Create a new string where every non-overlapping occurrence of substr in str
+ * (the ones string_find_all finds) is replaced by replacement. The length of
+ * the new string is known after one search pass, so its characters are written
+ * into a single allocation.
+ *
+ * Errors (errno values):
+ *   EFAULT: str, substr, replacement, or a combination were NULL
+ *   EINVAL: substr is the empty string
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the new string on success, NULL on failure.
+ */
+String *string_replace_all(const String *str, const String *substr, const String *replacement);
+
+
 /*
  * Create a new string which has the characters of the first string followed by
  * the characters of the second string.
@@ -327,6 +452,26 @@ void string_list_debug_print(const StringList *list);
 StringList *string_split(const String *str, const String *delim);
 
 
+/*
+ * Same as string_split (and gives an identical list), but splits str into up
+ * to num_threads chunks that are searched for the delimeter at the same time.
+ * A delimeter that starts in one chunk may end in the next, and for
+ * delimeters that can overlap themselves (like "aa") the next chunk is fixed
+ * up so that the same instances are chosen as in a serial left to right scan.
+ *
+ * If num_threads is 0, the number of online processors is used. Inputs too
+ * small to be worth the threads (under 64 KiB per chunk) are split serially.
+ *
+ * Errors (errno values):
+ *   EFAULT: str, delim, or both were NULL
+ *   EINVAL: the delimeter is longer than the string to split
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the string list on success, NULL on failure.
+ */
+StringList *string_split_parallel(const String *str, const String *delim, size_t num_threads);
+
+
 /*
  * Join the strings in a string list by creating a new string which is a
  * concatentation of the chars of each string in the order they appear in the
@@ -346,7 +491,10 @@ String *string_join(const String *delim, const StringList *list);
 
 /*
  * Creates a new string where all consecutive instances of each string within
- * to_trim are removed from the left side of the given string (str).
+ * to_trim are removed from the left side of the given string (str). The
+ * longest prefix made up of strings from to_trim (in any order, repeats
+ * allowed) is removed, so "abc" trimmed of "a", "ab", and "bc" is "". Empty
+ * strings in to_trim are ignored.
  *
  * Errors (errno values):
  *   EFAULT: str, to_trim, or both were NULL
@@ -359,7 +507,9 @@ String *string_ltrim(const String *str, const StringList *to_trim);
 
 /*
  * Creates a new string where all consecutive instances of each string within
- * to_trim are removed from the right side of the given string (str).
+ * to_trim are removed from the right side of the given string (str). The
+ * longest suffix made up of strings from to_trim is removed (see
+ * string_ltrim). Empty strings in to_trim are ignored.
  *
  * Errors (errno values):
  *   EFAULT: str, to_trim, or both were NULL
@@ -373,6 +523,9 @@ String *string_rtrim(const String *str, const StringList *to_trim);
 /*
  * Creates a new string where all consecutive instances of each string within
  * to_trim are removed from the left and right sides of the given string (str).
+ * Each side is trimmed as by string_ltrim and string_rtrim, and if the two
+ * trimmed parts overlap the result is empty. Empty strings in to_trim are
+ * ignored.
  *
  * Errors (errno values):
  *   EFAULT: str, to_trim, or both were NULL
@@ -382,4 +535,143 @@ String *string_rtrim(const String *str, const StringList *to_trim);
  */
 String *string_trim(const String *str, const StringList *to_trim);
 
+
+/*
+ * Compiles a list of patterns into a matcher which finds every pattern in a
+ * string in a single pass (an Aho-Corasick automaton). Bytes that occur in no
+ * pattern share one input class, so the automaton is stored as a dense
+ * transition table of states by classes and each input byte costs one table
+ * lookup no matter how many patterns there are. While the matcher is in its
+ * start state it skips ahead to the next byte which begins some pattern.
+ *
+ * Empty patterns never match. If a pattern appears more than once in the list,
+ * its matches report the index of its first appearance.
+ *
+ * The patterns are not referenced after this function returns.
+ *
+ * Errors (errno values):
+ *   EFAULT: the patterns argument was NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the matcher on success, NULL on failure.
+ */
+StringMatcher *create_string_matcher(const StringList *patterns);
+
+
+/*
+ * Frees the memory allocated for a matcher. Calling on a NULL pointer does
+ * nothing.
+ */
+void free_string_matcher(StringMatcher *matcher);
+
+
+/*
+ * Find the leftmost match of any of the matcher's patterns in str and write it
+ * to match (if match isn't NULL). If several patterns match at the leftmost
+ * index, the longest one is reported.
+ *
+ * Errors (errno values):
+ *   EFAULT: matcher, str, or both were NULL
+ *
+ * Returns: 1 if any pattern occurs in str, 0 if none do.
+ */
+int string_matcher_find(const StringMatcher *matcher, const String *str, StringMatch *match);
+
+
+/*
+ * Append a StringMatch for every occurrence of every pattern in str to the
+ * matches array, which must have been created with an item size of
+ * sizeof(StringMatch). Occurrences may overlap. Matches are appended in order
+ * of where they end in str, and matches ending at the same index are appended
+ * longest first.
+ *
+ * Errors (errno values):
+ *   EFAULT: matcher, str, matches, or a combination were NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int string_matcher_find_all(const StringMatcher *matcher, const String *str, DynArray *matches);
+
+
+/*
+ * Count the occurrences of all of the matcher's patterns in str (the number of
+ * matches string_matcher_find_all would append).
+ *
+ * Errors (errno values):
+ *   EFAULT: matcher, str, or both were NULL
+ *
+ * Returns: the number of occurrences.
+ */
+size_t string_matcher_count(const StringMatcher *matcher, const String *str);
+
+
+/*
+ * Compiles a to_trim list (see string_trim) once so it can be used to trim
+ * many strings. If every string in to_trim is a single byte, the trimmer is a
+ * 256 entry table of bytes to trim and trimming costs one lookup per trimmed
+ * byte. Otherwise it holds a prefix automaton for each end of the string, and
+ * trimming walks it from each offset a run of strings reaches, which costs at
+ * most the longest string's length per byte without rescanning to_trim.
+ *
+ * string_ltrim, string_rtrim, and string_trim compile their to_trim list the
+ * same way on every call (on the stack in the single byte case).
+ *
+ * Errors (errno values):
+ *   EFAULT: the to_trim argument was NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the trimmer on success, NULL on failure.
+ */
+StringTrimmer *create_string_trimmer(const StringList *to_trim);
+
+
+/*
+ * Frees the memory allocated for a trimmer. Calling on a NULL pointer does
+ * nothing.
+ */
+void free_string_trimmer(StringTrimmer *trimmer);
+
+
+/*
+ * Trim the given sides (STRING_TRIM_LEFT, STRING_TRIM_RIGHT, or
+ * STRING_TRIM_BOTH) of str without copying. view is set to point into str's
+ * chars buffer, so like the strings in a list from string_split, it must not
+ * be used after str is freed and must not be freed itself.
+ *
+ * Errors (errno values):
+ *   EFAULT: str, trimmer, view, or a combination were NULL
+ *   ENOMEM: failed to allocate space (no memory), only when a string in the
+ *           trimmer's to_trim is longer than 63 bytes
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int string_trim_view(const String *str, const StringTrimmer *trimmer, int sides, String *view);
+
+
+/*
+ * Same as string_trim, but with a precompiled to_trim list.
+ *
+ * Errors (errno values):
+ *   EFAULT: str, trimmer, or both were NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the new string on success, NULL on failure.
+ */
+String *string_trim_with(const String *str, const StringTrimmer *trimmer);
+
+
+/*
+ * Creates a new string with leading and trailing whitespace (space, \t, \n,
+ * \v, \f, and \r) removed. Equivalent to string_trim with a list of those
+ * characters, but needs no list.
+ *
+ * Errors (errno values):
+ *   EFAULT: the str argument was NULL
+ *   ENOMEM: failed to allocate space (no memory)
+ *
+ * Returns: a pointer to the new string on success, NULL on failure.
+ */
+String *string_trim_whitespace(const String *str);
+
 #endif
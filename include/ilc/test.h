@@ -1,6 +1,7 @@
 #ifndef TEST_H
 #define TEST_H
 
+#include <stdio.h>
 #include <stddef.h>
 
 #define SUCCESS 0  /* while opposite of C's true/false, it fits process exit codes which run_test_suite uses */
@@ -13,12 +14,27 @@
 #define END_COLOR "\033[0m"
 #define COLOR_TEXT(color, text) color text END_COLOR
 
+#define REPORT_DIR_ENV "ILC_REPORT_DIR"  /* when set, suites also write machine readable reports there */
+
 typedef struct _test_suite TestSuite;
 
 TestSuite *create_test_suite(const char *name);
 void free_test_suite(TestSuite *suite);
 void suite_add_test(TestSuite *suite, const char *test_name, int (*run)());
+void suite_set_jobs(TestSuite *suite, unsigned int jobs);  /* tests run at once, 0 (default) for one per core */
+void suite_set_timeout(TestSuite *suite, double seconds);  /* kill tests running longer, 0 (default) for no limit */
 void run_test_suite(TestSuite *suite, int verbose);
+
+/*
+ * Results of the last run_test_suite, with each test's wall time, cpu time,
+ * and max rss. run_test_suite writes both to $ILC_REPORT_DIR/<suite name>.tap
+ * and .xml on its own when that variable is set.
+ */
+void suite_write_tap(const TestSuite *suite, FILE *out);
+void suite_write_junit(const TestSuite *suite, FILE *out);
+
+/* $ILC_REPORT_DIR/<suite name>.<extension> opened for writing, or NULL if it's unset or can't be opened */
+FILE *open_report_file(const char *suite_name, const char *extension);
 int check_mem_equal(const void *actual, const void *expected, size_t size);
 
 #endif
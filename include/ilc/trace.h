@@ -0,0 +1,73 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+
+#define TRACE_RING_SIZE 16384  /* events kept per thread, the oldest are overwritten first */
+#define TRACE_FILE_ENV "ILC_TRACE_FILE"  /* when set, the trace is written there at exit */
+
+/*
+ * Tracing. Building with "make TRACE=1" defines ILC_TRACE, and the library's
+ * hot paths (searches, splits, joins, and growing an array or string) mark
+ * where they start and end:
+ *
+ *   TRACE_BEGIN("string_split");
+ *   ...
+ *   TRACE_END();  (before every return after the begin)
+ *
+ * Each thread records into its own ring buffer, so tracing takes no locks
+ * and only costs a clock read and a store per mark. Without ILC_TRACE the
+ * macros are empty and compile to nothing.
+ *
+ * The trace is written as Chrome trace event JSON, which chrome://tracing,
+ * Perfetto, and speedscope open. Set ILC_TRACE_FILE to write it when the
+ * program exits, or call trace_write_chrome_json.
+ */
+
+#ifdef ILC_TRACE
+#define TRACE_BEGIN(name) trace_begin(name)
+#define TRACE_END() trace_end()
+#else
+#define TRACE_BEGIN(name) ((void) 0)
+#define TRACE_END() ((void) 0)
+#endif
+
+/****************************/
+/* FUNCTION QUICK REFERENCE */
+/****************************/
+
+/*
+ * void trace_begin(const char *name)
+ * void trace_end(void)
+ * int trace_write_chrome_json(FILE *out)
+ */
+
+/******************************************/
+/* FUNCTION DECLARATIONS AND DESCRIPTIONS */
+/******************************************/
+
+/*
+ * What TRACE_BEGIN and TRACE_END call, to be used directly outside the
+ * library or in code that should always be traced. name must be a string
+ * literal (or otherwise outlive the trace) since only the pointer is kept.
+ * Ends pair with the latest unended begin on the same thread.
+ */
+void trace_begin(const char *name);
+void trace_end(void);
+
+
+/*
+ * Write every thread's recorded events as Chrome trace event JSON. Threads
+ * may keep tracing while this runs, events they overwrite in the meantime
+ * are left out. A thread that has exited keeps its events until a new
+ * thread reuses its ring buffer.
+ *
+ * Errors (errno values):
+ *   EFAULT: the out argument was NULL
+ *   EIO: writing to out failed
+ *
+ * Returns: 0 on success, errno of error on failure (errno is set too).
+ */
+int trace_write_chrome_json(FILE *out);
+
+#endif
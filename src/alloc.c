@@ -0,0 +1,195 @@
+#include <stdlib.h>
+#include <string.h>
+#ifdef __GLIBC__
+#include <malloc.h>  /* malloc_usable_size */
+#endif
+#include <ilc/alloc.h>
+
+/* this file is the tracking, so its own calls have to reach the real ones */
+#undef malloc
+#undef calloc
+#undef realloc
+#undef free
+
+#define MAX_SITES 1024  /* must be a power of 2, sites past this are counted as one "other" site */
+
+typedef struct {
+    const char *file;
+    int line;
+    int ready;  /* file and line are set, written last */
+    size_t calls;
+    size_t bytes;
+} Site;
+
+/* all updated with relaxed atomics, they're counters and nothing else is ordered by them */
+static size_t num_allocations;
+static size_t num_reallocations;
+static size_t num_frees;
+static size_t bytes_requested;
+static size_t live_bytes;
+static size_t peak_live_bytes;
+
+static Site sites[MAX_SITES];
+static Site other_site = {"other", 0, 1, 0, 0};
+static int sites_lock;  /* only taken to add a site */
+
+
+static size_t usable_size(void *ptr) {
+#ifdef __GLIBC__
+    return ptr != NULL ? malloc_usable_size(ptr) : 0;
+#else
+    (void) ptr;
+    return 0;
+#endif
+}
+
+static void add_live(size_t bytes) {
+    size_t live = __atomic_add_fetch(&live_bytes, bytes, __ATOMIC_RELAXED);
+    size_t peak = __atomic_load_n(&peak_live_bytes, __ATOMIC_RELAXED);
+    while (live > peak && !__atomic_compare_exchange_n(&peak_live_bytes, &peak, live, 1,
+                                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static void remove_live(size_t bytes) {
+    __atomic_sub_fetch(&live_bytes, bytes, __ATOMIC_RELAXED);
+}
+
+static Site *find_site(const char *file, int line) {
+    size_t hash = ((size_t) file >> 4) * 31 + (size_t) line;
+    size_t i, probes;
+    for (i = hash & (MAX_SITES - 1), probes = 0; probes < MAX_SITES; i = (i + 1) & (MAX_SITES - 1), probes++) {
+        Site *site = &sites[i];
+        if (!__atomic_load_n(&site->ready, __ATOMIC_ACQUIRE)) {
+            while (__atomic_test_and_set(&sites_lock, __ATOMIC_ACQUIRE)) {
+            }
+
+            if (!site->ready) {  /* nobody took it while we waited */
+                site->file = file;
+                site->line = line;
+                __atomic_store_n(&site->ready, 1, __ATOMIC_RELEASE);
+            }
+
+            __atomic_clear(&sites_lock, __ATOMIC_RELEASE);
+        }
+
+        if (site->line == line && (site->file == file || strcmp(site->file, file) == 0)) {
+            return site;
+        }
+    }
+
+    return &other_site;
+}
+
+static void record(size_t size, const char *file, int line) {
+    __atomic_add_fetch(&bytes_requested, size, __ATOMIC_RELAXED);
+
+    Site *site = find_site(file, line);
+    __atomic_add_fetch(&site->calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&site->bytes, size, __ATOMIC_RELAXED);
+}
+
+void *alloc_tracked_malloc(size_t size, const char *file, int line) {
+    void *ptr = malloc(size);
+    if (ptr != NULL) {
+        __atomic_add_fetch(&num_allocations, 1, __ATOMIC_RELAXED);
+        record(size, file, line);
+        add_live(usable_size(ptr));
+    }
+
+    return ptr;
+}
+
+void *alloc_tracked_calloc(size_t count, size_t size, const char *file, int line) {
+    void *ptr = calloc(count, size);
+    if (ptr != NULL) {
+        __atomic_add_fetch(&num_allocations, 1, __ATOMIC_RELAXED);
+        record(count * size, file, line);
+        add_live(usable_size(ptr));
+    }
+
+    return ptr;
+}
+
+void *alloc_tracked_realloc(void *ptr, size_t size, const char *file, int line) {
+    if (ptr == NULL) {
+        return alloc_tracked_malloc(size, file, line);
+    }
+
+    size_t old_size = usable_size(ptr);
+    void *new_ptr = realloc(ptr, size);
+    if (new_ptr == NULL && size > 0) {
+        return NULL;  /* ptr is untouched */
+    }
+
+    __atomic_add_fetch(&num_reallocations, 1, __ATOMIC_RELAXED);
+    record(size, file, line);
+    remove_live(old_size);
+    add_live(usable_size(new_ptr));
+
+    return new_ptr;
+}
+
+void alloc_tracked_free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+
+    __atomic_add_fetch(&num_frees, 1, __ATOMIC_RELAXED);
+    remove_live(usable_size(ptr));
+    free(ptr);
+}
+
+AllocStats alloc_stats(void) {
+    AllocStats stats;
+    stats.allocations = __atomic_load_n(&num_allocations, __ATOMIC_RELAXED);
+    stats.reallocations = __atomic_load_n(&num_reallocations, __ATOMIC_RELAXED);
+    stats.frees = __atomic_load_n(&num_frees, __ATOMIC_RELAXED);
+    stats.bytes_requested = __atomic_load_n(&bytes_requested, __ATOMIC_RELAXED);
+    stats.live_bytes = __atomic_load_n(&live_bytes, __ATOMIC_RELAXED);
+    stats.peak_live_bytes = __atomic_load_n(&peak_live_bytes, __ATOMIC_RELAXED);
+
+    return stats;
+}
+
+AllocStats alloc_stats_diff(AllocStats before, AllocStats after) {
+    AllocStats diff;
+    diff.allocations = after.allocations - before.allocations;
+    diff.reallocations = after.reallocations - before.reallocations;
+    diff.frees = after.frees - before.frees;
+    diff.bytes_requested = after.bytes_requested - before.bytes_requested;
+    diff.live_bytes = after.live_bytes > before.live_bytes ? after.live_bytes - before.live_bytes : 0;
+    diff.peak_live_bytes = after.peak_live_bytes > before.live_bytes ? after.peak_live_bytes - before.live_bytes : 0;
+
+    return diff;
+}
+
+void alloc_reset_peak(void) {
+    __atomic_store_n(&peak_live_bytes, __atomic_load_n(&live_bytes, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+}
+
+static int compare_sites(const void *a, const void *b) {
+    size_t x = (*(Site * const *) a)->calls, y = (*(Site * const *) b)->calls;
+    return (x < y) - (x > y);  /* most calls first */
+}
+
+void alloc_print_sites(FILE *out, unsigned int max_sites) {
+    Site *used[MAX_SITES + 1];
+    unsigned int num_used = 0, i;
+    for (i = 0; i < MAX_SITES; i++) {
+        if (__atomic_load_n(&sites[i].ready, __ATOMIC_ACQUIRE)) {
+            used[num_used++] = &sites[i];
+        }
+    }
+    if (other_site.calls > 0) {
+        used[num_used++] = &other_site;
+    }
+
+    qsort(used, num_used, sizeof(Site *), compare_sites);
+
+    fprintf(out, "%12s %14s  %s\n", "calls", "bytes", "site");
+    for (i = 0; i < num_used && (max_sites == 0 || i < max_sites); i++) {
+        fprintf(out, "%12lu %14lu  %s:%d\n", __atomic_load_n(&used[i]->calls, __ATOMIC_RELAXED),
+                __atomic_load_n(&used[i]->bytes, __ATOMIC_RELAXED), used[i]->file, used[i]->line);
+    }
+}
@@ -0,0 +1,653 @@
+#define _GNU_SOURCE  /* sched_setaffinity, CPU_SET, gethostname, syscall */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/utsname.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include <ilc/bench.h>
+#include <ilc/test.h>  /* colors, open_report_file */
+#include <ilc/alloc.h>
+
+#ifndef BUILD_CFLAGS
+#define BUILD_CFLAGS "unknown"  /* the makefile passes the flags the library was built with */
+#endif
+
+typedef enum {
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_CACHE_MISSES,
+    COUNTER_BRANCHES,
+    COUNTER_BRANCH_MISSES,
+    NUM_COUNTERS
+} Counter;
+
+static const char *counter_names[NUM_COUNTERS] = {
+    "cycles", "instructions", "cache_misses", "branches", "branch_misses"
+};
+
+typedef struct {
+    const char *name;
+    void (*run)(Bench *);
+
+    /* filled in by run_bench_suite, for bench_suite_write_json */
+    double *samples;  /* ns per iteration of each repetition, in the order they ran */
+    unsigned int num_samples;
+    size_t iterations;
+    size_t bytes;
+    size_t items;
+    double counts[NUM_COUNTERS];  /* per iteration, averaged over the repetitions */
+    double allocations;  /* per iteration, in a TRACK_ALLOCS build */
+    double bytes_allocated;
+} BenchCase;
+
+/*
+ * Hardware counters, one perf event group counting the calling thread in
+ * user space. Counters the cpu or kernel doesn't have are left out, their
+ * slot is -1.
+ */
+typedef struct {
+    int fds[NUM_COUNTERS];  /* fds[COUNTER_CYCLES] leads the group, -1 when not counting at all */
+    int slots[NUM_COUNTERS];  /* where each counter is in the group's read */
+    unsigned int num_open;
+    uint64_t time_enabled;  /* as of the last read, the kernel doesn't reset these */
+    uint64_t time_running;
+} Counters;
+
+struct _bench_suite {
+    const char *name;
+    BenchCase *benches;
+    unsigned int num_benches;
+    unsigned int repetitions;
+    double min_time;
+    Counters counters;
+};
+
+struct _bench {
+    size_t iterations;
+    size_t bytes;  /* per iteration, 0 if not set */
+    size_t items;
+    double elapsed;  /* seconds timed so far */
+    double started;  /* when the timer was last resumed, < 0 when paused */
+    Counters *counters;  /* NULL when not counting */
+    size_t allocations;  /* while the timer ran, in a TRACK_ALLOCS build */
+    size_t bytes_allocated;
+    AllocStats resumed_allocs;
+};
+
+typedef struct {
+    size_t iterations;
+    double median;  /* all in ns per iteration */
+    double p99;
+    double mean;
+    double stddev;
+    double min;
+} BenchStats;
+
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+BenchSuite *create_bench_suite(const char *name) {
+    if (name == NULL) {
+        return NULL;
+    }
+
+    BenchSuite *suite = malloc(sizeof(BenchSuite));
+    suite->name = name;
+    suite->benches = NULL;
+    suite->num_benches = 0;
+    suite->repetitions = BENCH_DEFAULT_REPETITIONS;
+    suite->min_time = BENCH_DEFAULT_MIN_TIME;
+    suite->counters.num_open = 0;
+    suite->counters.time_enabled = 0;
+    suite->counters.time_running = 0;
+
+    int i;
+    for (i = 0; i < NUM_COUNTERS; i++) {
+        suite->counters.fds[i] = -1;
+        suite->counters.slots[i] = -1;
+    }
+
+    return suite;
+}
+
+void free_bench_suite(BenchSuite *suite) {
+    if (suite == NULL) {
+        return;
+    }
+
+    unsigned int i;
+    for (i = 0; i < suite->num_benches; i++) {
+        free(suite->benches[i].samples);
+    }
+
+    for (i = 0; i < NUM_COUNTERS; i++) {
+        if (suite->counters.fds[i] >= 0) {
+            close(suite->counters.fds[i]);
+        }
+    }
+
+    free(suite->benches);
+    free(suite);
+}
+
+void suite_add_bench(BenchSuite *suite, const char *bench_name, void (*run)(Bench *)) {
+    suite->num_benches++;
+    suite->benches = realloc(suite->benches, suite->num_benches * sizeof(BenchCase));
+
+    if (suite->benches == NULL) {
+        fprintf(stderr, "suite_add_bench: failed to add benchmark %s (realloc failed)\n", bench_name);
+        exit(EXIT_FAILURE);
+    }
+
+    BenchCase *bench = &suite->benches[suite->num_benches - 1];
+    bench->name = bench_name;
+    bench->run = run;
+    bench->samples = NULL;
+    bench->num_samples = 0;
+    bench->iterations = 0;
+    bench->bytes = 0;
+    bench->items = 0;
+    memset(bench->counts, 0, sizeof(bench->counts));
+}
+
+void bench_suite_set_repetitions(BenchSuite *suite, unsigned int repetitions) {
+    suite->repetitions = repetitions > 0 ? repetitions : 1;
+}
+
+void bench_suite_set_min_time(BenchSuite *suite, double seconds) {
+    suite->min_time = seconds;
+}
+
+#ifdef __linux__
+static int open_counter(uint64_t config, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = group_fd < 0;  /* the group starts and stops with its leader */
+    attr.exclude_kernel = 1;  /* also what lets unprivileged users count at perf_event_paranoid 2 */
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static void set_counting(const Counters *counters, unsigned long request) {
+    ioctl(counters->fds[COUNTER_CYCLES], request, PERF_IOC_FLAG_GROUP);
+}
+#endif
+
+int bench_suite_enable_counters(BenchSuite *suite) {
+#ifdef __linux__
+    static const uint64_t configs[NUM_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    Counters *counters = &suite->counters;
+    if (counters->fds[COUNTER_CYCLES] >= 0) {
+        return 0;
+    }
+
+    counters->fds[COUNTER_CYCLES] = open_counter(configs[COUNTER_CYCLES], -1);
+    if (counters->fds[COUNTER_CYCLES] < 0) {
+        return errno;
+    }
+    counters->slots[COUNTER_CYCLES] = 0;
+    counters->num_open = 1;
+
+    int i;
+    for (i = COUNTER_CYCLES + 1; i < NUM_COUNTERS; i++) {
+        counters->fds[i] = open_counter(configs[i], counters->fds[COUNTER_CYCLES]);
+        if (counters->fds[i] >= 0) {
+            counters->slots[i] = counters->num_open++;
+        }
+    }
+
+    return 0;
+#else
+    (void) suite;
+    return ENOSYS;
+#endif
+}
+
+/* add the counts since the last reset to counts, scaled up if the kernel had to share the counters */
+static void read_counters(Counters *counters, double *counts) {
+#ifdef __linux__
+    uint64_t values[3 + NUM_COUNTERS];  /* number of counters, time enabled, time running, then each count */
+    if (read(counters->fds[COUNTER_CYCLES], values, sizeof(values)) < (ssize_t) (3 * sizeof(uint64_t))) {
+        return;
+    }
+
+    uint64_t enabled = values[1] - counters->time_enabled, running = values[2] - counters->time_running;
+    counters->time_enabled = values[1];
+    counters->time_running = values[2];
+
+    double scale = running > 0 && running < enabled ? (double) enabled / running : 1;
+    int i;
+    for (i = 0; i < NUM_COUNTERS; i++) {
+        if (counters->slots[i] >= 0 && (uint64_t) counters->slots[i] < values[0]) {
+            counts[i] += values[3 + counters->slots[i]] * scale;
+        }
+    }
+#else
+    (void) counters;
+    (void) counts;
+#endif
+}
+
+size_t bench_iterations(const Bench *b) {
+    return b->iterations;
+}
+
+void bench_pause_timer(Bench *b) {
+    if (b->started >= 0) {
+        b->elapsed += now_seconds() - b->started;
+        b->started = -1;
+#ifdef ILC_TRACK_ALLOCS
+        AllocStats used = alloc_stats_diff(b->resumed_allocs, alloc_stats());
+        b->allocations += used.allocations + used.reallocations;
+        b->bytes_allocated += used.bytes_requested;
+#endif
+#ifdef __linux__
+        if (b->counters != NULL) {
+            set_counting(b->counters, PERF_EVENT_IOC_DISABLE);
+        }
+#endif
+    }
+}
+
+void bench_resume_timer(Bench *b) {
+    if (b->started < 0) {
+#ifdef __linux__
+        if (b->counters != NULL) {
+            set_counting(b->counters, PERF_EVENT_IOC_ENABLE);
+        }
+#endif
+#ifdef ILC_TRACK_ALLOCS
+        b->resumed_allocs = alloc_stats();
+#endif
+        b->started = now_seconds();
+    }
+}
+
+void bench_set_bytes(Bench *b, size_t bytes_per_iteration) {
+    b->bytes = bytes_per_iteration;
+}
+
+void bench_set_items(Bench *b, size_t items_per_iteration) {
+    b->items = items_per_iteration;
+}
+
+int bench_pin_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        return errno;
+    }
+
+    return 0;
+}
+
+/* one call of the benchmark, returns the seconds it timed */
+static double run_once(const BenchCase *bench, Bench *b, size_t iterations) {
+    b->iterations = iterations;
+    b->elapsed = 0;
+    b->started = -1;
+#ifdef __linux__
+    if (b->counters != NULL) {
+        set_counting(b->counters, PERF_EVENT_IOC_RESET);
+    }
+#endif
+    bench_resume_timer(b);
+
+    bench->run(b);
+    bench_pause_timer(b);
+
+    return b->elapsed;
+}
+
+/* grow the iteration count until one call takes min_time */
+static size_t calibrate(const BenchCase *bench, Bench *b, double min_time) {
+    size_t iterations = 1;
+    for (;;) {
+        double elapsed = run_once(bench, b, iterations);
+        if (elapsed >= min_time || iterations >= ((size_t) 1 << 40)) {
+            return iterations;
+        }
+
+        /* aim a bit past min_time, but grow at least 2x and at most 10x per step */
+        double scale = elapsed > 0 ? min_time * 1.2 / elapsed : 10;
+        scale = scale < 2 ? 2 : scale > 10 ? 10 : scale;
+        iterations = (size_t) (iterations * scale);
+    }
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static BenchStats summarize(double *samples, unsigned int n, size_t iterations) {
+    BenchStats stats;
+    stats.iterations = iterations;
+
+    qsort(samples, n, sizeof(double), compare_doubles);
+    stats.min = samples[0];
+    stats.median = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    stats.p99 = samples[(size_t) ceil(0.99 * n) - 1];
+
+    double sum = 0;
+    unsigned int i;
+    for (i = 0; i < n; i++) {
+        sum += samples[i];
+    }
+    stats.mean = sum / n;
+
+    double squares = 0;
+    for (i = 0; i < n; i++) {
+        squares += (samples[i] - stats.mean) * (samples[i] - stats.mean);
+    }
+    stats.stddev = n > 1 ? sqrt(squares / (n - 1)) : 0;
+
+    return stats;
+}
+
+/* human readable time per iteration */
+static void print_time(const char *label, double ns) {
+    if (ns >= 1e6) {
+        printf("%s %8.2f ms", label, ns / 1e6);
+    } else if (ns >= 1e3) {
+        printf("%s %8.2f us", label, ns / 1e3);
+    } else {
+        printf("%s %8.2f ns", label, ns);
+    }
+}
+
+static void print_rate(double per_second, const char *unit) {
+    if (per_second >= 1e9) {
+        printf("  %7.2f G%s/s", per_second / 1e9, unit);
+    } else if (per_second >= 1e6) {
+        printf("  %7.2f M%s/s", per_second / 1e6, unit);
+    } else {
+        printf("  %7.2f K%s/s", per_second / 1e3, unit);
+    }
+}
+
+/* what the counters say about one iteration, "-" for counters that couldn't be opened */
+static void print_counters(const Counters *counters, const double *counts) {
+    printf("%-40s", "");
+
+    if (counters->slots[COUNTER_INSTRUCTIONS] >= 0 && counts[COUNTER_CYCLES] > 0) {
+        printf("   IPC %5.2f", counts[COUNTER_INSTRUCTIONS] / counts[COUNTER_CYCLES]);
+    } else {
+        printf("   IPC     -");
+    }
+    printf("  cycles/op %10.1f", counts[COUNTER_CYCLES]);
+
+    if (counters->slots[COUNTER_CACHE_MISSES] >= 0) {
+        printf("  cache misses/op %8.2f", counts[COUNTER_CACHE_MISSES]);
+    } else {
+        printf("  cache misses/op        -");
+    }
+
+    if (counters->slots[COUNTER_BRANCH_MISSES] >= 0 && counters->slots[COUNTER_BRANCHES] >= 0
+        && counts[COUNTER_BRANCHES] > 0) {
+        printf("  branch misses %5.2f%%\n", counts[COUNTER_BRANCH_MISSES] / counts[COUNTER_BRANCHES] * 100);
+    } else {
+        printf("  branch misses     -\n");
+    }
+}
+
+void run_bench_suite(BenchSuite *suite, int verbose) {
+    printf("=== " COLOR_TEXT(BLUE_HL, "%s") " ===\n", suite->name);
+
+    double *samples = malloc(suite->repetitions * sizeof(double));
+    if (samples == NULL) {
+        fprintf(stderr, "run_bench_suite: failed to allocate samples\n");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned int i;
+    for (i = 0; i < suite->num_benches; i++) {
+        BenchCase *bench = &suite->benches[i];
+        Bench b;
+        memset(&b, 0, sizeof(b));
+        b.started = -1;
+
+        printf(COLOR_TEXT(BLUE, "%-40s"), bench->name);
+        fflush(stdout);
+
+        size_t iterations = calibrate(bench, &b, suite->min_time);
+        run_once(bench, &b, iterations);  /* warmup */
+
+        /* only the repetitions are counted, so calibrating doesn't pay for the ioctls */
+        b.counters = suite->counters.fds[COUNTER_CYCLES] >= 0 ? &suite->counters : NULL;
+        memset(bench->counts, 0, sizeof(bench->counts));
+        b.allocations = 0;
+        b.bytes_allocated = 0;
+
+        unsigned int rep;
+        for (rep = 0; rep < suite->repetitions; rep++) {
+            samples[rep] = run_once(bench, &b, iterations) * 1e9 / iterations;
+            if (b.counters != NULL) {
+                read_counters(b.counters, bench->counts);
+            }
+            if (verbose) {
+                print_time("\n    repetition", samples[rep]);
+            }
+        }
+        if (verbose) {
+            printf("\n%-40s", "");
+        }
+
+        bench->samples = realloc(bench->samples, suite->repetitions * sizeof(double));
+        if (bench->samples == NULL) {
+            fprintf(stderr, "run_bench_suite: failed to keep samples of %s\n", bench->name);
+            exit(EXIT_FAILURE);
+        }
+        memcpy(bench->samples, samples, suite->repetitions * sizeof(double));  /* summarize sorts samples */
+        bench->num_samples = suite->repetitions;
+        bench->iterations = iterations;
+        bench->bytes = b.bytes;
+        bench->items = b.items;
+        bench->allocations = b.allocations / ((double) iterations * suite->repetitions);
+        bench->bytes_allocated = b.bytes_allocated / ((double) iterations * suite->repetitions);
+
+        BenchStats stats = summarize(samples, suite->repetitions, iterations);
+        print_time("", stats.median);
+        print_time("  p99", stats.p99);
+        printf("  stddev %5.1f%%", stats.mean > 0 ? stats.stddev / stats.mean * 100 : 0);
+        if (b.bytes > 0) {
+            print_rate(b.bytes / (stats.median / 1e9), "B");
+        }
+        if (b.items > 0) {
+            print_rate(b.items / (stats.median / 1e9), " items");
+        }
+#ifdef ILC_TRACK_ALLOCS
+        printf("  allocs/op %6.2f  bytes/op %8.1f", bench->allocations, bench->bytes_allocated);
+#endif
+        printf("  (%lu x %u)\n", iterations, suite->repetitions);
+
+        if (b.counters != NULL) {
+            int c;
+            for (c = 0; c < NUM_COUNTERS; c++) {
+                bench->counts[c] /= (double) iterations * suite->repetitions;
+            }
+            print_counters(&suite->counters, bench->counts);
+        }
+    }
+
+    free(samples);
+
+    FILE *json = open_report_file(suite->name, "json");
+    if (json != NULL) {
+        bench_suite_write_json(suite, json);
+        fclose(json);
+    }
+}
+
+static void write_json_string(FILE *out, const char *text) {
+    fputc('"', out);
+    for (; *text != '\0'; text++) {
+        if (*text == '"' || *text == '\\') {
+            fprintf(out, "\\%c", *text);
+        } else if ((unsigned char) *text < 0x20) {
+            fprintf(out, "\\u%04x", *text);
+        } else {
+            fputc(*text, out);
+        }
+    }
+    fputc('"', out);
+}
+
+/* the "model name" line of /proc/cpuinfo, without its trailing newline */
+static void read_cpu_model(char *buf, size_t size) {
+    snprintf(buf, size, "unknown");
+
+    FILE *cpuinfo = fopen("/proc/cpuinfo", "r");
+    if (cpuinfo == NULL) {
+        return;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), cpuinfo) != NULL) {
+        char *colon = strchr(line, ':');
+        if (strncmp(line, "model name", 10) == 0 && colon != NULL) {
+            snprintf(buf, size, "%s", colon + (colon[1] == ' ' ? 2 : 1));
+            buf[strcspn(buf, "\n")] = '\0';
+            break;
+        }
+    }
+
+    fclose(cpuinfo);
+}
+
+static void write_context(FILE *out) {
+    char date[32] = "unknown";
+    time_t now = time(NULL);
+    struct tm utc;
+    if (gmtime_r(&now, &utc) != NULL) {
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    }
+
+    char host[256] = "unknown";
+    if (gethostname(host, sizeof(host)) != 0) {
+        snprintf(host, sizeof(host), "unknown");
+    }
+    host[sizeof(host) - 1] = '\0';
+
+    struct utsname name;
+    char os[sizeof(name.sysname) + sizeof(name.release) + sizeof(name.machine)] = "unknown";
+    if (uname(&name) == 0) {
+        snprintf(os, sizeof(os), "%s %s %s", name.sysname, name.release, name.machine);
+    }
+
+    char cpu[256];
+    read_cpu_model(cpu, sizeof(cpu));
+
+    fprintf(out, "  \"context\": {\n");
+    fprintf(out, "    \"date\": ");
+    write_json_string(out, date);
+    fprintf(out, ",\n    \"host\": ");
+    write_json_string(out, host);
+    fprintf(out, ",\n    \"os\": ");
+    write_json_string(out, os);
+    fprintf(out, ",\n    \"cpu\": ");
+    write_json_string(out, cpu);
+    fprintf(out, ",\n    \"num_cpus\": %ld", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(out, ",\n    \"compiler\": ");
+#ifdef __clang__
+    write_json_string(out, "clang " __clang_version__);
+#elif defined(__GNUC__)
+    write_json_string(out, "gcc " __VERSION__);
+#else
+    write_json_string(out, "unknown");
+#endif
+    fprintf(out, ",\n    \"flags\": ");
+    write_json_string(out, BUILD_CFLAGS);
+    fprintf(out, "\n  },\n");
+}
+
+void bench_suite_write_json(const BenchSuite *suite, FILE *out) {
+    unsigned int i, rep, num_written = 0, max_samples = 1;
+    for (i = 0; i < suite->num_benches; i++) {
+        if (suite->benches[i].num_samples > max_samples) {
+            max_samples = suite->benches[i].num_samples;
+        }
+    }
+
+    double *sorted = malloc(max_samples * sizeof(double));  /* summarize sorts in place */
+    if (sorted == NULL) {
+        fprintf(stderr, "bench_suite_write_json: failed to allocate samples\n");
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(out, "{\n  \"suite\": ");
+    write_json_string(out, suite->name);
+    fprintf(out, ",\n");
+    write_context(out);
+    fprintf(out, "  \"benchmarks\": [");
+
+    for (i = 0; i < suite->num_benches; i++) {
+        const BenchCase *bench = &suite->benches[i];
+        if (bench->num_samples == 0) {
+            continue;  /* not run yet */
+        }
+
+        memcpy(sorted, bench->samples, bench->num_samples * sizeof(double));
+        BenchStats stats = summarize(sorted, bench->num_samples, bench->iterations);
+
+        fprintf(out, "%s\n    {\n      \"name\": ", num_written++ > 0 ? "," : "");
+        write_json_string(out, bench->name);
+        fprintf(out, ",\n      \"iterations\": %lu", bench->iterations);
+        fprintf(out, ",\n      \"repetitions\": %u", bench->num_samples);
+        fprintf(out, ",\n      \"median_ns\": %.3f", stats.median);
+        fprintf(out, ",\n      \"p99_ns\": %.3f", stats.p99);
+        fprintf(out, ",\n      \"mean_ns\": %.3f", stats.mean);
+        fprintf(out, ",\n      \"stddev_ns\": %.3f", stats.stddev);
+        fprintf(out, ",\n      \"min_ns\": %.3f", stats.min);
+        fprintf(out, ",\n      \"bytes_per_iteration\": %lu", bench->bytes);
+        fprintf(out, ",\n      \"items_per_iteration\": %lu", bench->items);
+#ifdef ILC_TRACK_ALLOCS
+        fprintf(out, ",\n      \"allocations_per_iteration\": %.3f", bench->allocations);
+        fprintf(out, ",\n      \"bytes_allocated_per_iteration\": %.3f", bench->bytes_allocated);
+#endif
+        if (suite->counters.fds[COUNTER_CYCLES] >= 0) {
+            int c, num_counters = 0;
+            fprintf(out, ",\n      \"counters_per_iteration\": {");
+            for (c = 0; c < NUM_COUNTERS; c++) {
+                if (suite->counters.slots[c] >= 0) {
+                    fprintf(out, "%s\"%s\": %.3f", num_counters++ > 0 ? ", " : "", counter_names[c],
+                            bench->counts[c]);
+                }
+            }
+            fprintf(out, "}");
+        }
+        fprintf(out, ",\n      \"samples_ns\": [");
+        for (rep = 0; rep < bench->num_samples; rep++) {
+            fprintf(out, "%s%.3f", rep > 0 ? ", " : "", bench->samples[rep]);
+        }
+        fprintf(out, "]\n    }");
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+    free(sorted);
+}
@@ -0,0 +1,922 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/bitset.h>
+#include <ilc/alloc.h>
+
+#define WORD_BITS 64
+#define BLOCK_WORDS 8  /* words per rank directory entry (512 bits) */
+
+#define ARRAY_MAX 4096  /* containers with more values than this are stored as bitmaps */
+#define ARRAY_MIN 3072  /* bitmaps go back to arrays only below this, so churn at ARRAY_MAX doesn't convert */
+#define BITMAP_WORDS (65536 / WORD_BITS)
+
+struct bitset {
+    size_t num_bits;
+    size_t num_words;
+    uint64_t *words;
+    size_t *block_ranks;  /* set bits before each block, NULL until first rank/select */
+    int ranks_stale;
+};
+
+typedef struct {
+    uint16_t key;  /* upper 16 bits shared by every value in the container */
+    uint32_t cardinality;
+    uint16_t *array;  /* sorted lower 16 bits, NULL for bitmap containers */
+    size_t array_capacity;
+    uint64_t *bitmap;  /* BITMAP_WORDS words, NULL for array containers */
+} Container;
+
+struct roaring_bitmap {
+    Container *containers;  /* sorted by key */
+    size_t len;
+    size_t capacity;
+};
+
+static size_t popcount(uint64_t word) {
+    return (size_t) __builtin_popcountll(word);
+}
+
+/* position of the set bit with rank k within a single word */
+static size_t select_in_word(uint64_t word, size_t k) {
+    while (k > 0) {
+        word &= word - 1;  /* clear lowest set bit */
+        k--;
+    }
+    return (size_t) __builtin_ctzll(word);
+}
+
+Bitset *create_bitset(size_t num_bits) {
+    Bitset *bits = malloc(sizeof(Bitset));
+
+    if (bits == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    bits->num_bits = num_bits;
+    bits->num_words = (num_bits + WORD_BITS - 1) / WORD_BITS;
+    bits->words = calloc(bits->num_words == 0 ? 1 : bits->num_words, sizeof(uint64_t));
+    bits->block_ranks = NULL;
+    bits->ranks_stale = 1;
+
+    if (bits->words == NULL) {
+        free(bits);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    return bits;
+}
+
+void free_bitset(Bitset *bits) {
+    if (bits == NULL) {
+        return;
+    }
+
+    free(bits->words);
+    free(bits->block_ranks);
+    free(bits);
+}
+
+size_t bitset_size(const Bitset *bits) {
+    if (bits == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return bits->num_bits;
+}
+
+int bitset_set(Bitset *bits, size_t pos) {
+    if (bits == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (pos >= bits->num_bits) {
+        errno = EDOM;
+        return EDOM;
+    }
+
+    bits->words[pos / WORD_BITS] |= (uint64_t) 1 << (pos % WORD_BITS);
+    bits->ranks_stale = 1;
+
+    return 0;
+}
+
+int bitset_clear(Bitset *bits, size_t pos) {
+    if (bits == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (pos >= bits->num_bits) {
+        errno = EDOM;
+        return EDOM;
+    }
+
+    bits->words[pos / WORD_BITS] &= ~((uint64_t) 1 << (pos % WORD_BITS));
+    bits->ranks_stale = 1;
+
+    return 0;
+}
+
+int bitset_test(const Bitset *bits, size_t pos) {
+    if (bits == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    if (pos >= bits->num_bits) {
+        errno = EDOM;
+        return 0;
+    }
+
+    return (bits->words[pos / WORD_BITS] >> (pos % WORD_BITS)) & 1;
+}
+
+size_t bitset_count(const Bitset *bits) {
+    if (bits == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    size_t count = 0;
+    size_t i;
+    for (i = 0; i < bits->num_words; i++) {
+        count += popcount(bits->words[i]);
+    }
+
+    return count;
+}
+
+static int refresh_block_ranks(Bitset *bits) {
+    if (!bits->ranks_stale) {
+        return 0;
+    }
+
+    size_t num_blocks = (bits->num_words + BLOCK_WORDS - 1) / BLOCK_WORDS;
+
+    if (bits->block_ranks == NULL) {
+        bits->block_ranks = malloc((num_blocks + 1) * sizeof(size_t));
+        if (bits->block_ranks == NULL) {
+            return ENOMEM;
+        }
+    }
+
+    size_t rank = 0;
+    size_t i;
+    for (i = 0; i < bits->num_words; i++) {
+        if (i % BLOCK_WORDS == 0) {
+            bits->block_ranks[i / BLOCK_WORDS] = rank;
+        }
+        rank += popcount(bits->words[i]);
+    }
+    bits->block_ranks[num_blocks] = rank;
+
+    bits->ranks_stale = 0;
+    return 0;
+}
+
+size_t bitset_rank(Bitset *bits, size_t pos) {
+    if (bits == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    if (pos > bits->num_bits) {
+        errno = EDOM;
+        return 0;
+    }
+
+    if (refresh_block_ranks(bits) != 0) {
+        errno = ENOMEM;
+        return 0;
+    }
+
+    size_t word = pos / WORD_BITS;
+    size_t rank = bits->block_ranks[word / BLOCK_WORDS];
+
+    size_t i;
+    for (i = word - word % BLOCK_WORDS; i < word; i++) {
+        rank += popcount(bits->words[i]);
+    }
+
+    if (pos % WORD_BITS != 0) {
+        rank += popcount(bits->words[word] & (((uint64_t) 1 << (pos % WORD_BITS)) - 1));
+    }
+
+    return rank;
+}
+
+int bitset_select(Bitset *bits, size_t k, size_t *pos) {
+    if (bits == NULL || pos == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (refresh_block_ranks(bits) != 0) {
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    size_t num_blocks = (bits->num_words + BLOCK_WORDS - 1) / BLOCK_WORDS;
+
+    if (k >= bits->block_ranks[num_blocks]) {
+        errno = EDOM;
+        return EDOM;
+    }
+
+    /* binary search for the last block starting at or before rank k */
+    size_t lo = 0, hi = num_blocks;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (bits->block_ranks[mid] <= k) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    size_t remaining = k - bits->block_ranks[lo];
+    size_t i = lo * BLOCK_WORDS;
+    for (;;) {
+        size_t count = popcount(bits->words[i]);
+        if (remaining < count) {
+            break;
+        }
+        remaining -= count;
+        i++;
+    }
+
+    *pos = i * WORD_BITS + select_in_word(bits->words[i], remaining);
+    return 0;
+}
+
+static int check_same_size(const Bitset *dest, const Bitset *src) {
+    if (dest == NULL || src == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (dest->num_bits != src->num_bits) {
+        errno = EINVAL;
+        return EINVAL;
+    }
+
+    return 0;
+}
+
+int bitset_and(Bitset *dest, const Bitset *src) {
+    int err = check_same_size(dest, src);
+    if (err != 0) {
+        return err;
+    }
+
+    size_t i;
+    for (i = 0; i < dest->num_words; i++) {
+        dest->words[i] &= src->words[i];
+    }
+    dest->ranks_stale = 1;
+
+    return 0;
+}
+
+int bitset_or(Bitset *dest, const Bitset *src) {
+    int err = check_same_size(dest, src);
+    if (err != 0) {
+        return err;
+    }
+
+    size_t i;
+    for (i = 0; i < dest->num_words; i++) {
+        dest->words[i] |= src->words[i];
+    }
+    dest->ranks_stale = 1;
+
+    return 0;
+}
+
+int bitset_xor(Bitset *dest, const Bitset *src) {
+    int err = check_same_size(dest, src);
+    if (err != 0) {
+        return err;
+    }
+
+    size_t i;
+    for (i = 0; i < dest->num_words; i++) {
+        dest->words[i] ^= src->words[i];
+    }
+    dest->ranks_stale = 1;
+
+    return 0;
+}
+
+/**********************************/
+/* roaring bitmap container logic */
+/**********************************/
+
+static void free_container(Container *c) {
+    free(c->array);
+    free(c->bitmap);
+}
+
+static int bitmap_test(const uint64_t *bitmap, uint16_t low) {
+    return (bitmap[low / WORD_BITS] >> (low % WORD_BITS)) & 1;
+}
+
+static void bitmap_set(uint64_t *bitmap, uint16_t low) {
+    bitmap[low / WORD_BITS] |= (uint64_t) 1 << (low % WORD_BITS);
+}
+
+/* index of low in a sorted array, or the index where it would be inserted */
+static size_t array_search(const uint16_t *array, size_t len, uint16_t low, int *found) {
+    size_t lo = 0, hi = len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (array[mid] < low) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *found = lo < len && array[lo] == low;
+    return lo;
+}
+
+static int container_to_bitmap(Container *c) {
+    uint64_t *bitmap = calloc(BITMAP_WORDS, sizeof(uint64_t));
+    if (bitmap == NULL) {
+        return ENOMEM;
+    }
+
+    size_t i;
+    for (i = 0; i < c->cardinality; i++) {
+        bitmap_set(bitmap, c->array[i]);
+    }
+
+    free(c->array);
+    c->array = NULL;
+    c->array_capacity = 0;
+    c->bitmap = bitmap;
+
+    return 0;
+}
+
+static int container_to_array(Container *c) {
+    uint16_t *array = malloc((c->cardinality == 0 ? 1 : c->cardinality) * sizeof(uint16_t));
+    if (array == NULL) {
+        return ENOMEM;
+    }
+
+    size_t n = 0;
+    size_t w;
+    for (w = 0; w < BITMAP_WORDS; w++) {
+        uint64_t word = c->bitmap[w];
+        while (word != 0) {
+            array[n++] = (uint16_t) (w * WORD_BITS + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+
+    free(c->bitmap);
+    c->bitmap = NULL;
+    c->array = array;
+    c->array_capacity = c->cardinality == 0 ? 1 : c->cardinality;
+
+    return 0;
+}
+
+/* picks the representation for a container built from a full bitmap */
+static int container_from_bitmap(Container *c, uint16_t key, uint64_t *bitmap) {
+    size_t cardinality = 0;
+    size_t w;
+    for (w = 0; w < BITMAP_WORDS; w++) {
+        cardinality += popcount(bitmap[w]);
+    }
+
+    c->key = key;
+    c->cardinality = (uint32_t) cardinality;
+    c->array = NULL;
+    c->array_capacity = 0;
+    c->bitmap = bitmap;
+
+    if (cardinality <= ARRAY_MAX) {
+        if (container_to_array(c) != 0) {
+            free(bitmap);
+            return ENOMEM;
+        }
+    }
+
+    return 0;
+}
+
+static int container_add(Container *c, uint16_t low) {
+    if (c->bitmap != NULL) {
+        if (!bitmap_test(c->bitmap, low)) {
+            bitmap_set(c->bitmap, low);
+            c->cardinality++;
+        }
+        return 0;
+    }
+
+    int found;
+    size_t i = array_search(c->array, c->cardinality, low, &found);
+    if (found) {
+        return 0;
+    }
+
+    if (c->cardinality == ARRAY_MAX) {
+        if (container_to_bitmap(c) != 0) {
+            return ENOMEM;
+        }
+        bitmap_set(c->bitmap, low);
+        c->cardinality++;
+        return 0;
+    }
+
+    if (c->cardinality == c->array_capacity) {
+        size_t capacity = c->array_capacity * 2;
+        if (capacity > ARRAY_MAX) {
+            capacity = ARRAY_MAX;
+        }
+
+        uint16_t *p = realloc(c->array, capacity * sizeof(uint16_t));
+        if (p == NULL) {
+            return ENOMEM;
+        }
+
+        c->array = p;
+        c->array_capacity = capacity;
+    }
+
+    memmove(c->array + i + 1, c->array + i, (c->cardinality - i) * sizeof(uint16_t));
+    c->array[i] = low;
+    c->cardinality++;
+
+    return 0;
+}
+
+static int container_remove(Container *c, uint16_t low) {
+    if (c->bitmap != NULL) {
+        if (!bitmap_test(c->bitmap, low)) {
+            return 0;
+        }
+
+        c->bitmap[low / WORD_BITS] &= ~((uint64_t) 1 << (low % WORD_BITS));
+        c->cardinality--;
+
+        if (c->cardinality < ARRAY_MIN) {
+            return container_to_array(c);
+        }
+        return 0;
+    }
+
+    int found;
+    size_t i = array_search(c->array, c->cardinality, low, &found);
+    if (!found) {
+        return 0;
+    }
+
+    memmove(c->array + i, c->array + i + 1, (c->cardinality - i - 1) * sizeof(uint16_t));
+    c->cardinality--;
+
+    return 0;
+}
+
+static int container_contains(const Container *c, uint16_t low) {
+    if (c->bitmap != NULL) {
+        return bitmap_test(c->bitmap, low);
+    }
+
+    int found;
+    array_search(c->array, c->cardinality, low, &found);
+    return found;
+}
+
+static int container_copy(Container *dest, const Container *src) {
+    *dest = *src;
+
+    if (src->bitmap != NULL) {
+        dest->bitmap = malloc(BITMAP_WORDS * sizeof(uint64_t));
+        if (dest->bitmap == NULL) {
+            return ENOMEM;
+        }
+        memcpy(dest->bitmap, src->bitmap, BITMAP_WORDS * sizeof(uint64_t));
+    } else {
+        dest->array = malloc(src->array_capacity * sizeof(uint16_t));
+        if (dest->array == NULL) {
+            return ENOMEM;
+        }
+        memcpy(dest->array, src->array, src->cardinality * sizeof(uint16_t));
+    }
+
+    return 0;
+}
+
+/* copies a container's values into a zeroed bitmap */
+static void container_fill_bitmap(const Container *c, uint64_t *bitmap) {
+    if (c->bitmap != NULL) {
+        memcpy(bitmap, c->bitmap, BITMAP_WORDS * sizeof(uint64_t));
+        return;
+    }
+
+    size_t i;
+    for (i = 0; i < c->cardinality; i++) {
+        bitmap_set(bitmap, c->array[i]);
+    }
+}
+
+static int container_and(Container *out, const Container *a, const Container *b) {
+    if (a->bitmap != NULL && b->bitmap != NULL) {
+        uint64_t *bitmap = malloc(BITMAP_WORDS * sizeof(uint64_t));
+        if (bitmap == NULL) {
+            return ENOMEM;
+        }
+
+        size_t w;
+        for (w = 0; w < BITMAP_WORDS; w++) {
+            bitmap[w] = a->bitmap[w] & b->bitmap[w];
+        }
+
+        return container_from_bitmap(out, a->key, bitmap);
+    }
+
+    /* at least one side is an array, so the result fits in an array */
+    if (a->bitmap != NULL) {
+        const Container *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    out->key = a->key;
+    out->bitmap = NULL;
+    out->array_capacity = a->cardinality == 0 ? 1 : a->cardinality;
+    out->array = malloc(out->array_capacity * sizeof(uint16_t));
+    if (out->array == NULL) {
+        return ENOMEM;
+    }
+
+    size_t n = 0;
+    if (b->bitmap != NULL) {
+        size_t i;
+        for (i = 0; i < a->cardinality; i++) {
+            if (bitmap_test(b->bitmap, a->array[i])) {
+                out->array[n++] = a->array[i];
+            }
+        }
+    } else {
+        size_t i = 0, j = 0;
+        while (i < a->cardinality && j < b->cardinality) {
+            if (a->array[i] < b->array[j]) {
+                i++;
+            } else if (a->array[i] > b->array[j]) {
+                j++;
+            } else {
+                out->array[n++] = a->array[i];
+                i++;
+                j++;
+            }
+        }
+    }
+
+    out->cardinality = (uint32_t) n;
+    return 0;
+}
+
+static int container_or(Container *out, const Container *a, const Container *b) {
+    if (a->bitmap == NULL && b->bitmap == NULL && a->cardinality + b->cardinality <= ARRAY_MAX) {
+        out->key = a->key;
+        out->bitmap = NULL;
+        out->array_capacity = a->cardinality + b->cardinality;
+        out->array = malloc(out->array_capacity * sizeof(uint16_t));
+        if (out->array == NULL) {
+            return ENOMEM;
+        }
+
+        size_t i = 0, j = 0, n = 0;
+        while (i < a->cardinality || j < b->cardinality) {
+            if (j == b->cardinality || (i < a->cardinality && a->array[i] < b->array[j])) {
+                out->array[n++] = a->array[i++];
+            } else if (i == a->cardinality || b->array[j] < a->array[i]) {
+                out->array[n++] = b->array[j++];
+            } else {
+                out->array[n++] = a->array[i];
+                i++;
+                j++;
+            }
+        }
+
+        out->cardinality = (uint32_t) n;
+        return 0;
+    }
+
+    uint64_t *bitmap = calloc(BITMAP_WORDS, sizeof(uint64_t));
+    if (bitmap == NULL) {
+        return ENOMEM;
+    }
+
+    container_fill_bitmap(a, bitmap);
+
+    if (b->bitmap != NULL) {
+        size_t w;
+        for (w = 0; w < BITMAP_WORDS; w++) {
+            bitmap[w] |= b->bitmap[w];
+        }
+    } else {
+        size_t i;
+        for (i = 0; i < b->cardinality; i++) {
+            bitmap_set(bitmap, b->array[i]);
+        }
+    }
+
+    return container_from_bitmap(out, a->key, bitmap);
+}
+
+/********************************/
+/* roaring bitmap public facing */
+/********************************/
+
+RoaringBitmap *create_roaring_bitmap(void) {
+    RoaringBitmap *r = malloc(sizeof(RoaringBitmap));
+
+    if (r == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    r->containers = NULL;
+    r->len = 0;
+    r->capacity = 0;
+
+    return r;
+}
+
+void free_roaring_bitmap(RoaringBitmap *r) {
+    if (r == NULL) {
+        return;
+    }
+
+    size_t i;
+    for (i = 0; i < r->len; i++) {
+        free_container(&r->containers[i]);
+    }
+
+    free(r->containers);
+    free(r);
+}
+
+static size_t find_container(const RoaringBitmap *r, uint16_t key, int *found) {
+    size_t lo = 0, hi = r->len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (r->containers[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    *found = lo < r->len && r->containers[lo].key == key;
+    return lo;
+}
+
+/* makes room for a container at the end, the caller fills it in */
+static Container *push_container(RoaringBitmap *r) {
+    if (r->len == r->capacity) {
+        size_t capacity = r->capacity == 0 ? 4 : r->capacity * 2;
+        Container *p = realloc(r->containers, capacity * sizeof(Container));
+        if (p == NULL) {
+            return NULL;
+        }
+
+        r->containers = p;
+        r->capacity = capacity;
+    }
+
+    return &r->containers[r->len++];
+}
+
+int roaring_add(RoaringBitmap *r, uint32_t value) {
+    if (r == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    uint16_t key = (uint16_t) (value >> 16);
+    uint16_t low = (uint16_t) (value & 0xFFFF);
+
+    int found;
+    size_t i = find_container(r, key, &found);
+
+    if (!found) {
+        uint16_t *array = malloc(4 * sizeof(uint16_t));
+        if (array == NULL || push_container(r) == NULL) {
+            free(array);
+            errno = ENOMEM;
+            return ENOMEM;
+        }
+
+        memmove(&r->containers[i + 1], &r->containers[i], (r->len - 1 - i) * sizeof(Container));
+
+        Container *c = &r->containers[i];
+        c->key = key;
+        c->cardinality = 0;
+        c->array = array;
+        c->array_capacity = 4;
+        c->bitmap = NULL;
+    }
+
+    if (container_add(&r->containers[i], low) != 0) {
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    return 0;
+}
+
+int roaring_remove(RoaringBitmap *r, uint32_t value) {
+    if (r == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    int found;
+    size_t i = find_container(r, (uint16_t) (value >> 16), &found);
+    if (!found) {
+        return 0;
+    }
+
+    Container *c = &r->containers[i];
+    if (container_remove(c, (uint16_t) (value & 0xFFFF)) != 0) {
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    if (c->cardinality == 0) {
+        free_container(c);
+        memmove(c, c + 1, (r->len - i - 1) * sizeof(Container));
+        r->len--;
+    }
+
+    return 0;
+}
+
+int roaring_contains(const RoaringBitmap *r, uint32_t value) {
+    if (r == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    int found;
+    size_t i = find_container(r, (uint16_t) (value >> 16), &found);
+
+    return found && container_contains(&r->containers[i], (uint16_t) (value & 0xFFFF));
+}
+
+size_t roaring_cardinality(const RoaringBitmap *r) {
+    if (r == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    size_t cardinality = 0;
+    size_t i;
+    for (i = 0; i < r->len; i++) {
+        cardinality += r->containers[i].cardinality;
+    }
+
+    return cardinality;
+}
+
+RoaringBitmap *roaring_and(const RoaringBitmap *r1, const RoaringBitmap *r2) {
+    if (r1 == NULL || r2 == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    RoaringBitmap *result = create_roaring_bitmap();
+    if (result == NULL) {
+        return NULL;
+    }
+
+    size_t i = 0, j = 0;
+    while (i < r1->len && j < r2->len) {
+        const Container *a = &r1->containers[i];
+        const Container *b = &r2->containers[j];
+
+        if (a->key < b->key) {
+            i++;
+            continue;
+        }
+        if (b->key < a->key) {
+            j++;
+            continue;
+        }
+
+        Container c;
+        if (container_and(&c, a, b) != 0) {
+            free_roaring_bitmap(result);
+            errno = ENOMEM;
+            return NULL;
+        }
+
+        if (c.cardinality == 0) {
+            free_container(&c);
+        } else {
+            Container *slot = push_container(result);
+            if (slot == NULL) {
+                free_container(&c);
+                free_roaring_bitmap(result);
+                errno = ENOMEM;
+                return NULL;
+            }
+            *slot = c;
+        }
+
+        i++;
+        j++;
+    }
+
+    return result;
+}
+
+RoaringBitmap *roaring_or(const RoaringBitmap *r1, const RoaringBitmap *r2) {
+    if (r1 == NULL || r2 == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    RoaringBitmap *result = create_roaring_bitmap();
+    if (result == NULL) {
+        return NULL;
+    }
+
+    size_t i = 0, j = 0;
+    while (i < r1->len || j < r2->len) {
+        const Container *a = i < r1->len ? &r1->containers[i] : NULL;
+        const Container *b = j < r2->len ? &r2->containers[j] : NULL;
+
+        Container c;
+        int err;
+        if (b == NULL || (a != NULL && a->key < b->key)) {
+            err = container_copy(&c, a);
+            i++;
+        } else if (a == NULL || b->key < a->key) {
+            err = container_copy(&c, b);
+            j++;
+        } else {
+            err = container_or(&c, a, b);
+            i++;
+            j++;
+        }
+
+        Container *slot = err == 0 ? push_container(result) : NULL;
+        if (slot == NULL) {
+            if (err == 0) {
+                free_container(&c);
+            }
+            free_roaring_bitmap(result);
+            errno = ENOMEM;
+            return NULL;
+        }
+        *slot = c;
+    }
+
+    return result;
+}
+
+size_t roaring_to_array(const RoaringBitmap *r, uint32_t *values) {
+    if (r == NULL || values == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    size_t n = 0;
+    size_t i;
+    for (i = 0; i < r->len; i++) {
+        const Container *c = &r->containers[i];
+        uint32_t high = (uint32_t) c->key << 16;
+
+        if (c->bitmap == NULL) {
+            size_t j;
+            for (j = 0; j < c->cardinality; j++) {
+                values[n++] = high | c->array[j];
+            }
+            continue;
+        }
+
+        size_t w;
+        for (w = 0; w < BITMAP_WORDS; w++) {
+            uint64_t word = c->bitmap[w];
+            while (word != 0) {
+                values[n++] = high | (uint32_t) (w * WORD_BITS + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    return n;
+}
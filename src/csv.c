@@ -0,0 +1,412 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <ilc/csv.h>
+#include <ilc/alloc.h>
+
+#define BLOCK_SIZE 64
+#define QUOTE '"'
+#define NOT_UNESCAPED SIZE_MAX
+#define MIN_CHUNK_SIZE (64 * 1024)
+
+/* storage for unescaped fields given out by csv_parse_columns, never moves */
+struct chunk {
+    struct chunk *next;
+    size_t used;
+    size_t capacity;
+    char data[];
+};
+
+struct csv_parser {
+    char delim;
+
+    /* fields of the current record, reused for every record */
+    String *fields;
+    size_t *unescaped_at;  /* offset in scratch or NOT_UNESCAPED if the field points into input */
+    size_t num_fields;
+    size_t fields_capacity;
+
+    /* unescaped characters of the current record */
+    char *scratch;
+    size_t scratch_len;
+    size_t scratch_capacity;
+
+    struct chunk *chunks;
+};
+
+CsvParser *create_csv_parser(char delim) {
+    if (delim == QUOTE || delim == '\n' || delim == '\r') {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    CsvParser *parser = malloc(sizeof(CsvParser));
+    String *fields = malloc(16 * sizeof(String));
+    size_t *unescaped_at = malloc(16 * sizeof(size_t));
+    char *scratch = malloc(256);
+    if (parser == NULL || fields == NULL || unescaped_at == NULL || scratch == NULL) {
+        free(parser);
+        free(fields);
+        free(unescaped_at);
+        free(scratch);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    parser->delim = delim;
+    parser->fields = fields;
+    parser->unescaped_at = unescaped_at;
+    parser->num_fields = 0;
+    parser->fields_capacity = 16;
+    parser->scratch = scratch;
+    parser->scratch_len = 0;
+    parser->scratch_capacity = 256;
+    parser->chunks = NULL;
+
+    return parser;
+}
+
+void free_csv_parser(CsvParser *parser) {
+    if (parser == NULL) {
+        return;
+    }
+
+    struct chunk *c = parser->chunks;
+    while (c != NULL) {
+        struct chunk *next = c->next;
+        free(c);
+        c = next;
+    }
+
+    free(parser->fields);
+    free(parser->unescaped_at);
+    free(parser->scratch);
+    free(parser);
+}
+
+/* bit i of each mask is set if block[i] is that character */
+static void classify_block(const unsigned char *block, char delim, uint64_t *quotes,
+                           uint64_t *delims, uint64_t *newlines) {
+    uint64_t q = 0, d = 0, n = 0;
+    int i;
+    for (i = 0; i < BLOCK_SIZE; i++) {
+        q |= (uint64_t) (block[i] == QUOTE) << i;
+        d |= (uint64_t) (block[i] == (unsigned char) delim) << i;
+        n |= (uint64_t) (block[i] == '\n') << i;
+    }
+
+    *quotes = q;
+    *delims = d;
+    *newlines = n;
+}
+
+/* bit i of the result is the xor of bits 0 to i, i.e. set between an opening and closing quote */
+static uint64_t prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+static int highest_bit(uint64_t x) {
+    return 63 - __builtin_clzll(x);
+}
+
+static int reserve_scratch(CsvParser *parser, size_t len) {
+    if (parser->scratch_len + len <= parser->scratch_capacity) {
+        return 0;
+    }
+
+    size_t capacity = parser->scratch_capacity;
+    while (capacity < parser->scratch_len + len) {
+        capacity *= 2;
+    }
+
+    char *scratch = realloc(parser->scratch, capacity);
+    if (scratch == NULL) {
+        return ENOMEM;
+    }
+
+    parser->scratch = scratch;
+    parser->scratch_capacity = capacity;
+
+    return 0;
+}
+
+/* drop quotes and turn "" inside quotes into ", writing to the end of scratch */
+static size_t unescape_field(CsvParser *parser, const char *raw, size_t len) {
+    char *out = parser->scratch + parser->scratch_len;
+    size_t written = 0;
+    int in_quotes = 0;
+
+    size_t i;
+    for (i = 0; i < len; i++) {
+        if (raw[i] != QUOTE) {
+            out[written++] = raw[i];
+        } else if (in_quotes && i + 1 < len && raw[i + 1] == QUOTE) {
+            out[written++] = QUOTE;
+            i++;
+        } else {
+            in_quotes = !in_quotes;
+        }
+    }
+
+    return written;
+}
+
+static int add_field(CsvParser *parser, const char *raw, size_t len, int has_quote) {
+    if (parser->num_fields == parser->fields_capacity) {
+        size_t capacity = parser->fields_capacity * 2;
+        String *fields = realloc(parser->fields, capacity * sizeof(String));
+        if (fields == NULL) {
+            return ENOMEM;
+        }
+        parser->fields = fields;
+
+        size_t *unescaped_at = realloc(parser->unescaped_at, capacity * sizeof(size_t));
+        if (unescaped_at == NULL) {
+            return ENOMEM;
+        }
+        parser->unescaped_at = unescaped_at;
+
+        parser->fields_capacity = capacity;
+    }
+
+    String *field = &parser->fields[parser->num_fields];
+    size_t *unescaped_at = &parser->unescaped_at[parser->num_fields];
+    parser->num_fields++;
+
+    /* most fields have no quotes and are used straight from the input */
+    if (!has_quote) {
+        field->chars = (char *)raw;
+        field->len = len;
+        *unescaped_at = NOT_UNESCAPED;
+        return 0;
+    }
+
+    /* a simply quoted field without "" is the input minus the quotes */
+    if (len >= 2 && raw[0] == QUOTE && raw[len - 1] == QUOTE &&
+        memchr(raw + 1, QUOTE, len - 2) == NULL) {
+        field->chars = (char *)raw + 1;
+        field->len = len - 2;
+        *unescaped_at = NOT_UNESCAPED;
+        return 0;
+    }
+
+    /* unescaping never makes a field longer */
+    if (reserve_scratch(parser, len) != 0) {
+        return ENOMEM;
+    }
+
+    field->len = unescape_field(parser, raw, len);
+    *unescaped_at = parser->scratch_len;
+    parser->scratch_len += field->len;
+
+    return 0;
+}
+
+/* hand the finished record to on_record, returns non-zero if parsing should stop */
+static int end_record(CsvParser *parser, csv_record_fn on_record, void *ctx) {
+    /* scratch may have moved while the record was parsed, so point into it only now */
+    size_t i;
+    for (i = 0; i < parser->num_fields; i++) {
+        if (parser->unescaped_at[i] != NOT_UNESCAPED) {
+            parser->fields[i].chars = parser->scratch + parser->unescaped_at[i];
+        }
+    }
+
+    int stop = on_record(parser->fields, parser->num_fields, ctx);
+
+    parser->num_fields = 0;
+    parser->scratch_len = 0;
+
+    return stop;
+}
+
+int csv_parse(CsvParser *parser, const String *input, csv_record_fn on_record, void *ctx) {
+    if (parser == NULL || input == NULL || on_record == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    const char *chars = input->chars;
+    size_t len = input->len;
+
+    parser->num_fields = 0;
+    parser->scratch_len = 0;
+
+    size_t field_start = 0;
+    size_t last_quote = 0;  /* one past the index of the last quote seen, 0 if none */
+    uint64_t in_quotes = 0;  /* all ones if the previous block ended inside quotes */
+
+    size_t block_start;
+    for (block_start = 0; block_start < len; block_start += BLOCK_SIZE) {
+        const unsigned char *block = (const unsigned char *)chars + block_start;
+
+        /* the last partial block is padded with zeros, masked off after classifying */
+        unsigned char padded[BLOCK_SIZE];
+        uint64_t valid = ~(uint64_t) 0;
+        if (len - block_start < BLOCK_SIZE) {
+            memset(padded, 0, BLOCK_SIZE);
+            memcpy(padded, block, len - block_start);
+            block = padded;
+            valid = ((uint64_t) 1 << (len - block_start)) - 1;
+        }
+
+        uint64_t quotes, delims, newlines;
+        classify_block(block, parser->delim, &quotes, &delims, &newlines);
+        delims &= valid;
+
+        uint64_t quoted = prefix_xor(quotes) ^ in_quotes;
+        in_quotes = (quoted >> 63) ? ~(uint64_t) 0 : 0;
+
+        uint64_t structural = (delims | newlines) & ~quoted;
+        while (structural != 0) {
+            int bit = __builtin_ctzll(structural);
+            size_t pos = block_start + bit;
+
+            uint64_t quotes_before = quotes & (((uint64_t) 1 << bit) - 1);
+            if (quotes_before != 0) {
+                last_quote = block_start + highest_bit(quotes_before) + 1;
+            }
+
+            int is_newline = (newlines >> bit) & 1;
+            size_t field_end = pos;
+            if (is_newline && field_end > field_start && chars[field_end - 1] == '\r') {
+                field_end--;
+            }
+
+            int result = add_field(parser, chars + field_start, field_end - field_start,
+                                   last_quote > field_start);
+            if (result != 0) {
+                errno = result;
+                return result;
+            }
+
+            if (is_newline && end_record(parser, on_record, ctx)) {
+                return 0;
+            }
+
+            field_start = pos + 1;
+            structural &= structural - 1;
+        }
+
+        if (quotes != 0) {
+            last_quote = block_start + highest_bit(quotes) + 1;
+        }
+    }
+
+    if (in_quotes) {
+        errno = EINVAL;
+        return EINVAL;
+    }
+
+    /* last record without a trailing newline */
+    if (field_start < len || parser->num_fields > 0) {
+        size_t field_end = len;
+        if (field_end > field_start && chars[field_end - 1] == '\r') {
+            field_end--;
+        }
+
+        int result = add_field(parser, chars + field_start, field_end - field_start,
+                               last_quote > field_start);
+        if (result != 0) {
+            errno = result;
+            return result;
+        }
+
+        end_record(parser, on_record, ctx);
+    }
+
+    return 0;
+}
+
+/* copy an unescaped field somewhere that outlives the record */
+static char *keep_field(CsvParser *parser, const String *field) {
+    struct chunk *c = parser->chunks;
+    if (c == NULL || c->capacity - c->used < field->len) {
+        size_t capacity = field->len > MIN_CHUNK_SIZE ? field->len : MIN_CHUNK_SIZE;
+        c = malloc(sizeof(struct chunk) + capacity);
+        if (c == NULL) {
+            return NULL;
+        }
+
+        c->next = parser->chunks;
+        c->used = 0;
+        c->capacity = capacity;
+        parser->chunks = c;
+    }
+
+    char *kept = c->data + c->used;
+    memcpy(kept, field->chars, field->len);
+    c->used += field->len;
+
+    return kept;
+}
+
+typedef struct {
+    CsvParser *parser;
+    DynArray **columns;
+    size_t num_columns;
+    int error;
+} ColumnsCtx;
+
+static int append_to_columns(const String *fields, size_t num_fields, void *ctx) {
+    ColumnsCtx *columns_ctx = ctx;
+    CsvParser *parser = columns_ctx->parser;
+
+    if (num_fields != columns_ctx->num_columns) {
+        columns_ctx->error = EINVAL;
+        return 1;
+    }
+
+    size_t i;
+    for (i = 0; i < num_fields; i++) {
+        String field = fields[i];
+        if (parser->unescaped_at[i] != NOT_UNESCAPED) {
+            field.chars = keep_field(parser, &fields[i]);
+            if (field.chars == NULL) {
+                columns_ctx->error = ENOMEM;
+                return 1;
+            }
+        }
+
+        if (dynarray_append(columns_ctx->columns[i], &field) != 0) {
+            columns_ctx->error = ENOMEM;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int csv_parse_columns(CsvParser *parser, const String *input, DynArray **columns,
+                      size_t num_columns) {
+    if (parser == NULL || input == NULL || columns == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    ColumnsCtx ctx;
+    ctx.parser = parser;
+    ctx.columns = columns;
+    ctx.num_columns = num_columns;
+    ctx.error = 0;
+
+    int result = csv_parse(parser, input, append_to_columns, &ctx);
+    if (result != 0) {
+        return result;
+    }
+
+    if (ctx.error != 0) {
+        errno = ctx.error;
+        return ctx.error;
+    }
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/deque.h>
+#include <ilc/alloc.h>
+
+struct deque {
+    size_t head;  /* slot of the first item */
+    size_t length;  /* number of items */
+    size_t capacity;  /* allocated size (in number of items), always a power of 2 */
+    size_t item_size;
+    char *contents;
+};
+
+static void *slot(const Deque *deque, size_t i) {
+    return deque->contents + (i & (deque->capacity - 1)) * deque->item_size;
+}
+
+Deque *create_deque_sized(size_t item_size, size_t initial_capacity) {
+    size_t capacity = 1;
+    while (capacity < initial_capacity) {
+        capacity *= 2;
+    }
+
+    Deque *deque = malloc(sizeof(Deque));
+    char *contents = malloc(capacity * item_size);
+    if (deque == NULL || contents == NULL) {
+        free(deque);
+        free(contents);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    deque->head = 0;
+    deque->length = 0;
+    deque->capacity = capacity;
+    deque->item_size = item_size;
+    deque->contents = contents;
+
+    return deque;
+}
+
+Deque *create_deque(size_t item_size) {
+    return create_deque_sized(item_size, 8);
+}
+
+void free_deque(Deque *deque) {
+    if (deque == NULL) {
+        return;
+    }
+
+    free(deque->contents);
+    free(deque);
+}
+
+/* double the capacity, unwrapping the items so they start at slot 0 */
+static int grow(Deque *deque) {
+    char *contents = malloc(deque->capacity * 2 * deque->item_size);
+    if (contents == NULL) {
+        return ENOMEM;
+    }
+
+    size_t first_part = deque->capacity - deque->head;  /* deque is full, so it wraps here */
+    memcpy(contents, slot(deque, deque->head), first_part * deque->item_size);
+    memcpy(contents + first_part * deque->item_size, deque->contents,
+           deque->head * deque->item_size);
+
+    free(deque->contents);
+    deque->contents = contents;
+    deque->head = 0;
+    deque->capacity *= 2;
+
+    return 0;
+}
+
+static int push(Deque *deque, const void *item, int front) {
+    if (deque == NULL || item == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (deque->length == deque->capacity && grow(deque) != 0) {
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    if (front) {
+        deque->head = (deque->head - 1) & (deque->capacity - 1);
+        memcpy(slot(deque, deque->head), item, deque->item_size);
+    } else {
+        memcpy(slot(deque, deque->head + deque->length), item, deque->item_size);
+    }
+    deque->length++;
+
+    return 0;
+}
+
+int deque_push_front(Deque *deque, const void *item) {
+    return push(deque, item, 1);
+}
+
+int deque_push_back(Deque *deque, const void *item) {
+    return push(deque, item, 0);
+}
+
+static int pop(Deque *deque, void *item, int front) {
+    if (deque == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (deque->length == 0) {
+        errno = EINVAL;
+        return EINVAL;
+    }
+
+    size_t i = front ? deque->head : deque->head + deque->length - 1;
+    if (item != NULL) {
+        memcpy(item, slot(deque, i), deque->item_size);
+    }
+
+    if (front) {
+        deque->head = (deque->head + 1) & (deque->capacity - 1);
+    }
+    deque->length--;
+
+    return 0;
+}
+
+int deque_pop_front(Deque *deque, void *item) {
+    return pop(deque, item, 1);
+}
+
+int deque_pop_back(Deque *deque, void *item) {
+    return pop(deque, item, 0);
+}
+
+size_t deque_length(const Deque *deque) {
+    if (deque == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return deque->length;
+}
+
+void *deque_item_at(const Deque *deque, size_t index) {
+    if (deque == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    if (index >= deque->length) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    return slot(deque, deque->head + index);
+}
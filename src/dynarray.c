@@ -3,6 +3,8 @@
 #include <errno.h>
 #include <string.h>
 #include <ilc/dynarray.h>
+#include <ilc/trace.h>
+#include <ilc/alloc.h>
 
 struct dynarray {
     size_t length;  /* number of items in contents */
@@ -53,7 +55,9 @@ int dynarray_append(DynArray *arr, const void *item) {
     }
 
     if (arr->length == arr->capacity) {
+        TRACE_BEGIN("dynarray_append grow");
         void *p = realloc(arr->contents, arr->capacity * 2 * arr->item_size);
+        TRACE_END();
         if (p == NULL) {
             errno = ENOMEM;  /* should be set by realloc, but set again to be sure */
             return ENOMEM;
@@ -81,7 +85,9 @@ int dynarray_insert(DynArray *arr, const void *item, size_t index) {
     }
 
     if (arr->length == arr->capacity) {
+        TRACE_BEGIN("dynarray_insert grow");
         void *p = realloc(arr->contents, arr->capacity * 2 * arr->item_size);
+        TRACE_END();
         if (p == NULL) {
             errno = ENOMEM;
             return ENOMEM;
@@ -109,15 +115,17 @@ int dynarray_remove(DynArray *arr, const void *item, compare_fn equal, int remov
         return EFAULT;
     }
 
-    size_t i;
-    for (i = 0; i < arr->length; i++) {
+    size_t i = 0;
+    while (i < arr->length) {
         void *curr_item = (char *)arr->contents + i * arr->item_size;
         if (equal(item, curr_item)) {
-            dynarray_remove_at(arr, i);
+            dynarray_remove_at(arr, i);  /* the next item moves down to i */
 
             if (!remove_all) {
                 return 0;
             }
+        } else {
+            i++;
         }
     }
 
@@ -139,7 +147,7 @@ int dynarray_remove_at(DynArray *arr, size_t index) {
     void *item = (char *)arr->contents + index * arr->item_size;
     void *rest = (char *)item + arr->item_size;
     size_t num_rest = arr->length - index - 1;
-    memcpy(item, rest, num_rest * arr->item_size);
+    memmove(item, rest, num_rest * arr->item_size);
 
     arr->length--;
 
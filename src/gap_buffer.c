@@ -0,0 +1,195 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/gap_buffer.h>
+#include <ilc/alloc.h>
+
+struct gap_buffer {
+    size_t gap_start;  /* also the cursor, items before it are at [0, gap_start) */
+    size_t gap_end;  /* items after the cursor are at [gap_end, capacity) */
+    size_t capacity;  /* allocated size (in number of items) */
+    size_t item_size;
+    char *contents;
+};
+
+static char *item_ptr(const GapBuffer *buf, size_t i) {
+    return buf->contents + i * buf->item_size;
+}
+
+GapBuffer *create_gap_buffer_sized(size_t item_size, size_t initial_capacity) {
+    GapBuffer *buf = malloc(sizeof(GapBuffer));
+    char *contents = malloc(initial_capacity * item_size);
+    if (buf == NULL || (contents == NULL && initial_capacity * item_size > 0)) {
+        free(buf);
+        free(contents);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    buf->gap_start = 0;
+    buf->gap_end = initial_capacity;
+    buf->capacity = initial_capacity;
+    buf->item_size = item_size;
+    buf->contents = contents;
+
+    return buf;
+}
+
+GapBuffer *create_gap_buffer(size_t item_size) {
+    return create_gap_buffer_sized(item_size, 8);
+}
+
+void free_gap_buffer(GapBuffer *buf) {
+    if (buf == NULL) {
+        return;
+    }
+
+    free(buf->contents);
+    free(buf);
+}
+
+size_t gap_buffer_length(const GapBuffer *buf) {
+    if (buf == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return buf->capacity - (buf->gap_end - buf->gap_start);
+}
+
+size_t gap_buffer_cursor(const GapBuffer *buf) {
+    if (buf == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return buf->gap_start;
+}
+
+int gap_buffer_move_cursor(GapBuffer *buf, size_t index) {
+    if (buf == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (index > gap_buffer_length(buf)) {
+        errno = EINVAL;
+        return EINVAL;
+    }
+
+    /* move only the items between the old and new cursor to the other side of the gap */
+    if (index < buf->gap_start) {
+        size_t num_items = buf->gap_start - index;
+        memmove(item_ptr(buf, buf->gap_end - num_items), item_ptr(buf, index),
+                num_items * buf->item_size);
+        buf->gap_start -= num_items;
+        buf->gap_end -= num_items;
+    } else if (index > buf->gap_start) {
+        size_t num_items = index - buf->gap_start;
+        memmove(item_ptr(buf, buf->gap_start), item_ptr(buf, buf->gap_end),
+                num_items * buf->item_size);
+        buf->gap_start += num_items;
+        buf->gap_end += num_items;
+    }
+
+    return 0;
+}
+
+/* make the gap at least count items, growing by at least double */
+static int reserve(GapBuffer *buf, size_t count) {
+    size_t gap = buf->gap_end - buf->gap_start;
+    if (gap >= count) {
+        return 0;
+    }
+
+    size_t length = buf->capacity - gap;
+    size_t capacity = buf->capacity > 0 ? buf->capacity * 2 : 8;
+    while (capacity < length + count) {
+        capacity *= 2;
+    }
+
+    char *contents = realloc(buf->contents, capacity * buf->item_size);
+    if (contents == NULL) {
+        return ENOMEM;
+    }
+
+    /* slide the items after the gap to the new end */
+    size_t num_after = buf->capacity - buf->gap_end;
+    size_t gap_end = capacity - num_after;
+    memmove(contents + gap_end * buf->item_size, contents + buf->gap_end * buf->item_size,
+            num_after * buf->item_size);
+
+    buf->contents = contents;
+    buf->gap_end = gap_end;
+    buf->capacity = capacity;
+
+    return 0;
+}
+
+int gap_buffer_insert(GapBuffer *buf, const void *items, size_t count) {
+    if (buf == NULL || items == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (reserve(buf, count) != 0) {
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    memcpy(item_ptr(buf, buf->gap_start), items, count * buf->item_size);
+    buf->gap_start += count;
+
+    return 0;
+}
+
+int gap_buffer_delete_before(GapBuffer *buf, size_t count) {
+    if (buf == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (count > buf->gap_start) {
+        errno = EINVAL;
+        return EINVAL;
+    }
+
+    buf->gap_start -= count;
+
+    return 0;
+}
+
+int gap_buffer_delete_after(GapBuffer *buf, size_t count) {
+    if (buf == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (count > buf->capacity - buf->gap_end) {
+        errno = EINVAL;
+        return EINVAL;
+    }
+
+    buf->gap_end += count;
+
+    return 0;
+}
+
+void *gap_buffer_item_at(const GapBuffer *buf, size_t index) {
+    if (buf == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    if (index >= gap_buffer_length(buf)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if (index < buf->gap_start) {
+        return item_ptr(buf, index);
+    }
+
+    return item_ptr(buf, index + (buf->gap_end - buf->gap_start));
+}
@@ -0,0 +1,534 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <math.h>
+#include <ilc/dynarray.h>
+#include <ilc/graph.h>
+#include <ilc/alloc.h>
+
+#define HEAP_ARITY 4
+
+typedef struct {
+    size_t from;
+    size_t to;
+    double weight;
+} Edge;
+
+struct graph_builder {
+    size_t num_vertices;
+    int directed;
+    DynArray *edges;  /* Edge items in the order they were added */
+};
+
+struct graph {
+    size_t num_vertices;
+    size_t num_edges;
+    int directed;
+    size_t *offsets;  /* num_vertices + 1 entries, neighbors of v are offsets[v] to offsets[v + 1] */
+    size_t *targets;
+    double *weights;
+};
+
+struct graph_scratch {
+    size_t capacity;  /* max number of vertices */
+    size_t *items;  /* BFS/Kahn queue or Dijkstra heap */
+    size_t *index;  /* heap positions, in-degrees, or union-find parents */
+};
+
+GraphBuilder *create_graph_builder(size_t num_vertices, int directed) {
+    GraphBuilder *builder = malloc(sizeof(GraphBuilder));
+
+    if (builder == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    builder->edges = create_dynarray(sizeof(Edge));
+
+    if (builder->edges == NULL) {
+        free(builder);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    builder->num_vertices = num_vertices;
+    builder->directed = directed;
+
+    return builder;
+}
+
+void free_graph_builder(GraphBuilder *builder) {
+    if (builder == NULL) {
+        return;
+    }
+
+    free_dynarray(builder->edges);
+    free(builder);
+}
+
+int graph_builder_add_edge(GraphBuilder *builder, size_t from, size_t to, double weight) {
+    if (builder == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (from >= builder->num_vertices || to >= builder->num_vertices) {
+        errno = EINVAL;
+        return EINVAL;
+    }
+
+    Edge edge;
+    edge.from = from;
+    edge.to = to;
+    edge.weight = weight;
+
+    return dynarray_append(builder->edges, &edge);
+}
+
+Graph *graph_builder_freeze(const GraphBuilder *builder) {
+    if (builder == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    size_t n = builder->num_vertices;
+    size_t num_added = dynarray_length(builder->edges);
+    size_t m = builder->directed ? num_added : 2 * num_added;
+
+    Graph *graph = malloc(sizeof(Graph));
+    size_t *offsets = calloc(n + 1, sizeof(size_t));
+    size_t *targets = malloc(m * sizeof(size_t));
+    double *weights = malloc(m * sizeof(double));
+
+    if (graph == NULL || offsets == NULL || targets == NULL || weights == NULL) {
+        free(graph);
+        free(offsets);
+        free(targets);
+        free(weights);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    /* counting sort by source vertex: count degrees, prefix sum, then scatter */
+    size_t i;
+    for (i = 0; i < num_added; i++) {
+        const Edge *e = dynarray_item_at(builder->edges, i);
+        offsets[e->from + 1]++;
+        if (!builder->directed) {
+            offsets[e->to + 1]++;
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    /* offsets[v] is used as the insertion cursor for v and ends up at offsets[v + 1] */
+    for (i = 0; i < num_added; i++) {
+        const Edge *e = dynarray_item_at(builder->edges, i);
+
+        size_t slot = offsets[e->from]++;
+        targets[slot] = e->to;
+        weights[slot] = e->weight;
+
+        if (!builder->directed) {
+            slot = offsets[e->to]++;
+            targets[slot] = e->from;
+            weights[slot] = e->weight;
+        }
+    }
+
+    /* shift cursors back so offsets[v] is the start of v's neighbors again */
+    for (i = n; i > 0; i--) {
+        offsets[i] = offsets[i - 1];
+    }
+    offsets[0] = 0;
+
+    graph->num_vertices = n;
+    graph->num_edges = m;
+    graph->directed = builder->directed;
+    graph->offsets = offsets;
+    graph->targets = targets;
+    graph->weights = weights;
+
+    return graph;
+}
+
+void free_graph(Graph *graph) {
+    if (graph == NULL) {
+        return;
+    }
+
+    free(graph->offsets);
+    free(graph->targets);
+    free(graph->weights);
+    free(graph);
+}
+
+size_t graph_num_vertices(const Graph *graph) {
+    if (graph == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return graph->num_vertices;
+}
+
+size_t graph_num_edges(const Graph *graph) {
+    if (graph == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return graph->num_edges;
+}
+
+int graph_is_directed(const Graph *graph) {
+    if (graph == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return graph->directed;
+}
+
+const size_t *graph_neighbors(const Graph *graph, size_t vertex, const double **weights,
+                              size_t *degree) {
+    if (graph == NULL || degree == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    if (vertex >= graph->num_vertices) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    size_t start = graph->offsets[vertex];
+    *degree = graph->offsets[vertex + 1] - start;
+
+    if (weights != NULL) {
+        *weights = graph->weights + start;
+    }
+
+    return graph->targets + start;
+}
+
+GraphScratch *create_graph_scratch(const Graph *graph) {
+    if (graph == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    GraphScratch *scratch = malloc(sizeof(GraphScratch));
+    size_t *items = malloc(graph->num_vertices * sizeof(size_t));
+    size_t *index = malloc(graph->num_vertices * sizeof(size_t));
+
+    if (scratch == NULL || items == NULL || index == NULL) {
+        free(scratch);
+        free(items);
+        free(index);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    scratch->capacity = graph->num_vertices;
+    scratch->items = items;
+    scratch->index = index;
+
+    return scratch;
+}
+
+void free_graph_scratch(GraphScratch *scratch) {
+    if (scratch == NULL) {
+        return;
+    }
+
+    free(scratch->items);
+    free(scratch->index);
+    free(scratch);
+}
+
+int graph_bfs(const Graph *graph, GraphScratch *scratch, size_t source, size_t *dist,
+              size_t *parent) {
+    if (graph == NULL || scratch == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (source >= graph->num_vertices || scratch->capacity < graph->num_vertices) {
+        errno = EINVAL;
+        return EINVAL;
+    }
+
+    /* index holds the distances so dist can be NULL */
+    size_t *queue = scratch->items;
+    size_t *level = scratch->index;
+    size_t head = 0, tail = 0;
+
+    size_t v;
+    for (v = 0; v < graph->num_vertices; v++) {
+        level[v] = GRAPH_UNREACHABLE;
+        if (parent != NULL) {
+            parent[v] = GRAPH_UNREACHABLE;
+        }
+    }
+
+    level[source] = 0;
+    queue[tail++] = source;
+
+    while (head < tail) {
+        size_t u = queue[head++];
+
+        size_t e;
+        for (e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            size_t w = graph->targets[e];
+            if (level[w] != GRAPH_UNREACHABLE) {
+                continue;
+            }
+
+            level[w] = level[u] + 1;
+            if (parent != NULL) {
+                parent[w] = u;
+            }
+            queue[tail++] = w;
+        }
+    }
+
+    if (dist != NULL) {
+        for (v = 0; v < graph->num_vertices; v++) {
+            dist[v] = level[v];
+        }
+    }
+
+    return 0;
+}
+
+/* indexed d-ary min heap of vertices keyed by dist, pos[v] is v's slot in heap */
+static void heap_place(size_t *heap, size_t *pos, size_t slot, size_t v) {
+    heap[slot] = v;
+    pos[v] = slot;
+}
+
+static void heap_sift_up(size_t *heap, size_t *pos, const double *dist, size_t slot) {
+    size_t v = heap[slot];
+
+    while (slot > 0) {
+        size_t up = (slot - 1) / HEAP_ARITY;
+        if (dist[heap[up]] <= dist[v]) {
+            break;
+        }
+
+        heap_place(heap, pos, slot, heap[up]);
+        slot = up;
+    }
+
+    heap_place(heap, pos, slot, v);
+}
+
+static void heap_sift_down(size_t *heap, size_t *pos, const double *dist, size_t len,
+                           size_t slot) {
+    size_t v = heap[slot];
+
+    for (;;) {
+        size_t first = slot * HEAP_ARITY + 1;
+        if (first >= len) {
+            break;
+        }
+
+        size_t last = first + HEAP_ARITY < len ? first + HEAP_ARITY : len;
+        size_t best = first;
+
+        size_t c;
+        for (c = first + 1; c < last; c++) {
+            if (dist[heap[c]] < dist[heap[best]]) {
+                best = c;
+            }
+        }
+
+        if (dist[heap[best]] >= dist[v]) {
+            break;
+        }
+
+        heap_place(heap, pos, slot, heap[best]);
+        slot = best;
+    }
+
+    heap_place(heap, pos, slot, v);
+}
+
+int graph_dijkstra(const Graph *graph, GraphScratch *scratch, size_t source, double *dist,
+                   size_t *parent) {
+    if (graph == NULL || scratch == NULL || dist == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (source >= graph->num_vertices || scratch->capacity < graph->num_vertices) {
+        errno = EINVAL;
+        return EINVAL;
+    }
+
+    size_t *heap = scratch->items;
+    size_t *pos = scratch->index;  /* GRAPH_UNREACHABLE = never queued, len = already settled */
+    size_t len = 0;
+
+    size_t v;
+    for (v = 0; v < graph->num_vertices; v++) {
+        dist[v] = HUGE_VAL;
+        pos[v] = GRAPH_UNREACHABLE;
+        if (parent != NULL) {
+            parent[v] = GRAPH_UNREACHABLE;
+        }
+    }
+
+    dist[source] = 0;
+    heap_place(heap, pos, len++, source);
+
+    while (len > 0) {
+        size_t u = heap[0];
+        pos[u] = graph->num_vertices;  /* settled */
+
+        len--;
+        if (len > 0) {
+            heap_place(heap, pos, 0, heap[len]);
+            heap_sift_down(heap, pos, dist, len, 0);
+        }
+
+        size_t e;
+        for (e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            size_t w = graph->targets[e];
+            double candidate = dist[u] + graph->weights[e];
+
+            if (pos[w] == graph->num_vertices || candidate >= dist[w]) {
+                continue;
+            }
+
+            dist[w] = candidate;
+            if (parent != NULL) {
+                parent[w] = u;
+            }
+
+            if (pos[w] == GRAPH_UNREACHABLE) {
+                heap_place(heap, pos, len++, w);
+            }
+            heap_sift_up(heap, pos, dist, pos[w]);
+        }
+    }
+
+    return 0;
+}
+
+static size_t find_root(size_t *uf_parent, size_t v) {
+    size_t root = v;
+    while (uf_parent[root] != root) {
+        root = uf_parent[root];
+    }
+
+    /* path compression */
+    while (uf_parent[v] != root) {
+        size_t next = uf_parent[v];
+        uf_parent[v] = root;
+        v = next;
+    }
+
+    return root;
+}
+
+size_t graph_connected_components(const Graph *graph, GraphScratch *scratch, size_t *component) {
+    if (graph == NULL || scratch == NULL || component == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    if (scratch->capacity < graph->num_vertices) {
+        errno = EINVAL;
+        return 0;
+    }
+
+    size_t *uf_parent = scratch->index;
+
+    size_t v;
+    for (v = 0; v < graph->num_vertices; v++) {
+        uf_parent[v] = v;
+    }
+
+    for (v = 0; v < graph->num_vertices; v++) {
+        size_t e;
+        for (e = graph->offsets[v]; e < graph->offsets[v + 1]; e++) {
+            size_t a = find_root(uf_parent, v);
+            size_t b = find_root(uf_parent, graph->targets[e]);
+
+            /* keep the lower vertex as root so labels follow vertex order */
+            if (a < b) {
+                uf_parent[b] = a;
+            } else if (b < a) {
+                uf_parent[a] = b;
+            }
+        }
+    }
+
+    /* roots are the lowest vertex of their component, so they are seen first */
+    size_t num_components = 0;
+    for (v = 0; v < graph->num_vertices; v++) {
+        size_t root = find_root(uf_parent, v);
+        if (root == v) {
+            component[v] = num_components++;
+        } else {
+            component[v] = component[root];
+        }
+    }
+
+    return num_components;
+}
+
+int graph_topological_sort(const Graph *graph, GraphScratch *scratch, size_t *order) {
+    if (graph == NULL || scratch == NULL || order == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (!graph->directed || scratch->capacity < graph->num_vertices) {
+        errno = EINVAL;
+        return EINVAL;
+    }
+
+    size_t *in_degree = scratch->index;
+    size_t head = 0, tail = 0;
+
+    size_t v;
+    for (v = 0; v < graph->num_vertices; v++) {
+        in_degree[v] = 0;
+    }
+
+    size_t e;
+    for (e = 0; e < graph->num_edges; e++) {
+        in_degree[graph->targets[e]]++;
+    }
+
+    /* order doubles as the queue: everything before tail has been emitted */
+    for (v = 0; v < graph->num_vertices; v++) {
+        if (in_degree[v] == 0) {
+            order[tail++] = v;
+        }
+    }
+
+    while (head < tail) {
+        size_t u = order[head++];
+
+        for (e = graph->offsets[u]; e < graph->offsets[u + 1]; e++) {
+            size_t w = graph->targets[e];
+            if (--in_degree[w] == 0) {
+                order[tail++] = w;
+            }
+        }
+    }
+
+    if (tail != graph->num_vertices) {
+        errno = EDOM;
+        return EDOM;
+    }
+
+    return 0;
+}
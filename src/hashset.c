@@ -0,0 +1,275 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/hashset.h>
+#include <ilc/alloc.h>
+
+#define EMPTY_SLOT 0  /* stored hashes are never 0, see slot_hash */
+
+struct hashset {
+    size_t length;  /* number of items */
+    size_t capacity;  /* number of slots, always a power of two */
+    size_t item_size;
+    hash_fn hash;
+    compare_fn equal;
+    size_t *hashes;  /* hash of the item in each slot or EMPTY_SLOT */
+    void *slots;
+};
+
+static size_t slot_hash(const HashSet *set, const void *item) {
+    size_t h = set->hash(item);
+    return h == EMPTY_SLOT ? 1 : h;
+}
+
+static void *slot_at(void *slots, size_t item_size, size_t i) {
+    return (char *)slots + i * item_size;
+}
+
+/* grow once length would pass 3/4 of capacity */
+static size_t capacity_for(size_t num_items) {
+    size_t capacity = 8;
+    while (capacity / 4 * 3 < num_items) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+/* linear probe for item, returns its slot or the empty slot where it would go */
+static size_t find_slot(const HashSet *set, const void *item, size_t h) {
+    size_t mask = set->capacity - 1;
+    size_t i = h & mask;
+
+    while (set->hashes[i] != EMPTY_SLOT) {
+        if (set->hashes[i] == h && set->equal(item, slot_at(set->slots, set->item_size, i))) {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+
+    return i;
+}
+
+static int resize(HashSet *set, size_t new_capacity) {
+    size_t *hashes = calloc(new_capacity, sizeof(size_t));
+    void *slots = malloc(new_capacity * set->item_size);
+
+    if (hashes == NULL || slots == NULL) {
+        free(hashes);
+        free(slots);
+        return ENOMEM;
+    }
+
+    size_t mask = new_capacity - 1;
+    size_t i;
+    for (i = 0; i < set->capacity; i++) {
+        size_t h = set->hashes[i];
+        if (h == EMPTY_SLOT) {
+            continue;
+        }
+
+        size_t j = h & mask;
+        while (hashes[j] != EMPTY_SLOT) {
+            j = (j + 1) & mask;
+        }
+
+        hashes[j] = h;
+        memcpy(slot_at(slots, set->item_size, j), slot_at(set->slots, set->item_size, i),
+               set->item_size);
+    }
+
+    free(set->hashes);
+    free(set->slots);
+
+    set->hashes = hashes;
+    set->slots = slots;
+    set->capacity = new_capacity;
+
+    return 0;
+}
+
+HashSet *create_hashset_sized(size_t item_size, hash_fn hash, compare_fn equal,
+                              size_t initial_capacity) {
+    if (hash == NULL || equal == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    HashSet *set = malloc(sizeof(HashSet));
+
+    if (set == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    set->length = 0;
+    set->capacity = capacity_for(initial_capacity);
+    set->item_size = item_size;
+    set->hash = hash;
+    set->equal = equal;
+    set->hashes = calloc(set->capacity, sizeof(size_t));
+    set->slots = malloc(set->capacity * item_size);
+
+    if (set->hashes == NULL || set->slots == NULL) {
+        free(set->hashes);
+        free(set->slots);
+        free(set);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    return set;
+}
+
+HashSet *create_hashset(size_t item_size, hash_fn hash, compare_fn equal) {
+    return create_hashset_sized(item_size, hash, equal, 0);
+}
+
+void free_hashset(HashSet *set) {
+    if (set == NULL) {
+        return;
+    }
+
+    free(set->hashes);
+    free(set->slots);
+    free(set);
+}
+
+int hashset_add(HashSet *set, const void *item) {
+    if (set == NULL || item == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    size_t h = slot_hash(set, item);
+    size_t i = find_slot(set, item, h);
+
+    if (set->hashes[i] != EMPTY_SLOT) {
+        return EEXIST;
+    }
+
+    if (capacity_for(set->length + 1) > set->capacity) {
+        if (resize(set, set->capacity * 2) != 0) {
+            errno = ENOMEM;
+            return ENOMEM;
+        }
+
+        i = find_slot(set, item, h);
+    }
+
+    set->hashes[i] = h;
+    memcpy(slot_at(set->slots, set->item_size, i), item, set->item_size);
+    set->length++;
+
+    return 0;
+}
+
+int hashset_remove(HashSet *set, const void *item) {
+    if (set == NULL || item == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    size_t mask = set->capacity - 1;
+    size_t hole = find_slot(set, item, slot_hash(set, item));
+
+    if (set->hashes[hole] == EMPTY_SLOT) {
+        return 0;
+    }
+
+    /* backward shift deletion: pull later items of the probe run into the hole */
+    size_t i = (hole + 1) & mask;
+    while (set->hashes[i] != EMPTY_SLOT) {
+        size_t home = set->hashes[i] & mask;
+
+        /* item at i may only move back if the hole is between its home slot and i */
+        if (((hole - home) & mask) < ((i - home) & mask)) {
+            set->hashes[hole] = set->hashes[i];
+            memcpy(slot_at(set->slots, set->item_size, hole),
+                   slot_at(set->slots, set->item_size, i), set->item_size);
+            hole = i;
+        }
+
+        i = (i + 1) & mask;
+    }
+
+    set->hashes[hole] = EMPTY_SLOT;
+    set->length--;
+
+    return 0;
+}
+
+void *hashset_get(const HashSet *set, const void *item) {
+    if (set == NULL || item == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    size_t i = find_slot(set, item, slot_hash(set, item));
+
+    if (set->hashes[i] == EMPTY_SLOT) {
+        return NULL;
+    }
+
+    return slot_at(set->slots, set->item_size, i);
+}
+
+int hashset_contains(const HashSet *set, const void *item) {
+    if (set == NULL || item == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return hashset_get(set, item) != NULL;
+}
+
+size_t hashset_length(const HashSet *set) {
+    if (set == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return set->length;
+}
+
+void *hashset_next(const HashSet *set, size_t *cursor) {
+    if (set == NULL || cursor == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    while (*cursor < set->capacity) {
+        size_t i = (*cursor)++;
+        if (set->hashes[i] != EMPTY_SLOT) {
+            return slot_at(set->slots, set->item_size, i);
+        }
+    }
+
+    return NULL;
+}
+
+void hashset_clear(HashSet *set) {
+    if (set == NULL) {
+        return;
+    }
+
+    memset(set->hashes, 0, set->capacity * sizeof(size_t));
+    set->length = 0;
+}
+
+size_t hash_bytes(const void *data, size_t len) {
+    unsigned long long h = 14695981039346656037ULL;
+
+    size_t i;
+    for (i = 0; i < len; i++) {
+        h ^= ((const unsigned char *)data)[i];
+        h *= 1099511628211ULL;
+    }
+
+    /* FNV-1a mixes low bits poorly and probing uses the low bits */
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+
+    return (size_t) h;
+}
@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <ilc/line_reader.h>
+#include <ilc/alloc.h>
+
+struct line_reader {
+    int fd;
+    int at_eof;
+    char *delim;
+    size_t delim_len;
+    char *buffer;
+    size_t capacity;
+    size_t start;  /* first byte of the current (unreturned) record */
+    size_t scanned;  /* no delimiter starts in [start, scanned) */
+    size_t end;  /* one past the last byte read */
+};
+
+LineReader *create_line_reader(int fd, const String *delim, size_t buffer_size) {
+    if (delim == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    if (delim->len == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if (buffer_size == 0) {
+        buffer_size = LINE_READER_DEFAULT_BUFFER_SIZE;
+    }
+
+    LineReader *reader = malloc(sizeof(LineReader));
+    char *delim_copy = malloc(delim->len);
+    char *buffer = malloc(buffer_size);
+    if (reader == NULL || delim_copy == NULL || buffer == NULL) {
+        free(reader);
+        free(delim_copy);
+        free(buffer);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    memcpy(delim_copy, delim->chars, delim->len);
+
+    reader->fd = fd;
+    reader->at_eof = 0;
+    reader->delim = delim_copy;
+    reader->delim_len = delim->len;
+    reader->buffer = buffer;
+    reader->capacity = buffer_size;
+    reader->start = 0;
+    reader->scanned = 0;
+    reader->end = 0;
+
+    return reader;
+}
+
+void free_line_reader(LineReader *reader) {
+    if (reader == NULL) {
+        return;
+    }
+
+    free(reader->delim);
+    free(reader->buffer);
+    free(reader);
+}
+
+/*
+ * Look for the delimiter in the unscanned part of the buffer. memchr finds
+ * candidate first bytes (libc vectorizes it), and only those get a full
+ * compare. A candidate cut off by the end of the buffer is left unscanned so
+ * it is checked again once more input arrives.
+ */
+static int find_delim(LineReader *reader, size_t *delim_at) {
+    const char *buffer = reader->buffer;
+    size_t i = reader->scanned;
+
+    while (i < reader->end) {
+        const char *candidate = memchr(buffer + i, reader->delim[0], reader->end - i);
+        if (candidate == NULL) {
+            break;
+        }
+
+        i = candidate - buffer;
+        if (reader->end - i < reader->delim_len) {
+            reader->scanned = i;
+            return 0;
+        }
+
+        if (memcmp(candidate, reader->delim, reader->delim_len) == 0) {
+            *delim_at = i;
+            return 1;
+        }
+
+        i++;
+    }
+
+    reader->scanned = reader->end;
+    return 0;
+}
+
+/* make room after end by moving the current record to the front, or by growing */
+static int make_room(LineReader *reader) {
+    if (reader->start > 0) {
+        size_t pending = reader->end - reader->start;
+        memmove(reader->buffer, reader->buffer + reader->start, pending);
+
+        reader->scanned -= reader->start;
+        reader->end = pending;
+        reader->start = 0;
+    }
+
+    if (reader->end < reader->capacity) {
+        return 0;
+    }
+
+    char *buffer = realloc(reader->buffer, reader->capacity * 2);
+    if (buffer == NULL) {
+        return ENOMEM;
+    }
+
+    reader->buffer = buffer;
+    reader->capacity *= 2;
+
+    return 0;
+}
+
+static int fill_buffer(LineReader *reader) {
+    /* every record has been returned, so the whole buffer is free */
+    if (reader->start == reader->end) {
+        reader->start = 0;
+        reader->scanned = 0;
+        reader->end = 0;
+    }
+
+    if (reader->end == reader->capacity && make_room(reader) != 0) {
+        return ENOMEM;
+    }
+
+    ssize_t num_read;
+    do {
+        num_read = read(reader->fd, reader->buffer + reader->end, reader->capacity - reader->end);
+    } while (num_read == -1 && errno == EINTR);
+
+    if (num_read == -1) {
+        return errno;  /* set by read */
+    }
+
+    if (num_read == 0) {
+        reader->at_eof = 1;
+    }
+
+    reader->end += num_read;
+
+    return 0;
+}
+
+int line_reader_next(LineReader *reader, String *record) {
+    if (reader == NULL || record == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    size_t delim_at;
+    while (!find_delim(reader, &delim_at)) {
+        if (reader->at_eof) {
+            if (reader->start == reader->end) {
+                errno = ENODATA;
+                return ENODATA;
+            }
+
+            /* last record without a trailing delimiter */
+            record->chars = reader->buffer + reader->start;
+            record->len = reader->end - reader->start;
+            reader->start = reader->end;
+            reader->scanned = reader->end;
+
+            return 0;
+        }
+
+        int fill_result = fill_buffer(reader);
+        if (fill_result != 0) {
+            errno = fill_result;
+            return fill_result;
+        }
+    }
+
+    record->chars = reader->buffer + reader->start;
+    record->len = delim_at - reader->start;
+
+    reader->start = delim_at + reader->delim_len;
+    reader->scanned = reader->start;
+
+    return 0;
+}
@@ -0,0 +1,597 @@
+#define _POSIX_C_SOURCE 200809L  /* clock_gettime, gmtime_r, nanosleep */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <ilc/log.h>
+#include <ilc/queue.h>
+#include <ilc/alloc.h>
+
+#define IDLE_SLEEP_NS 1000000  /* how long the writer sleeps when there was nothing to write */
+#define FLUSH_SLEEP_NS 100000
+#define MAX_SPEC_LEN 24  /* longest conversion spec kept, "%-+ #0" and a width and precision fit easily */
+
+typedef union {
+    long long i;
+    unsigned long long u;
+    double d;
+    const void *p;
+    size_t text_offset;  /* %s arguments, into the record's text */
+} LogArg;
+
+/* what goes through the queue, the format's address stands in for the format */
+typedef struct {
+    const char *fmt;
+    struct timespec time;
+    int level;
+    int num_args;
+    LogArg args[LOGGER_MAX_ARGS];
+    char text[LOGGER_TEXT_BYTES];
+} LogRecord;
+
+/* one thread's queue and counts, the thread writes pushed and dropped and the writer handled */
+typedef struct _log_buffer {
+    SpscQueue *queue;
+    size_t pushed;
+    size_t handled;  /* records the writer has popped and written (or failed to) */
+    size_t dropped;
+    size_t reported_drops;  /* writer only */
+    unsigned int thread;
+    int in_use;  /* 1 while a live thread owns the buffer */
+    struct _log_buffer *next;
+} LogBuffer;
+
+struct logger {
+    int fd;
+    int level;
+    size_t capacity;
+    pthread_key_t key;  /* the calling thread's LogBuffer */
+    LogBuffer *buffers;  /* every buffer made, newest first */
+    unsigned int num_buffers;
+    size_t lost;  /* records dropped because a buffer couldn't be allocated */
+    int stopping;
+    pthread_t writer;
+    LogRecord *records;  /* the writer's batch of popped records */
+    char (*lines)[LOGGER_LINE_MAX];  /* and their formatted lines, one extra for a dropped records note */
+};
+
+/* a parsed conversion spec, like "%-8.3lld" */
+typedef struct {
+    size_t len;  /* chars from the % through the conversion */
+    char length[3];
+    char conversion;
+} FormatSpec;
+
+static const char *LEVEL_NAMES[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+
+
+static void sleep_ns(long ns) {
+    struct timespec ts = {0, ns};
+    nanosleep(&ts, NULL);
+}
+
+/*
+ * Parse the conversion spec starting at spec (a '%'). The same parse decides
+ * what logger_log copies and how the writer prints it.
+ *
+ * Returns: 1 if the spec is supported, 0 if not.
+ */
+static int parse_spec(const char *spec, FormatSpec *parsed) {
+    size_t i = 1;
+    while (spec[i] != '\0' && strchr("-+ #0", spec[i]) != NULL) {
+        i++;
+    }
+    while (spec[i] >= '0' && spec[i] <= '9') {
+        i++;
+    }
+    if (spec[i] == '.') {
+        i++;
+        while (spec[i] >= '0' && spec[i] <= '9') {
+            i++;
+        }
+    }
+
+    size_t length_len = 0;
+    if ((spec[i] == 'h' && spec[i + 1] == 'h') || (spec[i] == 'l' && spec[i + 1] == 'l')) {
+        length_len = 2;
+    } else if (spec[i] != '\0' && strchr("hlzjt", spec[i]) != NULL) {
+        length_len = 1;
+    }
+    memcpy(parsed->length, spec + i, length_len);
+    parsed->length[length_len] = '\0';
+    i += length_len;
+
+    char c = spec[i];
+    parsed->conversion = c;
+    parsed->len = i + 1;
+
+    if (c == '\0' || parsed->len > MAX_SPEC_LEN) {
+        return 0;
+    }
+    if (c == '%') {
+        return parsed->len == 2;
+    }
+    if (strchr("diouxX", c) != NULL) {
+        return 1;
+    }
+    if (strchr("fFeEgGaA", c) != NULL) {
+        return length_len == 0 || strcmp(parsed->length, "l") == 0;
+    }
+    if (strchr("csp", c) != NULL) {
+        return length_len == 0;
+    }
+
+    return 0;
+}
+
+static long long signed_arg(const char *length, va_list *args) {
+    if (strcmp(length, "hh") == 0) {
+        return (signed char) va_arg(*args, int);
+    } else if (strcmp(length, "h") == 0) {
+        return (short) va_arg(*args, int);
+    } else if (strcmp(length, "l") == 0) {
+        return va_arg(*args, long);
+    } else if (strcmp(length, "ll") == 0) {
+        return va_arg(*args, long long);
+    } else if (strcmp(length, "z") == 0) {
+        return (long long) va_arg(*args, size_t);
+    } else if (strcmp(length, "j") == 0) {
+        return va_arg(*args, intmax_t);
+    } else if (strcmp(length, "t") == 0) {
+        return va_arg(*args, ptrdiff_t);
+    }
+
+    return va_arg(*args, int);
+}
+
+static unsigned long long unsigned_arg(const char *length, va_list *args) {
+    if (strcmp(length, "hh") == 0) {
+        return (unsigned char) va_arg(*args, unsigned int);
+    } else if (strcmp(length, "h") == 0) {
+        return (unsigned short) va_arg(*args, unsigned int);
+    } else if (strcmp(length, "l") == 0) {
+        return va_arg(*args, unsigned long);
+    } else if (strcmp(length, "ll") == 0) {
+        return va_arg(*args, unsigned long long);
+    } else if (strcmp(length, "z") == 0) {
+        return va_arg(*args, size_t);
+    } else if (strcmp(length, "j") == 0) {
+        return va_arg(*args, uintmax_t);
+    } else if (strcmp(length, "t") == 0) {
+        return (unsigned long long) va_arg(*args, ptrdiff_t);
+    }
+
+    return va_arg(*args, unsigned int);
+}
+
+/* copy the arguments fmt uses into record, stopping where the writer will stop printing them */
+static void capture_args(LogRecord *record, const char *fmt, va_list *args) {
+    size_t text_used = 0;
+    record->num_args = 0;
+    record->text[LOGGER_TEXT_BYTES - 1] = '\0';  /* where strings that don't fit point */
+
+    const char *c;
+    for (c = strchr(fmt, '%'); c != NULL; c = strchr(c, '%')) {
+        FormatSpec spec;
+        if (!parse_spec(c, &spec)) {
+            return;
+        }
+
+        c += spec.len;
+        if (spec.conversion == '%') {
+            continue;
+        }
+        if (record->num_args == LOGGER_MAX_ARGS) {
+            return;
+        }
+
+        LogArg *arg = &record->args[record->num_args++];
+        if (spec.conversion == 'd' || spec.conversion == 'i') {
+            arg->i = signed_arg(spec.length, args);
+        } else if (strchr("ouxX", spec.conversion) != NULL) {
+            arg->u = unsigned_arg(spec.length, args);
+        } else if (spec.conversion == 'c') {
+            arg->i = va_arg(*args, int);
+        } else if (spec.conversion == 'p') {
+            arg->p = va_arg(*args, void *);
+        } else if (spec.conversion == 's') {
+            const char *s = va_arg(*args, const char *);
+            if (s == NULL) {
+                s = "(null)";
+            }
+
+            size_t room = LOGGER_TEXT_BYTES - 1 - text_used;
+            size_t len = strlen(s);
+            if (len > room) {
+                len = room;
+            }
+
+            arg->text_offset = room > 0 ? text_used : LOGGER_TEXT_BYTES - 1;
+            if (room > 0) {
+                memcpy(record->text + text_used, s, len);
+                record->text[text_used + len] = '\0';
+                text_used += len + 1;
+                if (text_used > LOGGER_TEXT_BYTES - 1) {
+                    text_used = LOGGER_TEXT_BYTES - 1;
+                }
+            }
+        } else {
+            arg->d = va_arg(*args, double);
+        }
+    }
+}
+
+/* the buffer for the calling thread, claiming a released one or making one if it has none */
+static LogBuffer *thread_buffer(Logger *logger) {
+    LogBuffer *buffer = pthread_getspecific(logger->key);
+    if (buffer != NULL) {
+        return buffer;
+    }
+
+    for (buffer = __atomic_load_n(&logger->buffers, __ATOMIC_ACQUIRE); buffer != NULL; buffer = buffer->next) {
+        int free_buffer = 0;
+        if (__atomic_compare_exchange_n(&buffer->in_use, &free_buffer, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (buffer == NULL) {
+        buffer = calloc(1, sizeof(LogBuffer));
+        SpscQueue *queue = create_spsc_queue(sizeof(LogRecord), logger->capacity);
+        if (buffer == NULL || queue == NULL) {
+            free(buffer);
+            free_spsc_queue(queue);
+            return NULL;
+        }
+
+        buffer->queue = queue;
+        buffer->in_use = 1;
+        buffer->thread = __atomic_fetch_add(&logger->num_buffers, 1, __ATOMIC_RELAXED);
+        buffer->next = __atomic_load_n(&logger->buffers, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&logger->buffers, &buffer->next, buffer, 1,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+
+    pthread_setspecific(logger->key, buffer);
+    return buffer;
+}
+
+/* the thread is exiting, its buffer can go to the next thread that logs */
+static void release_buffer(void *buffer) {
+    __atomic_store_n(&((LogBuffer *) buffer)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+int logger_log(Logger *logger, int level, const char *fmt, ...) {
+    if (logger == NULL || fmt == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (level < __atomic_load_n(&logger->level, __ATOMIC_RELAXED)) {
+        return 0;
+    }
+
+    LogBuffer *buffer = thread_buffer(logger);
+    if (buffer == NULL) {
+        __atomic_add_fetch(&logger->lost, 1, __ATOMIC_RELAXED);
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    LogRecord record;
+    record.fmt = fmt;
+    record.level = level;
+    clock_gettime(CLOCK_REALTIME, &record.time);
+
+    va_list args;
+    va_start(args, fmt);
+    capture_args(&record, fmt, &args);
+    va_end(args);
+
+    if (spsc_queue_push(buffer->queue, &record) != 0) {
+        __atomic_add_fetch(&buffer->dropped, 1, __ATOMIC_RELAXED);
+        errno = EAGAIN;
+        return EAGAIN;
+    }
+
+    __atomic_add_fetch(&buffer->pushed, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/* snprintf that appends at *pos and leaves *pos at the end of what fit */
+static void append(char *line, size_t size, size_t *pos, const char *fmt, ...) {
+    if (*pos >= size - 1) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    int written = vsnprintf(line + *pos, size - *pos, fmt, args);
+    va_end(args);
+
+    if (written > 0) {
+        *pos += (size_t) written < size - *pos ? (size_t) written : size - 1 - *pos;
+    }
+}
+
+static void append_arg(char *line, size_t size, size_t *pos, const char *c, const FormatSpec *spec,
+                       const LogRecord *record, const LogArg *arg) {
+    /* the spec without its length modifier, plus "ll" for integers since they were widened */
+    size_t flags_len = spec->len - 1 - strlen(spec->length);
+    char fmt[MAX_SPEC_LEN + 3];
+    memcpy(fmt, c, flags_len);
+    fmt[flags_len] = '\0';
+
+    char conversion[4] = {spec->conversion, '\0'};
+    if (strchr("diouxX", spec->conversion) != NULL) {
+        strcpy(conversion, "ll");
+        conversion[2] = spec->conversion;
+        conversion[3] = '\0';
+    }
+    strcat(fmt, conversion);
+
+    switch (spec->conversion) {
+    case 'd': case 'i':
+        append(line, size, pos, fmt, arg->i);
+        break;
+    case 'o': case 'u': case 'x': case 'X':
+        append(line, size, pos, fmt, arg->u);
+        break;
+    case 'c':
+        append(line, size, pos, fmt, (int) arg->i);
+        break;
+    case 'p':
+        append(line, size, pos, fmt, arg->p);
+        break;
+    case 's':
+        append(line, size, pos, fmt, record->text + arg->text_offset);
+        break;
+    default:
+        append(line, size, pos, fmt, arg->d);
+        break;
+    }
+}
+
+static size_t format_record(const LogRecord *record, unsigned int thread, char *line, size_t size) {
+    struct tm tm;
+    gmtime_r(&record->time.tv_sec, &tm);
+
+    size_t pos = strftime(line, size, "%Y-%m-%dT%H:%M:%S", &tm);
+    append(line, size, &pos, ".%06ldZ %-5s [thread %u] ", record->time.tv_nsec / 1000,
+           LEVEL_NAMES[record->level < 0 ? 0 : record->level > 3 ? 3 : record->level], thread);
+
+    const char *c = record->fmt;
+    int next_arg = 0;
+    while (*c != '\0' && pos < size - 1) {
+        const char *percent = strchr(c, '%');
+        size_t plain = percent != NULL ? (size_t) (percent - c) : strlen(c);
+        if (plain > 0) {
+            append(line, size, &pos, "%.*s", (int) plain, c);
+            c += plain;
+            continue;
+        }
+
+        FormatSpec spec;
+        if (!parse_spec(c, &spec) || (spec.conversion != '%' && next_arg == record->num_args)) {
+            append(line, size, &pos, "%s", c);  /* the rest as it is, like capture_args stopped */
+            break;
+        }
+
+        if (spec.conversion == '%') {
+            append(line, size, &pos, "%%");
+        } else {
+            append_arg(line, size, &pos, c, &spec, record, &record->args[next_arg++]);
+        }
+        c += spec.len;
+    }
+
+    if (pos >= size - 1) {
+        pos = size - 2;
+    }
+    line[pos++] = '\n';
+
+    return pos;
+}
+
+/* writev all of iov, retrying after signals and short writes */
+static void write_lines(int fd, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;  /* nowhere to report it, the records are lost */
+        }
+
+        while (count > 0 && (size_t) written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *) iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+}
+
+/* write one batch of a buffer's records, returns how many there were */
+static size_t write_batch(Logger *logger, LogBuffer *buffer, LogRecord *records,
+                          char (*lines)[LOGGER_LINE_MAX], struct iovec *iov) {
+    int count = 0;
+
+    size_t dropped = __atomic_load_n(&buffer->dropped, __ATOMIC_RELAXED);
+    if (dropped != buffer->reported_drops) {
+        LogRecord note;
+        note.fmt = "dropped %zu records, the queue was full";
+        note.level = LOGGER_LEVEL_WARN;
+        note.num_args = 1;
+        note.args[0].u = dropped - buffer->reported_drops;
+        clock_gettime(CLOCK_REALTIME, &note.time);
+        buffer->reported_drops = dropped;
+
+        iov[count].iov_base = lines[LOGGER_BATCH];
+        iov[count].iov_len = format_record(&note, buffer->thread, lines[LOGGER_BATCH], LOGGER_LINE_MAX);
+        count++;
+    }
+
+    size_t popped = spsc_queue_pop_batch(buffer->queue, records, LOGGER_BATCH);
+    size_t i;
+    for (i = 0; i < popped; i++) {
+        iov[count].iov_base = lines[i];
+        iov[count].iov_len = format_record(&records[i], buffer->thread, lines[i], LOGGER_LINE_MAX);
+        count++;
+    }
+
+    write_lines(logger->fd, iov, count);
+    __atomic_add_fetch(&buffer->handled, popped, __ATOMIC_RELEASE);
+
+    return popped;
+}
+
+static void *run_writer(void *arg) {
+    Logger *logger = arg;
+
+    struct iovec iov[LOGGER_BATCH + 1];
+
+    for (;;) {
+        /* read before the pass, so a stop is only obeyed after a pass that saw everything logged before it */
+        int stopping = __atomic_load_n(&logger->stopping, __ATOMIC_ACQUIRE);
+
+        size_t popped = 0;
+        LogBuffer *buffer;
+        for (buffer = __atomic_load_n(&logger->buffers, __ATOMIC_ACQUIRE); buffer != NULL; buffer = buffer->next) {
+            popped += write_batch(logger, buffer, logger->records, logger->lines, iov);
+        }
+
+        if (popped == 0) {
+            if (stopping) {
+                break;
+            }
+            sleep_ns(IDLE_SLEEP_NS);
+        }
+    }
+
+    return NULL;
+}
+
+Logger *create_logger(int fd, size_t records_per_thread) {
+    if (records_per_thread == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    Logger *logger = malloc(sizeof(Logger));
+    if (logger == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    logger->fd = fd;
+    logger->level = LOGGER_LEVEL_DEBUG;
+    logger->capacity = records_per_thread;
+    logger->buffers = NULL;
+    logger->num_buffers = 0;
+    logger->lost = 0;
+    logger->stopping = 0;
+
+    /* allocated here, so a logger whose writer couldn't run is never returned */
+    logger->records = malloc(LOGGER_BATCH * sizeof(LogRecord));
+    logger->lines = malloc((LOGGER_BATCH + 1) * sizeof(*logger->lines));
+    if (logger->records == NULL || logger->lines == NULL) {
+        free(logger->records);
+        free(logger->lines);
+        free(logger);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    if (pthread_key_create(&logger->key, release_buffer) != 0) {
+        free(logger->records);
+        free(logger->lines);
+        free(logger);
+        errno = EAGAIN;
+        return NULL;
+    }
+
+    if (pthread_create(&logger->writer, NULL, run_writer, logger) != 0) {
+        pthread_key_delete(logger->key);
+        free(logger->records);
+        free(logger->lines);
+        free(logger);
+        errno = EAGAIN;
+        return NULL;
+    }
+
+    return logger;
+}
+
+void free_logger(Logger *logger) {
+    if (logger == NULL) {
+        return;
+    }
+
+    __atomic_store_n(&logger->stopping, 1, __ATOMIC_RELEASE);
+    pthread_join(logger->writer, NULL);
+
+    /* deleting the key first means no exiting thread runs release_buffer on a freed buffer */
+    pthread_key_delete(logger->key);
+
+    LogBuffer *buffer = logger->buffers;
+    while (buffer != NULL) {
+        LogBuffer *next = buffer->next;
+        free_spsc_queue(buffer->queue);
+        free(buffer);
+        buffer = next;
+    }
+
+    free(logger->records);
+    free(logger->lines);
+    free(logger);
+}
+
+void logger_set_level(Logger *logger, int level) {
+    if (logger == NULL) {
+        return;
+    }
+
+    __atomic_store_n(&logger->level, level, __ATOMIC_RELAXED);
+}
+
+void logger_flush(Logger *logger) {
+    if (logger == NULL) {
+        return;
+    }
+
+    LogBuffer *buffer;
+    for (buffer = __atomic_load_n(&logger->buffers, __ATOMIC_ACQUIRE); buffer != NULL; buffer = buffer->next) {
+        size_t pushed = __atomic_load_n(&buffer->pushed, __ATOMIC_ACQUIRE);
+        while (__atomic_load_n(&buffer->handled, __ATOMIC_ACQUIRE) < pushed) {
+            sleep_ns(FLUSH_SLEEP_NS);
+        }
+    }
+}
+
+size_t logger_dropped(const Logger *logger) {
+    if (logger == NULL) {
+        return 0;
+    }
+
+    size_t dropped = __atomic_load_n(&logger->lost, __ATOMIC_RELAXED);
+    const LogBuffer *buffer;
+    for (buffer = __atomic_load_n(&logger->buffers, __ATOMIC_ACQUIRE); buffer != NULL; buffer = buffer->next) {
+        dropped += __atomic_load_n(&buffer->dropped, __ATOMIC_RELAXED);
+    }
+
+    return dropped;
+}
@@ -0,0 +1,437 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <ilc/packed_string_list.h>
+#include <ilc/trace.h>
+#include <ilc/alloc.h>
+
+struct packed_string_list {
+    size_t length;  /* number of strings */
+    size_t offsets_capacity;  /* allocated offsets (in number of offsets) */
+    int wide;  /* offsets are uint64_t instead of uint32_t */
+    void *offsets;  /* length + 1 offsets, string i is chars[offsets[i], offsets[i + 1]) */
+    size_t bytes;  /* chars in use, also offsets[length] */
+    size_t chars_capacity;
+    char *chars;
+};
+
+typedef struct {
+    uint64_t prefix;  /* first 8 bytes, big endian, zero padded */
+    size_t index;
+} SortEntry;
+
+static size_t offset_at(const PackedStringList *list, size_t i) {
+    if (list->wide) {
+        return ((uint64_t *) list->offsets)[i];
+    }
+
+    return ((uint32_t *) list->offsets)[i];
+}
+
+static void store_offset(void *offsets, int wide, size_t i, size_t offset) {
+    if (wide) {
+        ((uint64_t *) offsets)[i] = offset;
+    } else {
+        ((uint32_t *) offsets)[i] = offset;
+    }
+}
+
+PackedStringList *create_packed_string_list(void) {
+    PackedStringList *list = malloc(sizeof(PackedStringList));
+    uint32_t *offsets = malloc(16 * sizeof(uint32_t));
+    char *chars = malloc(256);
+    if (list == NULL || offsets == NULL || chars == NULL) {
+        free(list);
+        free(offsets);
+        free(chars);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    offsets[0] = 0;
+
+    list->length = 0;
+    list->offsets_capacity = 16;
+    list->wide = 0;
+    list->offsets = offsets;
+    list->bytes = 0;
+    list->chars_capacity = 256;
+    list->chars = chars;
+
+    return list;
+}
+
+void free_packed_string_list(PackedStringList *list) {
+    if (list == NULL) {
+        return;
+    }
+
+    free(list->offsets);
+    free(list->chars);
+    free(list);
+}
+
+/* switch to 8 byte offsets once chars can't be indexed by 4 bytes */
+static int widen_offsets(PackedStringList *list) {
+    uint64_t *wide = malloc(list->offsets_capacity * sizeof(uint64_t));
+    if (wide == NULL) {
+        return ENOMEM;
+    }
+
+    size_t i;
+    for (i = 0; i <= list->length; i++) {
+        wide[i] = ((uint32_t *) list->offsets)[i];
+    }
+
+    free(list->offsets);
+    list->offsets = wide;
+    list->wide = 1;
+
+    return 0;
+}
+
+static int reserve(PackedStringList *list, size_t len) {
+    if (!list->wide && list->bytes + len > UINT32_MAX && widen_offsets(list) != 0) {
+        return ENOMEM;
+    }
+
+    if (list->length + 1 == list->offsets_capacity) {
+        size_t offset_size = list->wide ? sizeof(uint64_t) : sizeof(uint32_t);
+        void *offsets = realloc(list->offsets, list->offsets_capacity * 2 * offset_size);
+        if (offsets == NULL) {
+            return ENOMEM;
+        }
+
+        list->offsets = offsets;
+        list->offsets_capacity *= 2;
+    }
+
+    if (list->bytes + len > list->chars_capacity) {
+        size_t capacity = list->chars_capacity;
+        while (capacity < list->bytes + len) {
+            capacity *= 2;
+        }
+
+        char *chars = realloc(list->chars, capacity);
+        if (chars == NULL) {
+            return ENOMEM;
+        }
+
+        list->chars = chars;
+        list->chars_capacity = capacity;
+    }
+
+    return 0;
+}
+
+int packed_string_list_append(PackedStringList *list, const String *str) {
+    if (list == NULL || str == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (reserve(list, str->len) != 0) {
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    memcpy(list->chars + list->bytes, str->chars, str->len);
+    list->bytes += str->len;
+    list->length++;
+    store_offset(list->offsets, list->wide, list->length, list->bytes);
+
+    return 0;
+}
+
+size_t packed_string_list_length(const PackedStringList *list) {
+    if (list == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return list->length;
+}
+
+size_t packed_string_list_bytes(const PackedStringList *list) {
+    if (list == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return list->bytes;
+}
+
+int packed_string_list_get(const PackedStringList *list, size_t index, String *view) {
+    if (list == NULL || view == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (index >= list->length) {
+        errno = EDOM;
+        return EDOM;
+    }
+
+    size_t start = offset_at(list, index);
+    view->chars = list->chars + start;
+    view->len = offset_at(list, index + 1) - start;
+
+    return 0;
+}
+
+PackedStringList *packed_string_list_from_string_list(const StringList *strs) {
+    if (strs == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    PackedStringList *list = create_packed_string_list();
+    if (list == NULL) {
+        return NULL;
+    }
+
+    size_t i;
+    for (i = 0; i < strs->len; i++) {
+        if (packed_string_list_append(list, &strs->strs[i]) != 0) {
+            free_packed_string_list(list);
+            return NULL;
+        }
+    }
+
+    return list;
+}
+
+StringList *packed_string_list_to_string_list(const PackedStringList *list) {
+    if (list == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    StringList *strs = malloc(sizeof(StringList));
+    String *views = malloc(list->length * sizeof(String));
+    if (strs == NULL || (views == NULL && list->length > 0)) {
+        free(strs);
+        free(views);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size_t i;
+    for (i = 0; i < list->length; i++) {
+        packed_string_list_get(list, i, &views[i]);
+    }
+
+    strs->strs = views;
+    strs->len = list->length;
+
+    return strs;
+}
+
+static uint64_t string_prefix(const PackedStringList *list, size_t index) {
+    String s;
+    packed_string_list_get(list, index, &s);
+
+    uint64_t prefix = 0;
+    size_t i;
+    for (i = 0; i < 8; i++) {
+        unsigned char c = i < s.len ? (unsigned char) s.chars[i] : 0;
+        prefix = (prefix << 8) | c;
+    }
+
+    return prefix;
+}
+
+static int compare_entries(const PackedStringList *list, const SortEntry *a, const SortEntry *b) {
+    if (a->prefix != b->prefix) {
+        return a->prefix < b->prefix ? -1 : 1;
+    }
+
+    /* same first 8 bytes (or zero padding that looks the same), compare it all */
+    String s1, s2;
+    packed_string_list_get(list, a->index, &s1);
+    packed_string_list_get(list, b->index, &s2);
+
+    size_t shortest_len = s1.len < s2.len ? s1.len : s2.len;
+    int diff = memcmp(s1.chars, s2.chars, shortest_len);
+    if (diff != 0) {
+        return diff;
+    }
+
+    return (s1.len > s2.len) - (s1.len < s2.len);
+}
+
+/* bottom up merge sort, stable */
+static void sort_entries(const PackedStringList *list, SortEntry *entries, SortEntry *tmp,
+                         size_t n) {
+    size_t width;
+    for (width = 1; width < n; width *= 2) {
+        size_t lo;
+        for (lo = 0; lo < n; lo += 2 * width) {
+            size_t mid = lo + width < n ? lo + width : n;
+            size_t hi = lo + 2 * width < n ? lo + 2 * width : n;
+
+            size_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                if (compare_entries(list, &entries[j], &entries[i]) < 0) {
+                    tmp[k++] = entries[j++];
+                } else {
+                    tmp[k++] = entries[i++];
+                }
+            }
+            while (i < mid) {
+                tmp[k++] = entries[i++];
+            }
+            while (j < hi) {
+                tmp[k++] = entries[j++];
+            }
+        }
+
+        memcpy(entries, tmp, n * sizeof(SortEntry));
+    }
+}
+
+int packed_string_list_sort(PackedStringList *list) {
+    if (list == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    TRACE_BEGIN("packed_string_list_sort");
+    size_t n = list->length;
+    SortEntry *entries = malloc(n * sizeof(SortEntry));
+    SortEntry *tmp = malloc(n * sizeof(SortEntry));
+    char *chars = malloc(list->chars_capacity);
+    void *offsets = malloc(list->offsets_capacity * (list->wide ? sizeof(uint64_t) : sizeof(uint32_t)));
+    if ((n > 0 && (entries == NULL || tmp == NULL)) || chars == NULL || offsets == NULL) {
+        free(entries);
+        free(tmp);
+        free(chars);
+        free(offsets);
+
+        TRACE_END();
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    size_t i;
+    for (i = 0; i < n; i++) {
+        entries[i].prefix = string_prefix(list, i);
+        entries[i].index = i;
+    }
+
+    sort_entries(list, entries, tmp, n);
+
+    /* lay the strings out again in sorted order, so the list stays one sequential buffer */
+    size_t written = 0;
+    for (i = 0; i < n; i++) {
+        String str;
+        packed_string_list_get(list, entries[i].index, &str);
+        memcpy(chars + written, str.chars, str.len);
+        written += str.len;
+
+        store_offset(offsets, list->wide, i + 1, written);
+    }
+    store_offset(offsets, list->wide, 0, 0);
+
+    void *old_offsets = list->offsets;
+    char *old_chars = list->chars;
+    list->offsets = offsets;
+    list->chars = chars;
+
+    free(old_offsets);
+    free(old_chars);
+    free(entries);
+    free(tmp);
+
+    TRACE_END();
+    return 0;
+}
+
+const char *packed_string_list_chars(const PackedStringList *list) {
+    if (list == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    return list->chars;
+}
+
+const void *packed_string_list_offsets(const PackedStringList *list, size_t *offset_size) {
+    if (list == NULL || offset_size == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    *offset_size = list->wide ? sizeof(uint64_t) : sizeof(uint32_t);
+    return list->offsets;
+}
+
+PackedStringList *create_packed_string_list_from_buffers(const char *chars, const void *offsets,
+                                                          size_t offset_size, size_t length) {
+    if (offsets == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    if (offset_size != sizeof(uint32_t) && offset_size != sizeof(uint64_t)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    int wide = offset_size == sizeof(uint64_t);
+    PackedStringList given;  /* just enough of a list for offset_at */
+    given.wide = wide;
+    given.offsets = (void *) offsets;
+
+    size_t i;
+    for (i = 0; i < length; i++) {
+        if (offset_at(&given, i + 1) < offset_at(&given, i)) {
+            errno = EINVAL;
+            return NULL;
+        }
+    }
+    if (offset_at(&given, 0) != 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    size_t bytes = offset_at(&given, length);
+    if (chars == NULL && bytes > 0) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    /* room for one more offset, like reserve keeps */
+    size_t offsets_capacity = length + 2 > 16 ? length + 2 : 16;
+    size_t chars_capacity = bytes > 256 ? bytes : 256;
+
+    PackedStringList *list = malloc(sizeof(PackedStringList));
+    void *offsets_copy = malloc(offsets_capacity * offset_size);
+    char *chars_copy = malloc(chars_capacity);
+    if (list == NULL || offsets_copy == NULL || chars_copy == NULL) {
+        free(list);
+        free(offsets_copy);
+        free(chars_copy);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    memcpy(offsets_copy, offsets, (length + 1) * offset_size);
+    if (bytes > 0) {
+        memcpy(chars_copy, chars, bytes);
+    }
+
+    list->length = length;
+    list->offsets_capacity = offsets_capacity;
+    list->wide = wide;
+    list->offsets = offsets_copy;
+    list->bytes = bytes;
+    list->chars_capacity = chars_capacity;
+    list->chars = chars_copy;
+
+    return list;
+}
@@ -0,0 +1,319 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <ilc/property.h>
+#include <ilc/test.h>
+
+#define MAX_OWNED 64  /* things one run may draw, draws past this return NULL */
+
+typedef struct {
+    void *ptr;
+    void (*release)(void *);
+} Owned;
+
+struct prop_source {
+    const unsigned char *bytes;
+    size_t size;
+    size_t used;  /* bytes drawn so far, where shrinking can cut the buffer */
+    int reporting;
+    Owned owned[MAX_OWNED];
+    size_t num_owned;
+};
+
+
+static void release_string(void *str) {
+    free_string(str);
+}
+
+static void release_string_list(void *list) {
+    StringList *l = list;
+    size_t i;
+    for (i = 0; i < l->len; i++) {
+        free(l->strs[i].chars);
+    }
+    free(l->strs);
+    free(l);
+}
+
+static void release_dynarray(void *arr) {
+    free_dynarray(arr);
+}
+
+/* hand ptr to src to free after the run, or free it now if src is full */
+static void *own(PropSource *src, void *ptr, void (*release)(void *)) {
+    if (ptr == NULL) {
+        return NULL;
+    }
+
+    if (src->num_owned == MAX_OWNED) {
+        release(ptr);
+        return NULL;
+    }
+
+    src->owned[src->num_owned].ptr = ptr;
+    src->owned[src->num_owned].release = release;
+    src->num_owned++;
+
+    return ptr;
+}
+
+/* run property on bytes, returns 1 if it held and sets *used to the bytes it drew */
+static int run_once(property_fn property, const unsigned char *bytes, size_t size, int reporting, size_t *used) {
+    PropSource src;
+    src.bytes = bytes;
+    src.size = size;
+    src.used = 0;
+    src.reporting = reporting;
+    src.num_owned = 0;
+
+    int held = property(&src) != 0;
+
+    size_t i;
+    for (i = src.num_owned; i > 0; i--) {
+        src.owned[i - 1].release(src.owned[i - 1].ptr);
+    }
+
+    if (used != NULL) {
+        *used = src.used < size ? src.used : size;
+    }
+
+    return held;
+}
+
+int run_property_on_bytes(property_fn property, const unsigned char *data, size_t size) {
+    return run_once(property, data, size, 0, NULL);
+}
+
+int prop_reporting(const PropSource *src) {
+    return src->reporting;
+}
+
+unsigned long long draw_uint(PropSource *src, unsigned long long max) {
+    unsigned long long value = 0;
+    unsigned long long range = max;
+    while (range > 0) {
+        unsigned char byte = src->used < src->size ? src->bytes[src->used] : 0;
+        src->used++;
+
+        value = (value << 8) | byte;
+        range >>= 8;
+    }
+
+    /* max + 1 wraps to 0 for the full range, which needs no reducing */
+    return max == ~0ULL ? value : value % (max + 1);
+}
+
+char draw_char(PropSource *src, const char *alphabet) {
+    if (alphabet == NULL || alphabet[0] == '\0') {
+        return (char) draw_uint(src, 255);
+    }
+
+    return alphabet[draw_uint(src, strlen(alphabet) - 1)];
+}
+
+/* like draw_string, but owned by the caller */
+static String *make_string(PropSource *src, size_t max_len, const char *alphabet) {
+    size_t len = draw_uint(src, max_len);
+    char *chars = malloc(len > 0 ? len : 1);
+    if (chars == NULL) {
+        return NULL;
+    }
+
+    size_t i;
+    for (i = 0; i < len; i++) {
+        chars[i] = draw_char(src, alphabet);
+    }
+
+    String *str = create_string(chars, len);
+    free(chars);
+
+    return str;
+}
+
+String *draw_string(PropSource *src, size_t max_len, const char *alphabet) {
+    return own(src, make_string(src, max_len, alphabet), release_string);
+}
+
+StringList *draw_string_list(PropSource *src, size_t max_strings, size_t max_len, const char *alphabet) {
+    size_t len = draw_uint(src, max_strings);
+    StringList *list = malloc(sizeof(StringList));
+    String *strs = malloc((len > 0 ? len : 1) * sizeof(String));
+    if (list == NULL || strs == NULL) {
+        free(list);
+        free(strs);
+        return NULL;
+    }
+
+    list->strs = strs;
+    list->len = 0;
+
+    size_t i;
+    for (i = 0; i < len; i++) {
+        String *str = make_string(src, max_len, alphabet);
+        if (str == NULL) {
+            release_string_list(list);
+            return NULL;
+        }
+
+        strs[i] = *str;
+        free(str);  /* the chars now belong to the list */
+        list->len++;
+    }
+
+    return own(src, list, release_string_list);
+}
+
+DynArray *draw_int_dynarray(PropSource *src, size_t max_len, int max_value) {
+    size_t len = draw_uint(src, max_len);
+    DynArray *arr = create_dynarray(sizeof(int));
+    if (arr == NULL) {
+        return NULL;
+    }
+
+    size_t i;
+    for (i = 0; i < len; i++) {
+        int value = (int) draw_uint(src, max_value > 0 ? (unsigned long long) max_value : 0);
+        if (dynarray_append(arr, &value) != 0) {
+            free_dynarray(arr);
+            return NULL;
+        }
+    }
+
+    return own(src, arr, release_dynarray);
+}
+
+/* splitmix64, enough to fill buffers with bytes that look random */
+static uint64_t next_random(uint64_t *state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* does property still fail on bytes, and if so cut them to what it drew */
+static int still_fails(property_fn property, unsigned char *bytes, size_t *size, unsigned int *attempts) {
+    size_t used;
+    (*attempts)++;
+    if (run_once(property, bytes, *size, 0, &used)) {
+        return 0;
+    }
+
+    *size = used;
+    return 1;
+}
+
+/*
+ * Make a failing input smaller while it keeps failing: delete chunks of 8, 4,
+ * 2, and 1 bytes, then lower each byte (to 0, half, or one less), until a
+ * whole pass changes nothing. Fewer and smaller bytes mean shorter lengths and
+ * earlier alphabet chars from the draw_ functions.
+ *
+ * Returns: the number of changes kept.
+ */
+static unsigned int shrink(property_fn property, unsigned char *bytes, size_t *size) {
+    unsigned char *candidate = malloc(*size > 0 ? *size : 1);
+    if (candidate == NULL) {
+        return 0;
+    }
+
+    unsigned int attempts = 0, steps = 0;
+    int changed = 1;
+    while (changed && attempts < PROP_SHRINK_ATTEMPTS) {
+        changed = 0;
+
+        size_t chunk;
+        for (chunk = 8; chunk > 0; chunk /= 2) {
+            size_t i = 0;
+            while (i + chunk <= *size && attempts < PROP_SHRINK_ATTEMPTS) {
+                size_t candidate_size = *size - chunk;
+                memcpy(candidate, bytes, i);
+                memcpy(candidate + i, bytes + i + chunk, candidate_size - i);
+
+                if (still_fails(property, candidate, &candidate_size, &attempts)) {
+                    memcpy(bytes, candidate, candidate_size);
+                    *size = candidate_size;
+                    changed = 1;
+                    steps++;
+                } else {
+                    i++;
+                }
+            }
+        }
+
+        size_t i;
+        for (i = 0; i < *size && attempts < PROP_SHRINK_ATTEMPTS; i++) {
+            unsigned char lower[3] = {0, bytes[i] / 2, bytes[i] - 1};
+            int j;
+            for (j = 0; j < 3 && bytes[i] > 0; j++) {
+                size_t candidate_size = *size;
+                memcpy(candidate, bytes, *size);
+                candidate[i] = lower[j];
+
+                if (still_fails(property, candidate, &candidate_size, &attempts)) {
+                    memcpy(bytes, candidate, candidate_size);
+                    *size = candidate_size;
+                    changed = 1;
+                    steps++;
+                    break;
+                }
+            }
+        }
+    }
+
+    free(candidate);
+    return steps;
+}
+
+int check_property(const char *name, property_fn property, unsigned int runs, int verbose) {
+    const char *seed_env = getenv(PROP_SEED_ENV);
+    unsigned long seed = seed_env != NULL ? strtoul(seed_env, NULL, 10) : (unsigned long) time(NULL) ^ (unsigned long) clock();
+
+    const char *runs_env = getenv(PROP_RUNS_ENV);
+    if (runs_env != NULL) {
+        runs = (unsigned int) strtoul(runs_env, NULL, 10);
+    }
+
+    unsigned char *bytes = malloc(PROP_MAX_BYTES);
+    if (bytes == NULL) {
+        fprintf(stderr, "check_property: failed to allocate input bytes (malloc failed)\n");
+        return FAILURE;
+    }
+
+    uint64_t state = seed;
+    unsigned int run;
+    for (run = 0; run < runs; run++) {
+        /* small inputs first, since the bytes running out draws the smallest values */
+        size_t size = (size_t) PROP_MAX_BYTES * (run + 1) / runs;
+        size_t i;
+        for (i = 0; i < size; i++) {
+            bytes[i] = (unsigned char) next_random(&state);
+        }
+
+        size_t used;
+        if (run_once(property, bytes, size, 0, &used)) {
+            continue;
+        }
+
+        size = used;
+        size_t original_size = size;
+        unsigned int steps = shrink(property, bytes, &size);
+
+        printf("    %s " COLOR_TEXT(RED, "violated") " on run %u of %u (" PROP_SEED_ENV "=%lu)\n",
+               name, run + 1, runs, seed);
+        printf("    shrunk from %lu to %lu input bytes in %u steps, smallest failing input:\n",
+               original_size, size, steps);
+        run_once(property, bytes, size, 1, NULL);
+
+        free(bytes);
+        return FAILURE;
+    }
+
+    if (verbose) {
+        printf("    %s " COLOR_TEXT(GREEN, "held") " for %u inputs (" PROP_SEED_ENV "=%lu)\n", name, runs, seed);
+    }
+
+    free(bytes);
+    return SUCCESS;
+}
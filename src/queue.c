@@ -0,0 +1,341 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/queue.h>
+#include <ilc/alloc.h>
+
+/*
+ * Indices in both queues count up forever (they would take centuries to
+ * wrap) and are masked to find a slot. Each group of fields written by one
+ * side is padded onto its own cache line.
+ */
+
+struct spsc_queue {
+    char pad0[QUEUE_CACHE_LINE];
+    size_t tail;  /* next slot to push, written by the producer */
+    size_t cached_head;  /* producer's copy of head */
+    char pad1[QUEUE_CACHE_LINE];
+    size_t head;  /* next slot to pop, written by the consumer */
+    size_t cached_tail;  /* consumer's copy of tail */
+    char pad2[QUEUE_CACHE_LINE];
+    size_t mask;  /* capacity - 1 */
+    size_t item_size;
+    char *items;
+};
+
+typedef struct {
+    size_t sequence;  /* position when ready to push, position + 1 when ready to pop */
+    /* item_size bytes of item follow, padded so each cell's sequence is aligned */
+} MpmcCell;
+
+struct mpmc_queue {
+    char pad0[QUEUE_CACHE_LINE];
+    size_t tail;  /* next position to push, claimed with CAS */
+    char pad1[QUEUE_CACHE_LINE];
+    size_t head;  /* next position to pop, claimed with CAS */
+    char pad2[QUEUE_CACHE_LINE];
+    size_t mask;
+    size_t item_size;
+    size_t cell_size;
+    char *cells;
+};
+
+static size_t round_up_pow2(size_t n) {
+    size_t capacity = 1;
+    while (capacity < n) {
+        capacity *= 2;
+    }
+
+    return capacity;
+}
+
+SpscQueue *create_spsc_queue(size_t item_size, size_t capacity) {
+    if (capacity == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    capacity = round_up_pow2(capacity);
+
+    SpscQueue *queue = malloc(sizeof(SpscQueue));
+    char *items = malloc(capacity * item_size);
+    if (queue == NULL || items == NULL) {
+        free(queue);
+        free(items);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    queue->tail = 0;
+    queue->cached_head = 0;
+    queue->head = 0;
+    queue->cached_tail = 0;
+    queue->mask = capacity - 1;
+    queue->item_size = item_size;
+    queue->items = items;
+
+    return queue;
+}
+
+void free_spsc_queue(SpscQueue *queue) {
+    if (queue == NULL) {
+        return;
+    }
+
+    free(queue->items);
+    free(queue);
+}
+
+/* copy count items between the ring (starting at position) and a flat array, wrapping as needed */
+static void ring_copy(char *ring, size_t mask, size_t item_size, size_t position, char *flat,
+                      size_t count, int to_ring) {
+    size_t start = position & mask;
+    size_t first_part = mask + 1 - start;
+    if (first_part > count) {
+        first_part = count;
+    }
+
+    char *slot = ring + start * item_size;
+    if (to_ring) {
+        memcpy(slot, flat, first_part * item_size);
+        memcpy(ring, flat + first_part * item_size, (count - first_part) * item_size);
+    } else {
+        memcpy(flat, slot, first_part * item_size);
+        memcpy(flat + first_part * item_size, ring, (count - first_part) * item_size);
+    }
+}
+
+size_t spsc_queue_push_batch(SpscQueue *queue, const void *items, size_t count) {
+    if (queue == NULL || items == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    size_t tail = queue->tail;
+    size_t capacity = queue->mask + 1;
+    if (tail - queue->cached_head + count > capacity) {
+        queue->cached_head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    }
+
+    size_t free_slots = capacity - (tail - queue->cached_head);
+    if (count > free_slots) {
+        count = free_slots;
+    }
+
+    ring_copy(queue->items, queue->mask, queue->item_size, tail, (char *) items, count, 1);
+    __atomic_store_n(&queue->tail, tail + count, __ATOMIC_RELEASE);
+
+    return count;
+}
+
+size_t spsc_queue_pop_batch(SpscQueue *queue, void *items, size_t max_count) {
+    if (queue == NULL || items == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    size_t head = queue->head;
+    if (queue->cached_tail - head < max_count) {
+        queue->cached_tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    }
+
+    size_t count = queue->cached_tail - head;
+    if (count > max_count) {
+        count = max_count;
+    }
+
+    ring_copy(queue->items, queue->mask, queue->item_size, head, items, count, 0);
+    __atomic_store_n(&queue->head, head + count, __ATOMIC_RELEASE);
+
+    return count;
+}
+
+int spsc_queue_push(SpscQueue *queue, const void *item) {
+    if (queue == NULL || item == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (spsc_queue_push_batch(queue, item, 1) == 0) {
+        errno = EAGAIN;
+        return EAGAIN;
+    }
+
+    return 0;
+}
+
+int spsc_queue_pop(SpscQueue *queue, void *item) {
+    if (queue == NULL || item == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (spsc_queue_pop_batch(queue, item, 1) == 0) {
+        errno = EAGAIN;
+        return EAGAIN;
+    }
+
+    return 0;
+}
+
+MpmcQueue *create_mpmc_queue(size_t item_size, size_t capacity) {
+    if (capacity == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    capacity = round_up_pow2(capacity);
+
+    /* round cells up to a multiple of the sequence's size so every sequence is aligned */
+    size_t cell_size = sizeof(MpmcCell) + item_size;
+    cell_size = (cell_size + sizeof(size_t) - 1) / sizeof(size_t) * sizeof(size_t);
+
+    MpmcQueue *queue = malloc(sizeof(MpmcQueue));
+    char *cells = malloc(capacity * cell_size);
+    if (queue == NULL || cells == NULL) {
+        free(queue);
+        free(cells);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size_t i;
+    for (i = 0; i < capacity; i++) {
+        ((MpmcCell *) (cells + i * cell_size))->sequence = i;
+    }
+
+    queue->tail = 0;
+    queue->head = 0;
+    queue->mask = capacity - 1;
+    queue->item_size = item_size;
+    queue->cell_size = cell_size;
+    queue->cells = cells;
+
+    return queue;
+}
+
+void free_mpmc_queue(MpmcQueue *queue) {
+    if (queue == NULL) {
+        return;
+    }
+
+    free(queue->cells);
+    free(queue);
+}
+
+static MpmcCell *cell_at(const MpmcQueue *queue, size_t position) {
+    return (MpmcCell *) (queue->cells + (position & queue->mask) * queue->cell_size);
+}
+
+static char *cell_item(MpmcCell *cell) {
+    return (char *) (cell + 1);
+}
+
+/*
+ * Claim up to count positions from *index (tail for pushes, head for pops).
+ * A cell at position p is ready when its sequence is p + ready_offset (0 for
+ * pushes, 1 for pops). Only the run of ready cells from the current index is
+ * claimed, so the claim succeeds for as many as are ready right now.
+ */
+static size_t claim(MpmcQueue *queue, size_t *index, size_t count, size_t ready_offset,
+                    size_t *position) {
+    if (count == 0) {
+        return 0;  /* nothing would ever be ready, so the loop below would spin */
+    }
+
+    size_t pos = __atomic_load_n(index, __ATOMIC_RELAXED);
+    for (;;) {
+        size_t ready = 0;
+        while (ready < count) {
+            size_t sequence = __atomic_load_n(&cell_at(queue, pos + ready)->sequence, __ATOMIC_ACQUIRE);
+            if (sequence != pos + ready + ready_offset) {
+                break;
+            }
+            ready++;
+        }
+
+        if (ready == 0) {
+            size_t sequence = __atomic_load_n(&cell_at(queue, pos)->sequence, __ATOMIC_ACQUIRE);
+            if ((long) (sequence - (pos + ready_offset)) < 0) {
+                return 0;  /* a lap behind, so the queue is full (push) or empty (pop) */
+            }
+
+            pos = __atomic_load_n(index, __ATOMIC_RELAXED);  /* another thread got here first */
+            continue;
+        }
+
+        if (__atomic_compare_exchange_n(index, &pos, pos + ready, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            *position = pos;
+            return ready;
+        }
+    }
+}
+
+size_t mpmc_queue_push_batch(MpmcQueue *queue, const void *items, size_t count) {
+    if (queue == NULL || items == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    size_t position;
+    size_t claimed = claim(queue, &queue->tail, count, 0, &position);
+
+    size_t i;
+    for (i = 0; i < claimed; i++) {
+        MpmcCell *cell = cell_at(queue, position + i);
+        memcpy(cell_item(cell), (const char *) items + i * queue->item_size, queue->item_size);
+        __atomic_store_n(&cell->sequence, position + i + 1, __ATOMIC_RELEASE);
+    }
+
+    return claimed;
+}
+
+size_t mpmc_queue_pop_batch(MpmcQueue *queue, void *items, size_t max_count) {
+    if (queue == NULL || items == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    size_t position;
+    size_t claimed = claim(queue, &queue->head, max_count, 1, &position);
+
+    size_t i;
+    for (i = 0; i < claimed; i++) {
+        MpmcCell *cell = cell_at(queue, position + i);
+        memcpy((char *) items + i * queue->item_size, cell_item(cell), queue->item_size);
+        __atomic_store_n(&cell->sequence, position + i + queue->mask + 1, __ATOMIC_RELEASE);
+    }
+
+    return claimed;
+}
+
+int mpmc_queue_push(MpmcQueue *queue, const void *item) {
+    if (queue == NULL || item == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (mpmc_queue_push_batch(queue, item, 1) == 0) {
+        errno = EAGAIN;
+        return EAGAIN;
+    }
+
+    return 0;
+}
+
+int mpmc_queue_pop(MpmcQueue *queue, void *item) {
+    if (queue == NULL || item == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (mpmc_queue_pop_batch(queue, item, 1) == 0) {
+        errno = EAGAIN;
+        return EAGAIN;
+    }
+
+    return 0;
+}
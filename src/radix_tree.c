@@ -0,0 +1,676 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/radix_tree.h>
+#include <ilc/alloc.h>
+
+enum node_type { NODE4, NODE16, NODE48, NODE256 };
+
+typedef struct {
+    unsigned char type;
+    unsigned char has_value;  /* some key ends exactly at this node */
+    unsigned short num_children;
+    size_t prefix_len;
+    unsigned char *prefix;  /* compressed path below the parent's child byte */
+    void *value;
+} Node;
+
+typedef struct {
+    Node n;
+    unsigned char keys[4];  /* sorted */
+    Node *children[4];
+} Node4;
+
+typedef struct {
+    Node n;
+    unsigned char keys[16];  /* sorted */
+    Node *children[16];
+} Node16;
+
+typedef struct {
+    Node n;
+    unsigned char index[256];  /* 0 for no child, otherwise slot + 1 */
+    Node *children[48];
+} Node48;
+
+typedef struct {
+    Node n;
+    Node *children[256];
+} Node256;
+
+struct radix_tree {
+    Node *root;
+    size_t length;
+};
+
+typedef struct {
+    unsigned char *chars;
+    size_t len;
+    size_t capacity;
+} KeyBuffer;
+
+static const unsigned char *key_bytes(const String *s) {
+    return (const unsigned char *)s->chars;
+}
+
+static Node *alloc_node(enum node_type type) {
+    size_t size;
+    switch (type) {
+        case NODE4: size = sizeof(Node4); break;
+        case NODE16: size = sizeof(Node16); break;
+        case NODE48: size = sizeof(Node48); break;
+        default: size = sizeof(Node256); break;
+    }
+
+    Node *node = calloc(1, size);
+    if (node != NULL) {
+        node->type = (unsigned char) type;
+    }
+
+    return node;
+}
+
+static int set_prefix(Node *node, const unsigned char *prefix, size_t len) {
+    unsigned char *copy = NULL;
+
+    if (len > 0) {
+        copy = malloc(len);
+        if (copy == NULL) {
+            return ENOMEM;
+        }
+        memcpy(copy, prefix, len);
+    }
+
+    free(node->prefix);
+    node->prefix = copy;
+    node->prefix_len = len;
+
+    return 0;
+}
+
+static Node *create_leaf(const unsigned char *suffix, size_t len, void *value) {
+    Node *leaf = alloc_node(NODE4);
+    if (leaf == NULL) {
+        return NULL;
+    }
+
+    if (set_prefix(leaf, suffix, len) != 0) {
+        free(leaf);
+        return NULL;
+    }
+
+    leaf->has_value = 1;
+    leaf->value = value;
+
+    return leaf;
+}
+
+static void free_node(Node *node) {
+    if (node == NULL) {
+        return;
+    }
+
+    int i;
+    switch (node->type) {
+        case NODE4:
+            for (i = 0; i < node->num_children; i++) {
+                free_node(((Node4 *)node)->children[i]);
+            }
+            break;
+        case NODE16:
+            for (i = 0; i < node->num_children; i++) {
+                free_node(((Node16 *)node)->children[i]);
+            }
+            break;
+        case NODE48:
+            for (i = 0; i < node->num_children; i++) {
+                free_node(((Node48 *)node)->children[i]);
+            }
+            break;
+        default:
+            for (i = 0; i < 256; i++) {
+                free_node(((Node256 *)node)->children[i]);
+            }
+            break;
+    }
+
+    free(node->prefix);
+    free(node);
+}
+
+static Node **find_child(Node *node, unsigned char byte) {
+    int i;
+    switch (node->type) {
+        case NODE4: {
+            Node4 *n4 = (Node4 *)node;
+            for (i = 0; i < node->num_children; i++) {
+                if (n4->keys[i] == byte) {
+                    return &n4->children[i];
+                }
+            }
+            return NULL;
+        }
+        case NODE16: {
+            Node16 *n16 = (Node16 *)node;
+            for (i = 0; i < node->num_children && n16->keys[i] <= byte; i++) {
+                if (n16->keys[i] == byte) {
+                    return &n16->children[i];
+                }
+            }
+            return NULL;
+        }
+        case NODE48: {
+            Node48 *n48 = (Node48 *)node;
+            if (n48->index[byte] == 0) {
+                return NULL;
+            }
+            return &n48->children[n48->index[byte] - 1];
+        }
+        default: {
+            Node256 *n256 = (Node256 *)node;
+            return n256->children[byte] == NULL ? NULL : &n256->children[byte];
+        }
+    }
+}
+
+/* copy the shared header into a bigger node, taking ownership of the prefix */
+static void move_header(Node *dest, const Node *src) {
+    dest->has_value = src->has_value;
+    dest->num_children = src->num_children;
+    dest->prefix_len = src->prefix_len;
+    dest->prefix = src->prefix;
+    dest->value = src->value;
+}
+
+static Node *grow(Node *node) {
+    int i;
+    switch (node->type) {
+        case NODE4: {
+            Node4 *n4 = (Node4 *)node;
+            Node16 *n16 = (Node16 *)alloc_node(NODE16);
+            if (n16 == NULL) {
+                return NULL;
+            }
+            move_header(&n16->n, node);
+            memcpy(n16->keys, n4->keys, sizeof(n4->keys));
+            memcpy(n16->children, n4->children, sizeof(n4->children));
+            free(node);
+            return &n16->n;
+        }
+        case NODE16: {
+            Node16 *n16 = (Node16 *)node;
+            Node48 *n48 = (Node48 *)alloc_node(NODE48);
+            if (n48 == NULL) {
+                return NULL;
+            }
+            move_header(&n48->n, node);
+            for (i = 0; i < 16; i++) {
+                n48->index[n16->keys[i]] = (unsigned char) (i + 1);
+                n48->children[i] = n16->children[i];
+            }
+            free(node);
+            return &n48->n;
+        }
+        default: {
+            Node48 *n48 = (Node48 *)node;
+            Node256 *n256 = (Node256 *)alloc_node(NODE256);
+            if (n256 == NULL) {
+                return NULL;
+            }
+            move_header(&n256->n, node);
+            for (i = 0; i < 256; i++) {
+                if (n48->index[i] != 0) {
+                    n256->children[i] = n48->children[n48->index[i] - 1];
+                }
+            }
+            free(node);
+            return &n256->n;
+        }
+    }
+}
+
+static int is_full(const Node *node) {
+    switch (node->type) {
+        case NODE4: return node->num_children == 4;
+        case NODE16: return node->num_children == 16;
+        case NODE48: return node->num_children == 48;
+        default: return 0;
+    }
+}
+
+/* adds a child under byte (which must not be present), growing *ref if needed */
+static int add_child(Node **ref, unsigned char byte, Node *child) {
+    Node *node = *ref;
+
+    if (is_full(node)) {
+        node = grow(node);
+        if (node == NULL) {
+            return ENOMEM;
+        }
+        *ref = node;
+    }
+
+    int i;
+    switch (node->type) {
+        case NODE4:
+        case NODE16: {
+            unsigned char *keys = node->type == NODE4 ? ((Node4 *)node)->keys : ((Node16 *)node)->keys;
+            Node **children = node->type == NODE4 ? ((Node4 *)node)->children : ((Node16 *)node)->children;
+
+            /* keep keys sorted so iteration is in order */
+            for (i = node->num_children; i > 0 && keys[i - 1] > byte; i--) {
+                keys[i] = keys[i - 1];
+                children[i] = children[i - 1];
+            }
+            keys[i] = byte;
+            children[i] = child;
+            break;
+        }
+        case NODE48: {
+            Node48 *n48 = (Node48 *)node;
+            n48->children[node->num_children] = child;
+            n48->index[byte] = (unsigned char) (node->num_children + 1);
+            break;
+        }
+        default:
+            ((Node256 *)node)->children[byte] = child;
+            break;
+    }
+
+    node->num_children++;
+    return 0;
+}
+
+static size_t common_prefix_len(const Node *node, const unsigned char *key, size_t key_len) {
+    size_t max = node->prefix_len < key_len ? node->prefix_len : key_len;
+
+    size_t i = 0;
+    while (i < max && node->prefix[i] == key[i]) {
+        i++;
+    }
+
+    return i;
+}
+
+/* splits node's prefix after p bytes by putting a new Node4 above it */
+static int split_node(Node **ref, size_t p) {
+    Node *node = *ref;
+    Node *parent = alloc_node(NODE4);
+    if (parent == NULL) {
+        return ENOMEM;
+    }
+
+    if (set_prefix(parent, node->prefix, p) != 0) {
+        free(parent);
+        return ENOMEM;
+    }
+
+    unsigned char byte = node->prefix[p];
+    size_t rest_len = node->prefix_len - p - 1;
+    unsigned char *rest = NULL;
+
+    if (rest_len > 0) {
+        rest = malloc(rest_len);
+        if (rest == NULL) {
+            free_node(parent);
+            return ENOMEM;
+        }
+        memcpy(rest, node->prefix + p + 1, rest_len);
+    }
+
+    free(node->prefix);
+    node->prefix = rest;
+    node->prefix_len = rest_len;
+
+    ((Node4 *)parent)->keys[0] = byte;
+    ((Node4 *)parent)->children[0] = node;
+    parent->num_children = 1;
+
+    *ref = parent;
+    return 0;
+}
+
+static int insert(Node **ref, const unsigned char *key, size_t key_len, void *value, int *added) {
+    for (;;) {
+        Node *node = *ref;
+
+        if (node == NULL) {
+            *ref = create_leaf(key, key_len, value);
+            if (*ref == NULL) {
+                return ENOMEM;
+            }
+            *added = 1;
+            return 0;
+        }
+
+        size_t p = common_prefix_len(node, key, key_len);
+
+        if (p < node->prefix_len) {
+            if (split_node(ref, p) != 0) {
+                return ENOMEM;
+            }
+            node = *ref;
+        }
+
+        key += p;
+        key_len -= p;
+
+        if (key_len == 0) {
+            *added = !node->has_value;
+            node->has_value = 1;
+            node->value = value;
+            return 0;
+        }
+
+        Node **child = find_child(node, key[0]);
+        if (child == NULL) {
+            Node *leaf = create_leaf(key + 1, key_len - 1, value);
+            if (leaf == NULL) {
+                return ENOMEM;
+            }
+
+            if (add_child(ref, key[0], leaf) != 0) {
+                free_node(leaf);
+                return ENOMEM;
+            }
+
+            *added = 1;
+            return 0;
+        }
+
+        ref = child;
+        key++;
+        key_len--;
+    }
+}
+
+RadixTree *create_radix_tree(void) {
+    RadixTree *tree = malloc(sizeof(RadixTree));
+
+    if (tree == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    tree->root = NULL;
+    tree->length = 0;
+
+    return tree;
+}
+
+void free_radix_tree(RadixTree *tree) {
+    if (tree == NULL) {
+        return;
+    }
+
+    free_node(tree->root);
+    free(tree);
+}
+
+int radix_tree_insert(RadixTree *tree, const String *key, void *value) {
+    if (tree == NULL || key == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    int added = 0;
+    if (insert(&tree->root, key_bytes(key), key->len, value, &added) != 0) {
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    tree->length += added;
+    return 0;
+}
+
+int radix_tree_insert_all(RadixTree *tree, const StringList *keys, void **values) {
+    if (tree == NULL || keys == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    size_t i;
+    for (i = 0; i < keys->len; i++) {
+        int result = radix_tree_insert(tree, &keys->strs[i], values == NULL ? NULL : values[i]);
+        if (result != 0) {
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+int radix_tree_get(const RadixTree *tree, const String *key, void **value) {
+    if (tree == NULL || key == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    const unsigned char *k = key_bytes(key);
+    size_t len = key->len;
+    Node *node = tree->root;
+
+    while (node != NULL) {
+        if (common_prefix_len(node, k, len) != node->prefix_len) {
+            return 0;
+        }
+
+        k += node->prefix_len;
+        len -= node->prefix_len;
+
+        if (len == 0) {
+            if (node->has_value && value != NULL) {
+                *value = node->value;
+            }
+            return node->has_value;
+        }
+
+        Node **child = find_child(node, k[0]);
+        node = child == NULL ? NULL : *child;
+        k++;
+        len--;
+    }
+
+    return 0;
+}
+
+int radix_tree_longest_prefix(const RadixTree *tree, const String *str, size_t *prefix_len,
+                              void **value) {
+    if (tree == NULL || str == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    const unsigned char *k = key_bytes(str);
+    size_t len = str->len;
+    Node *node = tree->root;
+    int found = 0;
+
+    while (node != NULL) {
+        if (common_prefix_len(node, k, len) != node->prefix_len) {
+            break;
+        }
+
+        k += node->prefix_len;
+        len -= node->prefix_len;
+
+        if (node->has_value) {
+            found = 1;
+            if (prefix_len != NULL) {
+                *prefix_len = str->len - len;
+            }
+            if (value != NULL) {
+                *value = node->value;
+            }
+        }
+
+        if (len == 0) {
+            break;
+        }
+
+        Node **child = find_child(node, k[0]);
+        node = child == NULL ? NULL : *child;
+        k++;
+        len--;
+    }
+
+    return found;
+}
+
+static int key_buffer_push(KeyBuffer *buf, const unsigned char *bytes, size_t len) {
+    if (len == 0) {
+        return 0;
+    }
+
+    if (buf->len + len > buf->capacity) {
+        size_t capacity = buf->capacity == 0 ? 64 : buf->capacity;
+        while (capacity < buf->len + len) {
+            capacity *= 2;
+        }
+
+        unsigned char *p = realloc(buf->chars, capacity);
+        if (p == NULL) {
+            return ENOMEM;
+        }
+
+        buf->chars = p;
+        buf->capacity = capacity;
+    }
+
+    memcpy(buf->chars + buf->len, bytes, len);
+    buf->len += len;
+
+    return 0;
+}
+
+/* returns children in byte order, *pos starts at 0 and NULL means no more children */
+static const Node *next_child(const Node *node, int *pos, unsigned char *byte) {
+    switch (node->type) {
+        case NODE4:
+        case NODE16: {
+            if (*pos >= node->num_children) {
+                return NULL;
+            }
+
+            int i = (*pos)++;
+            if (node->type == NODE4) {
+                *byte = ((const Node4 *)node)->keys[i];
+                return ((const Node4 *)node)->children[i];
+            }
+            *byte = ((const Node16 *)node)->keys[i];
+            return ((const Node16 *)node)->children[i];
+        }
+        case NODE48: {
+            const Node48 *n48 = (const Node48 *)node;
+            while (*pos < 256) {
+                int b = (*pos)++;
+                if (n48->index[b] != 0) {
+                    *byte = (unsigned char) b;
+                    return n48->children[n48->index[b] - 1];
+                }
+            }
+            return NULL;
+        }
+        default: {
+            const Node256 *n256 = (const Node256 *)node;
+            while (*pos < 256) {
+                int b = (*pos)++;
+                if (n256->children[b] != NULL) {
+                    *byte = (unsigned char) b;
+                    return n256->children[b];
+                }
+            }
+            return NULL;
+        }
+    }
+}
+
+/* 0 to keep going, 1 if visit asked to stop, ENOMEM on failure */
+static int visit_subtree(const Node *node, KeyBuffer *buf, radix_visit_fn visit, void *ctx) {
+    size_t saved_len = buf->len;
+
+    if (key_buffer_push(buf, node->prefix, node->prefix_len) != 0) {
+        return ENOMEM;
+    }
+
+    int result = 0;
+    if (node->has_value) {
+        String key;
+        key.chars = (char *)buf->chars;
+        key.len = buf->len;
+
+        result = visit(&key, node->value, ctx) != 0;
+    }
+
+    int pos = 0;
+    unsigned char byte;
+    const Node *child;
+    while (result == 0 && (child = next_child(node, &pos, &byte)) != NULL) {
+        if (key_buffer_push(buf, &byte, 1) != 0) {
+            return ENOMEM;
+        }
+        result = visit_subtree(child, buf, visit, ctx);
+        buf->len--;
+    }
+
+    buf->len = saved_len;
+    return result;
+}
+
+int radix_tree_iterate_prefix(const RadixTree *tree, const String *prefix, radix_visit_fn visit,
+                              void *ctx) {
+    if (tree == NULL || prefix == NULL || visit == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    KeyBuffer buf = {NULL, 0, 0};
+    const unsigned char *k = key_bytes(prefix);
+    size_t len = prefix->len;
+    const Node *node = tree->root;
+
+    /* walk down until the prefix is used up, collecting the path into buf */
+    while (node != NULL) {
+        size_t p = common_prefix_len(node, k, len);
+
+        if (p == len) {
+            break;  /* prefix ends within (or right after) this node's segment */
+        }
+
+        if (p < node->prefix_len) {
+            node = NULL;  /* diverged */
+            break;
+        }
+
+        if (key_buffer_push(&buf, node->prefix, node->prefix_len) != 0 ||
+            key_buffer_push(&buf, k + p, 1) != 0) {
+            free(buf.chars);
+            errno = ENOMEM;
+            return ENOMEM;
+        }
+
+        Node **child = find_child((Node *)node, k[p]);
+        node = child == NULL ? NULL : *child;
+        k += p + 1;
+        len -= p + 1;
+    }
+
+    int result = node == NULL ? 0 : visit_subtree(node, &buf, visit, ctx);
+    free(buf.chars);
+
+    if (result == ENOMEM) {
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    return 0;
+}
+
+size_t radix_tree_length(const RadixTree *tree) {
+    if (tree == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return tree->length;
+}
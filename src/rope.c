@@ -0,0 +1,505 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/rope.h>
+#include <ilc/alloc.h>
+
+/* leaves have chars and no children, inner nodes have two children and no chars */
+typedef struct rope_node {
+    struct rope_node *left;
+    struct rope_node *right;
+    size_t len;  /* chars under this node */
+    int height;  /* leaves are 1 */
+    char *chars;
+} RopeNode;
+
+/*
+ * Split and join never fail: the nodes they need are set aside before an
+ * edit starts (see reserve_nodes), so an edit either fails with ENOMEM before
+ * changing anything or runs to completion.
+ */
+struct rope {
+    RopeNode *root;
+    RopeNode *spare_inner;  /* linked through left */
+    size_t num_spare_inner;
+    RopeNode *spare_leaves;
+    size_t num_spare_leaves;
+};
+
+static int height(const RopeNode *node) {
+    return node == NULL ? 0 : node->height;
+}
+
+static int is_leaf(const RopeNode *node) {
+    return node->chars != NULL;
+}
+
+static RopeNode *take_inner(Rope *rope) {
+    RopeNode *node = rope->spare_inner;
+    rope->spare_inner = node->left;
+    rope->num_spare_inner--;
+    return node;
+}
+
+static void give_inner(Rope *rope, RopeNode *node) {
+    node->left = rope->spare_inner;
+    rope->spare_inner = node;
+    rope->num_spare_inner++;
+}
+
+static RopeNode *take_leaf(Rope *rope) {
+    RopeNode *node = rope->spare_leaves;
+    rope->spare_leaves = node->left;
+    rope->num_spare_leaves--;
+
+    node->left = NULL;
+    node->right = NULL;
+    node->len = 0;
+    node->height = 1;
+    return node;
+}
+
+static void give_leaf(Rope *rope, RopeNode *node) {
+    node->left = rope->spare_leaves;
+    rope->spare_leaves = node;
+    rope->num_spare_leaves++;
+}
+
+static int reserve_nodes(Rope *rope, size_t num_inner, size_t num_leaves) {
+    while (rope->num_spare_inner < num_inner) {
+        RopeNode *node = malloc(sizeof(RopeNode));
+        if (node == NULL) {
+            return ENOMEM;
+        }
+
+        node->chars = NULL;
+        give_inner(rope, node);
+    }
+
+    while (rope->num_spare_leaves < num_leaves) {
+        RopeNode *node = malloc(sizeof(RopeNode));
+        char *chars = malloc(ROPE_LEAF_SIZE);
+        if (node == NULL || chars == NULL) {
+            free(node);
+            free(chars);
+            return ENOMEM;
+        }
+
+        node->chars = chars;
+        give_leaf(rope, node);
+    }
+
+    return 0;
+}
+
+/* enough for two splits and a few joins on the current tree */
+static int reserve_for_edit(Rope *rope, size_t extra_inner, size_t extra_leaves) {
+    size_t per_split = (size_t) height(rope->root) + 2;
+    return reserve_nodes(rope, 2 * per_split + 4 + extra_inner, 4 + extra_leaves);
+}
+
+static void free_nodes(RopeNode *node) {
+    while (node != NULL) {
+        RopeNode *next = node->left;
+        free(node->chars);
+        free(node);
+        node = next;
+    }
+}
+
+static void free_tree(RopeNode *node) {
+    if (node == NULL) {
+        return;
+    }
+
+    free_tree(node->left);
+    free_tree(node->right);
+    free(node->chars);
+    free(node);
+}
+
+static void update(RopeNode *node) {
+    node->len = node->left->len + node->right->len;
+    node->height = 1 + (height(node->left) > height(node->right) ?
+                        height(node->left) : height(node->right));
+}
+
+static RopeNode *make_inner(Rope *rope, RopeNode *left, RopeNode *right) {
+    RopeNode *node = take_inner(rope);
+    node->left = left;
+    node->right = right;
+    update(node);
+    return node;
+}
+
+static RopeNode *rotate_left(RopeNode *node) {
+    RopeNode *r = node->right;
+    node->right = r->left;
+    update(node);
+    r->left = node;
+    update(r);
+    return r;
+}
+
+static RopeNode *rotate_right(RopeNode *node) {
+    RopeNode *l = node->left;
+    node->left = l->right;
+    update(node);
+    l->right = node;
+    update(l);
+    return l;
+}
+
+static RopeNode *rebalance(RopeNode *node) {
+    int balance = height(node->left) - height(node->right);
+
+    if (balance > 1) {
+        if (height(node->left->left) < height(node->left->right)) {
+            node->left = rotate_left(node->left);
+        }
+        return rotate_right(node);
+    }
+
+    if (balance < -1) {
+        if (height(node->right->right) < height(node->right->left)) {
+            node->right = rotate_right(node->right);
+        }
+        return rotate_left(node);
+    }
+
+    return node;
+}
+
+/* concatenate two trees, descending the taller one's spine so the result stays balanced */
+static RopeNode *join(Rope *rope, RopeNode *left, RopeNode *right) {
+    if (left == NULL) {
+        return right;
+    }
+    if (right == NULL) {
+        return left;
+    }
+
+    /* keep small neighboring leaves from piling up after splits and deletes */
+    if (is_leaf(left) && is_leaf(right) && left->len + right->len <= ROPE_LEAF_SIZE) {
+        memcpy(left->chars + left->len, right->chars, right->len);
+        left->len += right->len;
+        give_leaf(rope, right);
+        return left;
+    }
+
+    if (height(left) > height(right) + 1) {
+        left->right = join(rope, left->right, right);
+        update(left);
+        return rebalance(left);
+    }
+
+    if (height(right) > height(left) + 1) {
+        right->left = join(rope, left, right->left);
+        update(right);
+        return rebalance(right);
+    }
+
+    return make_inner(rope, left, right);
+}
+
+/* split into the first index chars (*left) and the rest (*right) */
+static void split(Rope *rope, RopeNode *node, size_t index, RopeNode **left, RopeNode **right) {
+    if (node == NULL) {
+        *left = NULL;
+        *right = NULL;
+        return;
+    }
+
+    if (index == 0) {
+        *left = NULL;
+        *right = node;
+        return;
+    }
+
+    if (index == node->len) {
+        *left = node;
+        *right = NULL;
+        return;
+    }
+
+    if (is_leaf(node)) {
+        RopeNode *rest = take_leaf(rope);
+        rest->len = node->len - index;
+        memcpy(rest->chars, node->chars + index, rest->len);
+        node->len = index;
+
+        *left = node;
+        *right = rest;
+        return;
+    }
+
+    RopeNode *l = node->left;
+    RopeNode *r = node->right;
+    give_inner(rope, node);
+
+    if (index <= l->len) {
+        RopeNode *ll, *lr;
+        split(rope, l, index, &ll, &lr);
+        *left = ll;
+        *right = join(rope, lr, r);
+    } else {
+        RopeNode *rl, *rr;
+        split(rope, r, index - l->len, &rl, &rr);
+        *left = join(rope, l, rl);
+        *right = rr;
+    }
+}
+
+/* balanced tree over leaves[lo, hi) */
+static RopeNode *build(Rope *rope, RopeNode **leaves, size_t lo, size_t hi) {
+    if (hi - lo == 1) {
+        return leaves[lo];
+    }
+
+    size_t mid = lo + (hi - lo) / 2;
+    RopeNode *left = build(rope, leaves, lo, mid);
+    RopeNode *right = build(rope, leaves, mid, hi);
+    return make_inner(rope, left, right);
+}
+
+/* add str to the leaf at index if it fits, returns 1 if it did */
+static int insert_in_leaf(RopeNode *node, size_t index, const String *str) {
+    int inserted;
+
+    if (is_leaf(node)) {
+        if (node->len + str->len > ROPE_LEAF_SIZE) {
+            return 0;
+        }
+
+        memmove(node->chars + index + str->len, node->chars + index, node->len - index);
+        memcpy(node->chars + index, str->chars, str->len);
+        inserted = 1;
+    } else if (index <= node->left->len) {
+        inserted = insert_in_leaf(node->left, index, str);
+    } else {
+        inserted = insert_in_leaf(node->right, index - node->left->len, str);
+    }
+
+    if (inserted) {
+        node->len += str->len;
+    }
+
+    return inserted;
+}
+
+/* leaf holding index (the leaf ending at index if it is between leaves), and index within it */
+static const RopeNode *find_leaf(const RopeNode *node, size_t *index) {
+    while (!is_leaf(node)) {
+        if (*index < node->left->len) {
+            node = node->left;
+        } else {
+            *index -= node->left->len;
+            node = node->right;
+        }
+    }
+
+    return node;
+}
+
+static void copy_range(const RopeNode *node, size_t start, size_t end, char *out) {
+    if (is_leaf(node)) {
+        memcpy(out, node->chars + start, end - start);
+        return;
+    }
+
+    size_t left_len = node->left->len;
+    if (start < left_len) {
+        copy_range(node->left, start, end < left_len ? end : left_len, out);
+    }
+    if (end > left_len) {
+        size_t right_start = start > left_len ? start - left_len : 0;
+        size_t copied = start < left_len ? left_len - start : 0;
+        copy_range(node->right, right_start, end - left_len, out + copied);
+    }
+}
+
+Rope *create_rope(void) {
+    Rope *rope = malloc(sizeof(Rope));
+    if (rope == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    rope->root = NULL;
+    rope->spare_inner = NULL;
+    rope->num_spare_inner = 0;
+    rope->spare_leaves = NULL;
+    rope->num_spare_leaves = 0;
+
+    return rope;
+}
+
+void free_rope(Rope *rope) {
+    if (rope == NULL) {
+        return;
+    }
+
+    free_tree(rope->root);
+    free_nodes(rope->spare_inner);
+    free_nodes(rope->spare_leaves);
+    free(rope);
+}
+
+size_t rope_length(const Rope *rope) {
+    if (rope == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return rope->root == NULL ? 0 : rope->root->len;
+}
+
+int rope_insert(Rope *rope, size_t index, const String *str) {
+    if (rope == NULL || str == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (index > rope_length(rope)) {
+        errno = EDOM;
+        return EDOM;
+    }
+
+    if (str->len == 0 || (rope->root != NULL && insert_in_leaf(rope->root, index, str))) {
+        return 0;
+    }
+
+    size_t num_leaves = (str->len + ROPE_LEAF_SIZE - 1) / ROPE_LEAF_SIZE;
+    RopeNode **leaves = malloc(num_leaves * sizeof(RopeNode *));
+    if (leaves == NULL || reserve_for_edit(rope, num_leaves, num_leaves) != 0) {
+        free(leaves);
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    size_t i;
+    for (i = 0; i < num_leaves; i++) {
+        leaves[i] = take_leaf(rope);
+        leaves[i]->len = i == num_leaves - 1 ? str->len - i * ROPE_LEAF_SIZE : ROPE_LEAF_SIZE;
+        memcpy(leaves[i]->chars, str->chars + i * ROPE_LEAF_SIZE, leaves[i]->len);
+    }
+
+    RopeNode *middle = build(rope, leaves, 0, num_leaves);
+    free(leaves);
+
+    RopeNode *left, *right;
+    split(rope, rope->root, index, &left, &right);
+    rope->root = join(rope, join(rope, left, middle), right);
+
+    return 0;
+}
+
+int rope_append(Rope *rope, const String *str) {
+    if (rope == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    return rope_insert(rope, rope_length(rope), str);
+}
+
+int rope_delete(Rope *rope, size_t start, size_t end) {
+    if (rope == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (end > rope_length(rope) || start > end) {
+        errno = EDOM;
+        return EDOM;
+    }
+
+    if (start == end) {
+        return 0;
+    }
+
+    if (reserve_for_edit(rope, 0, 0) != 0) {
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    RopeNode *before_end, *after, *before, *deleted;
+    split(rope, rope->root, end, &before_end, &after);
+    split(rope, before_end, start, &before, &deleted);
+    free_tree(deleted);
+
+    rope->root = join(rope, before, after);
+
+    return 0;
+}
+
+int rope_char_at(const Rope *rope, size_t index, char *c) {
+    if (rope == NULL || c == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (index >= rope_length(rope)) {
+        errno = EDOM;
+        return EDOM;
+    }
+
+    const RopeNode *leaf = find_leaf(rope->root, &index);
+    *c = leaf->chars[index];
+
+    return 0;
+}
+
+String *rope_substring(const Rope *rope, size_t start, size_t end) {
+    if (rope == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    if (end > rope_length(rope) || start > end) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    String *str = malloc(sizeof(String));
+    char *chars = malloc(end - start);
+    if (str == NULL || chars == NULL) {
+        free(str);
+        free(chars);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    if (rope->root != NULL) {
+        copy_range(rope->root, start, end, chars);
+    }
+
+    str->chars = chars;
+    str->len = end - start;
+
+    return str;
+}
+
+int rope_next_chunk(const Rope *rope, size_t *cursor, String *chunk) {
+    if (rope == NULL || cursor == NULL || chunk == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    if (*cursor >= rope_length(rope)) {
+        return 0;
+    }
+
+    size_t index = *cursor;
+    const RopeNode *leaf = find_leaf(rope->root, &index);
+
+    chunk->chars = leaf->chars + index;
+    chunk->len = leaf->len - index;
+    *cursor += chunk->len;
+
+    return 1;
+}
+
+String *rope_to_string(const Rope *rope) {
+    return rope_substring(rope, 0, rope_length(rope));
+}
@@ -0,0 +1,232 @@
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/segmented_array.h>
+#include <ilc/alloc.h>
+
+struct segmented_array {
+    size_t length;  /* items below it are written, published with release stores */
+    size_t reserved;  /* slots handed out to appenders, length <= reserved */
+    size_t item_size;
+    char *blocks[SEGMENTED_ARRAY_MAX_BLOCKS];  /* block k holds 16 << k items, fixed so it never moves */
+};
+
+/* block and offset of index: index + 16 has its highest bit at 4 + block, the rest is the offset */
+static size_t locate(size_t index, size_t *offset) {
+    unsigned long long shifted = (unsigned long long) index + (1ULL << SEGMENTED_ARRAY_FIRST_BLOCK_BITS);
+    int high_bit = 63 - __builtin_clzll(shifted);
+
+    *offset = shifted - (1ULL << high_bit);
+    return high_bit - SEGMENTED_ARRAY_FIRST_BLOCK_BITS;
+}
+
+static size_t block_capacity(size_t block) {
+    return (size_t) 1 << (block + SEGMENTED_ARRAY_FIRST_BLOCK_BITS);
+}
+
+/*
+ * Each block is its items followed by one ready flag per item. A flag is set
+ * once its item is written, so concurrent appenders can tell how far the
+ * length can be moved up.
+ */
+
+static unsigned char *ready_flag(const SegmentedArray *arr, char *items, size_t block, size_t offset) {
+    return (unsigned char *) items + block_capacity(block) * arr->item_size + offset;
+}
+
+/* make sure a block exists, it's fine if other threads race to do the same */
+static char *install_block(SegmentedArray *arr, size_t block) {
+    char *items = __atomic_load_n(&arr->blocks[block], __ATOMIC_ACQUIRE);
+    if (items != NULL) {
+        return items;
+    }
+
+    size_t capacity = block_capacity(block);
+    char *new_block = malloc(capacity * (arr->item_size + 1));
+    if (new_block == NULL) {
+        return NULL;
+    }
+    memset(new_block + capacity * arr->item_size, 0, capacity);
+
+    if (__atomic_compare_exchange_n(&arr->blocks[block], &items, new_block, 0,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return new_block;
+    }
+
+    free(new_block);  /* another thread won, items is now its block */
+    return items;
+}
+
+SegmentedArray *create_segmented_array(size_t item_size) {
+    SegmentedArray *arr = malloc(sizeof(SegmentedArray));
+    if (arr == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    arr->length = 0;
+    arr->reserved = 0;
+    arr->item_size = item_size;
+
+    size_t i;
+    for (i = 0; i < SEGMENTED_ARRAY_MAX_BLOCKS; i++) {
+        arr->blocks[i] = NULL;
+    }
+
+    return arr;
+}
+
+void free_segmented_array(SegmentedArray *arr) {
+    if (arr == NULL) {
+        return;
+    }
+
+    size_t i;
+    for (i = 0; i < SEGMENTED_ARRAY_MAX_BLOCKS; i++) {
+        free(arr->blocks[i]);
+    }
+    free(arr);
+}
+
+int segmented_array_append(SegmentedArray *arr, const void *item) {
+    if (arr == NULL || item == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    size_t length = arr->length;  /* only this thread writes it */
+    size_t offset;
+    size_t block = locate(length, &offset);
+
+    char *items = install_block(arr, block);
+    if (items == NULL) {
+        errno = ENOMEM;
+        return ENOMEM;
+    }
+
+    memcpy(items + offset * arr->item_size, item, arr->item_size);
+    *ready_flag(arr, items, block, offset) = 1;
+    arr->reserved = length + 1;
+    __atomic_store_n(&arr->length, length + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/*
+ * Move the length past every item that is ready. Whichever appender finishes
+ * the item at the current length carries it past the items finished after
+ * it, so no appender waits for another.
+ */
+static void advance_length(SegmentedArray *arr) {
+    size_t length = __atomic_load_n(&arr->length, __ATOMIC_SEQ_CST);
+    while (length < __atomic_load_n(&arr->reserved, __ATOMIC_SEQ_CST)) {
+        size_t offset;
+        size_t block = locate(length, &offset);
+        char *items = __atomic_load_n(&arr->blocks[block], __ATOMIC_ACQUIRE);
+        if (items == NULL || !__atomic_load_n(ready_flag(arr, items, block, offset), __ATOMIC_SEQ_CST)) {
+            return;  /* still being written, its appender will move the length on */
+        }
+
+        /* on failure length is reloaded, so this either moves on or catches up */
+        __atomic_compare_exchange_n(&arr->length, &length, length + 1, 0,
+                                    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+}
+
+int segmented_array_append_concurrent(SegmentedArray *arr, const void *item) {
+    if (arr == NULL || item == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    /*
+     * Claim the next slot, but only once its block exists, so running out of
+     * memory never leaves a claimed slot that will never be written (and
+     * would hold the length back forever).
+     */
+    size_t index = __atomic_load_n(&arr->reserved, __ATOMIC_RELAXED);
+    size_t offset, block;
+    char *items;
+    do {
+        block = locate(index, &offset);
+        items = install_block(arr, block);
+        if (items == NULL) {
+            errno = ENOMEM;
+            return ENOMEM;
+        }
+    } while (!__atomic_compare_exchange_n(&arr->reserved, &index, index + 1, 1,
+                                          __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+    /* halfway through a block, allocate the next one so appenders rarely wait on malloc */
+    if (offset == block_capacity(block) / 2 && block + 1 < SEGMENTED_ARRAY_MAX_BLOCKS) {
+        install_block(arr, block + 1);
+    }
+
+    memcpy(items + offset * arr->item_size, item, arr->item_size);
+    __atomic_store_n(ready_flag(arr, items, block, offset), 1, __ATOMIC_SEQ_CST);
+
+    advance_length(arr);
+
+    return 0;
+}
+
+int segmented_array_reserve(SegmentedArray *arr, size_t capacity) {
+    if (arr == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (capacity == 0) {
+        return 0;
+    }
+
+    size_t offset;
+    size_t last_block = locate(capacity - 1, &offset);
+    size_t block;
+    for (block = 0; block <= last_block; block++) {
+        if (install_block(arr, block) == NULL) {
+            errno = ENOMEM;
+            return ENOMEM;
+        }
+    }
+
+    return 0;
+}
+
+size_t segmented_array_length(const SegmentedArray *arr) {
+    if (arr == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    return __atomic_load_n(&arr->length, __ATOMIC_ACQUIRE);
+}
+
+void *segmented_array_run(const SegmentedArray *arr, size_t index, size_t *count) {
+    if (arr == NULL || count == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    size_t length = __atomic_load_n(&arr->length, __ATOMIC_ACQUIRE);
+    if (index >= length) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    size_t offset;
+    size_t block = locate(index, &offset);
+    char *items = __atomic_load_n(&arr->blocks[block], __ATOMIC_ACQUIRE);
+
+    *count = block_capacity(block) - offset;
+    if (*count > length - index) {
+        *count = length - index;
+    }
+
+    return items + offset * arr->item_size;
+}
+
+void *segmented_array_item_at(const SegmentedArray *arr, size_t index) {
+    size_t count;
+    return segmented_array_run(arr, index, &count);
+}
@@ -1,7 +1,17 @@
+#define _DEFAULT_SOURCE  /* madvise and MADV_* */
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <ilc/string.h>
+#include <ilc/trace.h>
+#include <ilc/alloc.h>
 
 
 /* don't want to add string.h as dependency bc I'm stubborn */
@@ -91,6 +101,90 @@ void free_string(String *str) {
     free(str);
 }
 
+String *string_map_file(const char *path, int flags) {
+    if (path == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    String *str = malloc(sizeof(String));
+    if (str == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        free(str);
+        return NULL;  /* errno set by open */
+    }
+
+    struct stat info;
+    int err = 0;
+    if (fstat(fd, &info) == -1) {
+        err = errno;
+    } else if (!S_ISREG(info.st_mode)) {
+        err = EINVAL;
+    }
+
+    if (err != 0) {
+        close(fd);
+        free(str);
+        errno = err;
+        return NULL;
+    }
+
+    str->len = (size_t) info.st_size;
+
+    /* mmap can't map 0 bytes */
+    if (str->len == 0) {
+        close(fd);
+        str->chars = NULL;
+        return str;
+    }
+
+    void *mapped = mmap(NULL, str->len, PROT_READ, MAP_PRIVATE, fd, 0);
+    err = errno;
+    close(fd);  /* the mapping keeps the file open */
+
+    if (mapped == MAP_FAILED) {
+        free(str);
+        errno = err;
+        return NULL;
+    }
+
+    /* only hints, so failures are ignored */
+    if (flags & STRING_MAP_SEQUENTIAL) {
+        madvise(mapped, str->len, MADV_SEQUENTIAL);
+    }
+    if (flags & STRING_MAP_WILLNEED) {
+        madvise(mapped, str->len, MADV_WILLNEED);
+    }
+#ifdef MADV_HUGEPAGE
+    if (flags & STRING_MAP_HUGEPAGE) {
+        madvise(mapped, str->len, MADV_HUGEPAGE);
+    }
+#endif
+
+    str->chars = mapped;
+
+    return str;
+}
+
+int string_unmap_file(String *str) {
+    if (str == NULL) {
+        return 0;
+    }
+
+    if (str->len > 0 && munmap(str->chars, str->len) == -1) {
+        return errno;  /* errno set by munmap */
+    }
+
+    free(str);
+
+    return 0;
+}
+
 String *substring(const String *str, long start, long end) {
     if (str == NULL) {
         errno = EFAULT;
@@ -264,19 +358,195 @@ int string_contains_at(const String *str, const String *substr, size_t *idx) {
         return 1;
     }
 
+    TRACE_BEGIN("string_contains_at");
     size_t i;
     for (i = 0; i <= str->len - substr->len; i++) {
         if (bounded_string_equal(str, substr, i)) {
             if (idx != NULL) {
                 *idx = i;
             }
+            TRACE_END();
             return 1;
         }
     }
 
+    TRACE_END();
+    return 0;
+}
+
+/*
+ * KMP prefix function: table[i] is the length of the longest proper prefix of
+ * substr that is also a suffix of substr[0..i], so the search never backs up
+ */
+static size_t *build_prefix_table(const String *substr) {
+    size_t *table = malloc(substr->len * sizeof(size_t));
+    if (table == NULL) {
+        return NULL;
+    }
+
+    table[0] = 0;
+
+    size_t k = 0;
+    size_t i;
+    for (i = 1; i < substr->len; i++) {
+        while (k > 0 && substr->chars[i] != substr->chars[k]) {
+            k = table[k - 1];
+        }
+        if (substr->chars[i] == substr->chars[k]) {
+            k++;
+        }
+        table[i] = k;
+    }
+
+    return table;
+}
+
+/* one left to right pass over str, appending non-overlapping matches to offsets if not NULL */
+static int scan_occurrences(const String *str, const String *substr, DynArray *offsets,
+                            size_t *count) {
+    *count = 0;
+
+    if (substr->len > str->len) {
+        return 0;
+    }
+
+    size_t *table = build_prefix_table(substr);
+    if (table == NULL) {
+        return ENOMEM;
+    }
+
+    size_t k = 0;
+    size_t i;
+    for (i = 0; i < str->len; i++) {
+        while (k > 0 && str->chars[i] != substr->chars[k]) {
+            k = table[k - 1];
+        }
+        if (str->chars[i] == substr->chars[k]) {
+            k++;
+        }
+
+        if (k == substr->len) {
+            size_t offset = i + 1 - substr->len;
+            if (offsets != NULL && dynarray_append(offsets, &offset) != 0) {
+                free(table);
+                return ENOMEM;
+            }
+
+            *count += 1;
+            k = 0;  /* restart after the match so matches don't overlap */
+        }
+    }
+
+    free(table);
     return 0;
 }
 
+int string_find_all(const String *str, const String *substr, DynArray *offsets) {
+    if (str == NULL || substr == NULL || offsets == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    if (substr->len == 0) {
+        errno = EINVAL;
+        return EINVAL;
+    }
+
+    size_t count;
+    TRACE_BEGIN("string_find_all");
+    int result = scan_occurrences(str, substr, offsets, &count);
+    TRACE_END();
+    if (result != 0) {
+        errno = result;
+    }
+
+    return result;
+}
+
+size_t string_count(const String *str, const String *substr) {
+    if (str == NULL || substr == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    if (substr->len == 0) {
+        errno = EINVAL;
+        return 0;
+    }
+
+    size_t count;
+    TRACE_BEGIN("string_count");
+    int result = scan_occurrences(str, substr, NULL, &count);
+    TRACE_END();
+    if (result != 0) {
+        errno = result;
+        return 0;
+    }
+
+    return count;
+}
+
+String *string_replace_all(const String *str, const String *substr, const String *replacement) {
+    if (str == NULL || substr == NULL || replacement == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    if (substr->len == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    DynArray *offsets = create_dynarray(sizeof(size_t));
+    if (offsets == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size_t count;
+    if (scan_occurrences(str, substr, offsets, &count) != 0) {
+        free_dynarray(offsets);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    /* exact size is known before writing anything, so there is only one allocation */
+    size_t replaced_len = str->len - count * substr->len + count * replacement->len;
+
+    String *replaced = malloc(sizeof(String));
+    char *chars = malloc(replaced_len);
+    if (replaced == NULL || chars == NULL) {
+        free(replaced);
+        free(chars);
+        free_dynarray(offsets);
+
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size_t read = 0, written = 0;
+    size_t i;
+    for (i = 0; i < count; i++) {
+        size_t offset = *(size_t *) dynarray_item_at(offsets, i);
+
+        mem_copy(chars + written, str->chars + read, offset - read);
+        written += offset - read;
+
+        mem_copy(chars + written, replacement->chars, replacement->len);
+        written += replacement->len;
+
+        read = offset + substr->len;
+    }
+    mem_copy(chars + written, str->chars + read, str->len - read);
+
+    free_dynarray(offsets);
+
+    replaced->chars = chars;
+    replaced->len = replaced_len;
+
+    return replaced;
+}
+
 String *string_concat(const String *first, const String *second) {
     if (first == NULL || second == NULL) {
         errno = EFAULT;
@@ -317,7 +587,9 @@ int string_append(String *str, const String *to_append) {
     }
 
     size_t concat_len = str->len + to_append->len;
+    TRACE_BEGIN("string_append grow");
     char *chars = realloc(str->chars, concat_len);
+    TRACE_END();
     if (chars == NULL) {
         /* errno set by realloc when it fails */
         return ENOMEM;
@@ -473,15 +745,18 @@ StringList *string_split(const String *str, const String *delim) {
         return NULL;
     }
 
+    TRACE_BEGIN("string_split");
     size_t num_delims;
     size_t *delim_locations = find_delims(str, delim, &num_delims);
     if (delim_locations == NULL) {
+        TRACE_END();
         errno = ENOMEM;
         return NULL;
     }
 
     StringList *list = malloc(sizeof(StringList));
     if (list == NULL) {
+        TRACE_END();
         errno = ENOMEM;
         return NULL;
     }
@@ -493,6 +768,7 @@ StringList *string_split(const String *str, const String *delim) {
                                         delim_locations, num_delims);
     if (strs == NULL) {
         free(delim_locations);
+        TRACE_END();
         errno = ENOMEM;
         return NULL;
     }
@@ -500,6 +776,264 @@ StringList *string_split(const String *str, const String *delim) {
     list->strs = strs;
 
     free(delim_locations);
+    TRACE_END();
+    return list;
+}
+
+#define MIN_SPLIT_CHUNK (64 * 1024)  /* smaller chunks aren't worth a thread */
+
+typedef struct {
+    const String *str;
+    const String *delim;
+    size_t start;  /* delims starting in [start, end) belong to this chunk */
+    size_t end;
+    size_t *delims;  /* chosen delim locations, in order */
+    size_t num_delims;
+    size_t capacity;
+    size_t first_string;  /* index in the output list of the string ending at delims[0] */
+    size_t prev_delim_end;  /* end of the last delim before this chunk (0 if none) */
+    String *strs;
+    int failed;
+} SplitChunk;
+
+static int chunk_add_delim(SplitChunk *chunk, size_t location) {
+    if (chunk->num_delims == chunk->capacity) {
+        size_t capacity = chunk->capacity == 0 ? 64 : chunk->capacity * 2;
+        size_t *delims = realloc(chunk->delims, capacity * sizeof(size_t));
+        if (delims == NULL) {
+            return ENOMEM;
+        }
+
+        chunk->delims = delims;
+        chunk->capacity = capacity;
+    }
+
+    chunk->delims[chunk->num_delims++] = location;
+    return 0;
+}
+
+/* the next delim starting at or after from (and before the chunk's end), or chunk->end */
+static size_t chunk_next_delim(const SplitChunk *chunk, size_t from) {
+    const String *str = chunk->str;
+    const String *delim = chunk->delim;
+
+    size_t i;
+    for (i = from; i < chunk->end && i + delim->len <= str->len; i++) {
+        if (str->chars[i] == delim->chars[0] && bounded_string_equal(str, delim, i)) {
+            return i;
+        }
+    }
+
+    return chunk->end;
+}
+
+/*
+ * Same left to right, non-overlapping scan as find_delims, but only over the
+ * chunk and as if nothing before it matched. A delim may run past the chunk's
+ * end, and is then the last one the chunk finds.
+ */
+static void *find_chunk_delims(void *arg) {
+    SplitChunk *chunk = arg;
+
+    TRACE_BEGIN("find_chunk_delims");
+    size_t i = chunk_next_delim(chunk, chunk->start);
+    while (i < chunk->end) {
+        if (chunk_add_delim(chunk, i) != 0) {
+            chunk->failed = 1;
+            TRACE_END();
+            return NULL;
+        }
+
+        i = chunk_next_delim(chunk, i + chunk->delim->len);
+    }
+
+    TRACE_END();
+    return NULL;
+}
+
+/*
+ * If the last delim of the previous chunk runs into this one (only possible
+ * for delims that overlap themselves, like "aa"), this chunk's scan started
+ * too early. Rescan from where the previous delim ends until the rescan picks
+ * a delim the first scan also picked, after which both scans agree.
+ */
+static int fix_chunk_start(SplitChunk *chunk, size_t resume_at) {
+    size_t *old_delims = chunk->delims;
+    size_t old_num_delims = chunk->num_delims;
+
+    chunk->delims = NULL;
+    chunk->num_delims = 0;
+    chunk->capacity = 0;
+
+    size_t j = 0;
+    size_t i = chunk_next_delim(chunk, resume_at);
+    while (i < chunk->end) {
+        while (j < old_num_delims && old_delims[j] < i) {
+            j++;
+        }
+        if (j < old_num_delims && old_delims[j] == i) {
+            break;  /* back in sync */
+        }
+
+        if (chunk_add_delim(chunk, i) != 0) {
+            free(old_delims);
+            return ENOMEM;
+        }
+
+        i = chunk_next_delim(chunk, i + chunk->delim->len);
+    }
+
+    for (; j < old_num_delims && i < chunk->end; j++) {
+        if (chunk_add_delim(chunk, old_delims[j]) != 0) {
+            free(old_delims);
+            return ENOMEM;
+        }
+    }
+
+    free(old_delims);
+    return 0;
+}
+
+static void *create_chunk_strings(void *arg) {
+    SplitChunk *chunk = arg;
+
+    TRACE_BEGIN("create_chunk_strings");
+    size_t s_start = chunk->prev_delim_end;
+    size_t i;
+    for (i = 0; i < chunk->num_delims; i++) {
+        String *s = &chunk->strs[chunk->first_string + i];
+        s->chars = chunk->str->chars + s_start;
+        s->len = chunk->delims[i] - s_start;
+
+        s_start = chunk->delims[i] + chunk->delim->len;
+    }
+
+    TRACE_END();
+    return NULL;
+}
+
+/* run fn on every chunk, one thread each, falling back to this thread if one can't be started */
+static void run_chunks(SplitChunk *chunks, size_t num_chunks, void *(*fn)(void *)) {
+    pthread_t *threads = malloc(num_chunks * sizeof(pthread_t));
+    int *started = calloc(num_chunks, sizeof(int));
+
+    size_t i;
+    for (i = 1; i < num_chunks; i++) {
+        if (threads != NULL && started != NULL) {
+            started[i] = pthread_create(&threads[i], NULL, fn, &chunks[i]) == 0;
+        }
+    }
+
+    fn(&chunks[0]);
+
+    for (i = 1; i < num_chunks; i++) {
+        if (started != NULL && started[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            fn(&chunks[i]);
+        }
+    }
+
+    free(threads);
+    free(started);
+}
+
+StringList *string_split_parallel(const String *str, const String *delim, size_t num_threads) {
+    if (str == NULL || delim == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    if (num_threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = online > 0 ? (size_t) online : 1;
+    }
+
+    size_t num_chunks = str->len / MIN_SPLIT_CHUNK;
+    if (num_chunks > num_threads) {
+        num_chunks = num_threads;
+    }
+
+    /* the empty delim has nothing to search for, and small inputs aren't worth it */
+    if (num_chunks < 2 || delim->len == 0 || delim->len > str->len) {
+        return string_split(str, delim);
+    }
+
+    TRACE_BEGIN("string_split_parallel");
+    SplitChunk *chunks = calloc(num_chunks, sizeof(SplitChunk));
+    StringList *list = malloc(sizeof(StringList));
+    if (chunks == NULL || list == NULL) {
+        free(chunks);
+        free(list);
+        TRACE_END();
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size_t i;
+    for (i = 0; i < num_chunks; i++) {
+        chunks[i].str = str;
+        chunks[i].delim = delim;
+        chunks[i].start = str->len / num_chunks * i;
+        chunks[i].end = (i == num_chunks - 1) ? str->len : str->len / num_chunks * (i + 1);
+    }
+
+    run_chunks(chunks, num_chunks, find_chunk_delims);
+
+    /* serial pass: fix chunk starts, then an exclusive prefix sum of delim counts */
+    int failed = 0;
+    size_t num_strs = 0;
+    size_t prev_delim_end = 0;
+    for (i = 0; i < num_chunks && !failed; i++) {
+        SplitChunk *chunk = &chunks[i];
+        failed = chunk->failed;
+
+        if (!failed && prev_delim_end > chunk->start && chunk->num_delims > 0 &&
+            chunk->delims[0] < prev_delim_end) {
+            failed = fix_chunk_start(chunk, prev_delim_end) != 0;
+        }
+
+        chunk->first_string = num_strs;
+        chunk->prev_delim_end = prev_delim_end;
+
+        num_strs += chunk->num_delims;
+        if (chunk->num_delims > 0) {
+            prev_delim_end = chunk->delims[chunk->num_delims - 1] + delim->len;
+        }
+    }
+
+    /* always 1 more string than total instances of delimeter */
+    num_strs++;
+
+    String *strs = failed ? NULL : malloc(num_strs * sizeof(String));
+    if (strs != NULL) {
+        for (i = 0; i < num_chunks; i++) {
+            chunks[i].strs = strs;
+        }
+
+        run_chunks(chunks, num_chunks, create_chunk_strings);
+
+        String *last_s = &strs[num_strs - 1];
+        last_s->chars = str->chars + prev_delim_end;
+        last_s->len = str->len - prev_delim_end;
+    }
+
+    for (i = 0; i < num_chunks; i++) {
+        free(chunks[i].delims);
+    }
+    free(chunks);
+
+    if (strs == NULL) {
+        free(list);
+        TRACE_END();
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    list->strs = strs;
+    list->len = num_strs;
+
+    TRACE_END();
     return list;
 }
 
@@ -518,6 +1052,7 @@ String *string_join(const String *delim, const StringList *list) {
     joined->chars = NULL;  /* NULL works with string_append (realloc) */
     joined->len = 0;
 
+    TRACE_BEGIN("string_join");
     size_t i;
     for (i = 0; i < list->len; i++) {
         const String *s = &list->strs[i];
@@ -527,6 +1062,7 @@ String *string_join(const String *delim, const StringList *list) {
             append_result = string_append(joined, delim);
             if (append_result != 0) {  /* errno already set by append */
                 free_string(joined);
+                TRACE_END();
                 return NULL;
             }
         }
@@ -534,107 +1070,615 @@ String *string_join(const String *delim, const StringList *list) {
         append_result = string_append(joined, s);
         if (append_result != 0) {  /* errno already set by append */
             free_string(joined);
+            TRACE_END();
             return NULL;
         }
     }
 
+    TRACE_END();
     return joined;
 }
 
-static size_t find_start_after_trim(const String *str, const StringList *to_trim) {
-    size_t start_after_trim = 0;
+#define NO_STATE UINT32_MAX
+
+struct string_matcher {
+    size_t num_states;
+    size_t num_classes;
+    unsigned short classes[256];  /* byte -> input class, 0 for bytes in no pattern */
+    unsigned char starts_pattern[256];  /* 1 if some pattern begins with the byte */
+    uint32_t *delta;  /* num_states rows of num_classes transitions */
+    uint32_t *depth;  /* length of the path from the start state */
+    uint32_t *terminal;  /* pattern index + 1 of the pattern spelled by the state, or 0 */
+    uint32_t *dict_link;  /* nearest terminal state on the failure chain, or NO_STATE */
+    size_t max_pattern_len;
+};
+
+static unsigned char pattern_byte(const String *pattern, size_t i, int reversed) {
+    return (unsigned char) pattern->chars[reversed ? pattern->len - 1 - i : i];
+}
+
+static int grow_matcher_states(StringMatcher *m, size_t *capacity) {
+    size_t new_capacity = *capacity * 2;
+
+    uint32_t *delta = realloc(m->delta, new_capacity * m->num_classes * sizeof(uint32_t));
+    if (delta == NULL) {
+        return ENOMEM;
+    }
+    m->delta = delta;
+
+    uint32_t *depth = realloc(m->depth, new_capacity * sizeof(uint32_t));
+    if (depth == NULL) {
+        return ENOMEM;
+    }
+    m->depth = depth;
+
+    uint32_t *terminal = realloc(m->terminal, new_capacity * sizeof(uint32_t));
+    if (terminal == NULL) {
+        return ENOMEM;
+    }
+    m->terminal = terminal;
+
+    *capacity = new_capacity;
+    return 0;
+}
+
+static uint32_t add_matcher_state(StringMatcher *m, uint32_t depth) {
+    uint32_t s = (uint32_t) m->num_states++;
+
+    size_t c;
+    for (c = 0; c < m->num_classes; c++) {
+        m->delta[s * m->num_classes + c] = NO_STATE;
+    }
+    m->depth[s] = depth;
+    m->terminal[s] = 0;
+
+    return s;
+}
+
+/* fills in failure transitions breadth first, turning the trie into a DFA */
+static int complete_matcher(StringMatcher *m) {
+    uint32_t *fail = malloc(m->num_states * sizeof(uint32_t));
+    uint32_t *queue = malloc(m->num_states * sizeof(uint32_t));
+    m->dict_link = malloc(m->num_states * sizeof(uint32_t));
+
+    if (fail == NULL || queue == NULL || m->dict_link == NULL) {
+        free(fail);
+        free(queue);
+        return ENOMEM;
+    }
+
+    size_t nc = m->num_classes;
+    size_t head = 0, tail = 0;
+
+    fail[0] = 0;
+    m->dict_link[0] = NO_STATE;
+
+    size_t c;
+    for (c = 0; c < nc; c++) {
+        uint32_t t = m->delta[c];
+        if (t == NO_STATE) {
+            m->delta[c] = 0;
+        } else {
+            fail[t] = 0;
+            m->dict_link[t] = NO_STATE;
+            queue[tail++] = t;
+        }
+    }
+
+    /* a state's failure target is shallower, so its row is complete when needed */
+    while (head < tail) {
+        uint32_t s = queue[head++];
 
-    size_t i = 0, misses = 0;
-    while (misses < to_trim->len) {
-        String *s = &to_trim->strs[i];
+        for (c = 0; c < nc; c++) {
+            uint32_t t = m->delta[s * nc + c];
+            uint32_t via_fail = m->delta[fail[s] * nc + c];
 
-        if (start_after_trim + s->len > str->len) {
-            misses++;
-            i = (i + 1) % to_trim->len;
+            if (t == NO_STATE) {
+                m->delta[s * nc + c] = via_fail;
+                continue;
+            }
+
+            fail[t] = via_fail;
+            m->dict_link[t] = m->terminal[via_fail] ? via_fail : m->dict_link[via_fail];
+            queue[tail++] = t;
+        }
+    }
+
+    free(fail);
+    free(queue);
+    return 0;
+}
+
+static StringMatcher *build_matcher(const StringList *patterns, int reversed) {
+    StringMatcher *m = malloc(sizeof(StringMatcher));
+    if (m == NULL) {
+        return NULL;
+    }
+
+    size_t i, j;
+    for (i = 0; i < 256; i++) {
+        m->classes[i] = 0;
+        m->starts_pattern[i] = 0;
+    }
+
+    m->num_classes = 1;
+    m->max_pattern_len = 0;
+    for (i = 0; i < patterns->len; i++) {
+        const String *p = &patterns->strs[i];
+        if (p->len == 0) {
             continue;
         }
 
-        size_t j;
-        for (j = start_after_trim; j <= str->len - s->len; j++) {
-            if (bounded_string_equal(str, s, j)) {
-                misses = 0;
-                start_after_trim += s->len;
-                j += s->len - 1;  /* -1 to account for j++ from for loop */
-            } else {
+        m->starts_pattern[pattern_byte(p, 0, reversed)] = 1;
+        if (p->len > m->max_pattern_len) {
+            m->max_pattern_len = p->len;
+        }
+
+        for (j = 0; j < p->len; j++) {
+            unsigned char b = pattern_byte(p, j, reversed);
+            if (m->classes[b] == 0) {
+                m->classes[b] = (unsigned short) m->num_classes++;
+            }
+        }
+    }
+
+    size_t capacity = 16;
+    m->num_states = 0;
+    m->delta = malloc(capacity * m->num_classes * sizeof(uint32_t));
+    m->depth = malloc(capacity * sizeof(uint32_t));
+    m->terminal = malloc(capacity * sizeof(uint32_t));
+    m->dict_link = NULL;
+
+    if (m->delta == NULL || m->depth == NULL || m->terminal == NULL) {
+        free_string_matcher(m);
+        return NULL;
+    }
+
+    add_matcher_state(m, 0);
+
+    for (i = 0; i < patterns->len; i++) {
+        const String *p = &patterns->strs[i];
+        if (p->len == 0) {
+            continue;
+        }
+
+        uint32_t s = 0;
+        for (j = 0; j < p->len; j++) {
+            size_t slot = s * m->num_classes + m->classes[pattern_byte(p, j, reversed)];
+
+            if (m->delta[slot] == NO_STATE) {
+                if (m->num_states == capacity && grow_matcher_states(m, &capacity) != 0) {
+                    free_string_matcher(m);
+                    return NULL;
+                }
+                m->delta[slot] = add_matcher_state(m, (uint32_t) (j + 1));
+            }
+
+            s = m->delta[slot];
+        }
+
+        if (m->terminal[s] == 0) {
+            m->terminal[s] = (uint32_t) (i + 1);
+        }
+    }
+
+    if (complete_matcher(m) != 0) {
+        free_string_matcher(m);
+        return NULL;
+    }
+
+    return m;
+}
+
+StringMatcher *create_string_matcher(const StringList *patterns) {
+    if (patterns == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+
+    StringMatcher *m = build_matcher(patterns, 0);
+    if (m == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    return m;
+}
+
+void free_string_matcher(StringMatcher *matcher) {
+    if (matcher == NULL) {
+        return;
+    }
+
+    free(matcher->delta);
+    free(matcher->depth);
+    free(matcher->terminal);
+    free(matcher->dict_link);
+    free(matcher);
+}
+
+static uint32_t matcher_step(const StringMatcher *m, uint32_t s, char c) {
+    return m->delta[s * m->num_classes + m->classes[(unsigned char) c]];
+}
+
+/* first state at or after s (on the dictionary chain) that ends a pattern, or NO_STATE */
+static uint32_t first_output(const StringMatcher *m, uint32_t s) {
+    return m->terminal[s] ? s : m->dict_link[s];
+}
+
+int string_matcher_find(const StringMatcher *matcher, const String *str, StringMatch *match) {
+    if (matcher == NULL || str == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    const StringMatcher *m = matcher;
+    size_t best_start = str->len, best_len = 0;
+    int found = 0;
+    uint32_t s = 0;
+
+    TRACE_BEGIN("string_matcher_find");
+    size_t i;
+    for (i = 0; i < str->len; i++) {
+        if (s == 0) {
+            while (i < str->len && !m->starts_pattern[(unsigned char) str->chars[i]]) {
+                i++;
+            }
+            if (i == str->len) {
                 break;
             }
         }
 
-        misses++;
-        i = (i + 1) % to_trim->len;
+        s = matcher_step(m, s, str->chars[i]);
+
+        uint32_t o;
+        for (o = first_output(m, s); o != NO_STATE; o = m->dict_link[o]) {
+            size_t start = i + 1 - m->depth[o];
+            if (!found || start < best_start || (start == best_start && m->depth[o] > best_len)) {
+                found = 1;
+                best_start = start;
+                best_len = m->depth[o];
+                if (match != NULL) {
+                    match->start = start;
+                    match->pattern = m->terminal[o] - 1;
+                }
+            }
+        }
+
+        /* a match starting before best_start would have to be longer than any pattern */
+        if (found && i + 1 >= best_start + m->max_pattern_len) {
+            break;
+        }
     }
 
-    return start_after_trim;
+    TRACE_END();
+    return found;
 }
 
-static size_t find_end_after_trim(const String *str, const StringList *to_trim) {
-    size_t end_after_trim = str->len;
+int string_matcher_find_all(const StringMatcher *matcher, const String *str, DynArray *matches) {
+    if (matcher == NULL || str == NULL || matches == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
 
-    size_t i = 0, misses = 0;
-    while (misses < to_trim->len) {
-        String *s = &to_trim->strs[i];
+    const StringMatcher *m = matcher;
+    uint32_t s = 0;
 
-        if (end_after_trim - s->len < 0) {
-            misses++;
-            i = (i + 1) % to_trim->len;
-            continue;
+    TRACE_BEGIN("string_matcher_find_all");
+    size_t i;
+    for (i = 0; i < str->len; i++) {
+        if (s == 0) {
+            while (i < str->len && !m->starts_pattern[(unsigned char) str->chars[i]]) {
+                i++;
+            }
+            if (i == str->len) {
+                break;
+            }
         }
 
-        size_t j;
-        for (j = end_after_trim - s->len; j >= 0; j--) {
-            if (bounded_string_equal(str, s, j)) {
-                misses = 0;
-                end_after_trim -= s->len;
-                j -= s->len - 1;  /* +1 to account for j-- from for loop */
-            } else {
+        s = matcher_step(m, s, str->chars[i]);
+
+        uint32_t o;
+        for (o = first_output(m, s); o != NO_STATE; o = m->dict_link[o]) {
+            StringMatch found;
+            found.start = i + 1 - m->depth[o];
+            found.pattern = m->terminal[o] - 1;
+
+            if (dynarray_append(matches, &found) != 0) {
+                TRACE_END();
+                errno = ENOMEM;
+                return ENOMEM;
+            }
+        }
+    }
+
+    TRACE_END();
+    return 0;
+}
+
+size_t string_matcher_count(const StringMatcher *matcher, const String *str) {
+    if (matcher == NULL || str == NULL) {
+        errno = EFAULT;
+        return 0;
+    }
+
+    const StringMatcher *m = matcher;
+    size_t count = 0;
+    uint32_t s = 0;
+
+    TRACE_BEGIN("string_matcher_count");
+    size_t i;
+    for (i = 0; i < str->len; i++) {
+        if (s == 0) {
+            while (i < str->len && !m->starts_pattern[(unsigned char) str->chars[i]]) {
+                i++;
+            }
+            if (i == str->len) {
                 break;
             }
         }
 
-        misses++;
-        i = (i + 1) % to_trim->len;
+        s = matcher_step(m, s, str->chars[i]);
+
+        uint32_t o;
+        for (o = first_output(m, s); o != NO_STATE; o = m->dict_link[o]) {
+            count++;
+        }
     }
 
-    return end_after_trim;
+    TRACE_END();
+    return count;
 }
 
-String *string_ltrim(const String *str, const StringList *to_trim) {
-    if (str == NULL || to_trim == NULL) {
+/*
+ * Furthest offset into chars (from the start, or from the end for a reversed
+ * matcher) that a run of whole patterns reaches. From each reachable offset,
+ * in order, the trie is walked along chars and every pattern it spells marks
+ * the offset just past it reachable. A transition to a state that isn't one
+ * deeper is a failure link, which means no pattern continues along chars.
+ * Marks land at most max_pattern_len ahead, so reachable is a ring of
+ * max_pattern_len + 1 flags.
+ */
+static size_t furthest_pattern_run(const StringMatcher *m, const char *chars, size_t len,
+                                   int backward, unsigned char *reachable) {
+    size_t ring_size = m->max_pattern_len + 1;
+    size_t i;
+    for (i = 0; i < ring_size; i++) {
+        reachable[i] = 0;
+    }
+    reachable[0] = 1;
+
+    size_t furthest = 0, marked = 0;
+    for (i = 0; i <= marked; i++) {
+        if (!reachable[i % ring_size]) {
+            continue;
+        }
+        reachable[i % ring_size] = 0;  /* the slot is reused for i + ring_size */
+        furthest = i;
+
+        uint32_t s = 0;
+        size_t d;
+        for (d = 0; i + d < len && d < m->max_pattern_len; d++) {
+            uint32_t t = matcher_step(m, s, chars[backward ? len - 1 - (i + d) : i + d]);
+            if (m->depth[t] != d + 1) {
+                break;
+            }
+
+            s = t;
+            if (m->terminal[s]) {
+                reachable[(i + d + 1) % ring_size] = 1;
+                if (i + d + 1 > marked) {
+                    marked = i + d + 1;
+                }
+            }
+        }
+    }
+
+    return furthest;
+}
+
+#define TRIM_RING_STACK_SIZE 64  /* longer patterns need a heap allocated ring while trimming */
+
+struct string_trimmer {
+    int single_bytes;  /* every pattern is one byte long, so trim_byte alone decides */
+    unsigned char trim_byte[256];
+    StringMatcher *forward;  /* NULL when single_bytes */
+    StringMatcher *reversed;
+};
+
+/* sets up a trimmer in place, only multi-byte patterns need heap memory */
+static int init_trimmer(StringTrimmer *t, const StringList *to_trim) {
+    size_t i;
+    for (i = 0; i < 256; i++) {
+        t->trim_byte[i] = 0;
+    }
+
+    t->single_bytes = 1;
+    t->forward = NULL;
+    t->reversed = NULL;
+
+    for (i = 0; i < to_trim->len; i++) {
+        const String *p = &to_trim->strs[i];
+        if (p->len == 1) {
+            t->trim_byte[(unsigned char) p->chars[0]] = 1;
+        } else if (p->len > 1) {
+            t->single_bytes = 0;
+        }
+    }
+
+    if (t->single_bytes) {
+        return 0;
+    }
+
+    t->forward = build_matcher(to_trim, 0);
+    t->reversed = build_matcher(to_trim, 1);
+    if (t->forward == NULL || t->reversed == NULL) {
+        free_string_matcher(t->forward);
+        free_string_matcher(t->reversed);
+        return ENOMEM;
+    }
+
+    return 0;
+}
+
+static void release_trimmer(StringTrimmer *t) {
+    free_string_matcher(t->forward);
+    free_string_matcher(t->reversed);
+}
+
+static size_t find_start_after_trim(const String *str, const StringTrimmer *t, unsigned char *reachable) {
+    size_t start_after_trim = 0;
+
+    if (t->single_bytes) {
+        while (start_after_trim < str->len &&
+               t->trim_byte[(unsigned char) str->chars[start_after_trim]]) {
+            start_after_trim++;
+        }
+        return start_after_trim;
+    }
+
+    return furthest_pattern_run(t->forward, str->chars, str->len, 0, reachable);
+}
+
+static size_t find_end_after_trim(const String *str, const StringTrimmer *t, unsigned char *reachable) {
+    size_t end_after_trim = str->len;
+
+    if (t->single_bytes) {
+        while (end_after_trim > 0 && t->trim_byte[(unsigned char) str->chars[end_after_trim - 1]]) {
+            end_after_trim--;
+        }
+        return end_after_trim;
+    }
+
+    return str->len - furthest_pattern_run(t->reversed, str->chars, str->len, 1, reachable);
+}
+
+StringTrimmer *create_string_trimmer(const StringList *to_trim) {
+    if (to_trim == NULL) {
         errno = EFAULT;
         return NULL;
     }
 
-    size_t start = find_start_after_trim(str, to_trim);
-    return create_string(str->chars + start, str->len - start);
+    StringTrimmer *t = malloc(sizeof(StringTrimmer));
+    if (t == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    if (init_trimmer(t, to_trim) != 0) {
+        free(t);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    return t;
 }
 
-String *string_rtrim(const String *str, const StringList *to_trim) {
+void free_string_trimmer(StringTrimmer *trimmer) {
+    if (trimmer == NULL) {
+        return;
+    }
+
+    release_trimmer(trimmer);
+    free(trimmer);
+}
+
+int string_trim_view(const String *str, const StringTrimmer *trimmer, int sides, String *view) {
+    if (str == NULL || trimmer == NULL || view == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    /* offsets reachable by runs of patterns, only needed for multi-byte patterns */
+    unsigned char small_ring[TRIM_RING_STACK_SIZE];
+    unsigned char *reachable = small_ring;
+    if (!trimmer->single_bytes && trimmer->forward->max_pattern_len + 1 > TRIM_RING_STACK_SIZE) {
+        reachable = malloc(trimmer->forward->max_pattern_len + 1);
+        if (reachable == NULL) {
+            errno = ENOMEM;
+            return ENOMEM;
+        }
+    }
+
+    size_t start = (sides & STRING_TRIM_LEFT) ? find_start_after_trim(str, trimmer, reachable) : 0;
+    size_t end = (sides & STRING_TRIM_RIGHT) ? find_end_after_trim(str, trimmer, reachable) : str->len;
+
+    if (reachable != small_ring) {
+        free(reachable);
+    }
+
+    if (end < start) {
+        end = start;  /* both sides overlapped (e.g. "aba" with "ab" and "ba") */
+    }
+
+    view->chars = str->chars + start;
+    view->len = end - start;
+
+    return 0;
+}
+
+String *string_trim_with(const String *str, const StringTrimmer *trimmer) {
+    String view;
+    if (string_trim_view(str, trimmer, STRING_TRIM_BOTH, &view) != 0) {
+        return NULL;
+    }
+
+    return create_string(view.chars, view.len);
+}
+
+/* one-shot trims compile to_trim on the stack and share string_trim_view */
+static String *trim_sides(const String *str, const StringList *to_trim, int sides) {
     if (str == NULL || to_trim == NULL) {
         errno = EFAULT;
         return NULL;
     }
 
-    size_t end = find_end_after_trim(str, to_trim);
-    return create_string(str->chars, end);
+    StringTrimmer t;
+    if (init_trimmer(&t, to_trim) != 0) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    String view;
+    if (string_trim_view(str, &t, sides, &view) != 0) {  /* errno already set by string_trim_view */
+        release_trimmer(&t);
+        return NULL;
+    }
+    release_trimmer(&t);
+
+    return create_string(view.chars, view.len);
+}
+
+String *string_ltrim(const String *str, const StringList *to_trim) {
+    return trim_sides(str, to_trim, STRING_TRIM_LEFT);
+}
+
+String *string_rtrim(const String *str, const StringList *to_trim) {
+    return trim_sides(str, to_trim, STRING_TRIM_RIGHT);
 }
 
 String *string_trim(const String *str, const StringList *to_trim) {
-    if (str == NULL || to_trim == NULL) {
+    return trim_sides(str, to_trim, STRING_TRIM_BOTH);
+}
+
+static int is_whitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+String *string_trim_whitespace(const String *str) {
+    if (str == NULL) {
         errno = EFAULT;
         return NULL;
     }
 
-    size_t start = find_start_after_trim(str, to_trim);
-    size_t end = find_end_after_trim(str, to_trim);
+    size_t start = 0, end = str->len;
 
-    if (end <= start) {
-        return create_string("", 0);
+    while (start < end && is_whitespace(str->chars[start])) {
+        start++;
+    }
+    while (end > start && is_whitespace(str->chars[end - 1])) {
+        end--;
     }
 
-    return substring(str, start, end);
+    return create_string(str->chars + start, end - start);
 }
@@ -1,18 +1,39 @@
+#define _DEFAULT_SOURCE  /* sysconf(_SC_NPROCESSORS_ONLN), wait4 */
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <ilc/test.h>
 
+#define SLOWEST_TESTS_SHOWN 5
+
 typedef struct {
     const char *name;
     int (*run)();
+
+    /* filled in by run_test_suite, for the reports */
+    int ran;
+    int passed;
+    int timed_out;
+    int status;  /* as from wait */
+    double wall_time;  /* seconds */
+    struct rusage usage;
 } Test;
 
 struct _test_suite {
     const char *name;
     Test **tests;
     unsigned int num_tests;
+    unsigned int jobs;  /* most tests run at once, 0 for one per core */
+    double timeout;  /* seconds before a test is killed, 0 for no limit */
 };
 
 
@@ -25,6 +46,8 @@ TestSuite *create_test_suite(const char *name) {
     suite->name = name;  /* name should be a string literal in scope as long as the test suite */
     suite->tests = NULL;
     suite->num_tests = 0;
+    suite->jobs = 0;
+    suite->timeout = 0;
 
     return suite;
 }
@@ -50,6 +73,7 @@ static Test *create_test(const char *name, int (*run)()) {
     Test *test = malloc(sizeof(Test));
     test->name = name;  /* name should be a string literal in scope as long as the test suite it belongs to */
     test->run = run;
+    test->ran = 0;
     return test;
 }
 
@@ -65,62 +89,447 @@ void suite_add_test(TestSuite *suite, const char *test_name, int (*run)()) {
     suite->tests[suite->num_tests - 1] = create_test(test_name, run);
 }
 
+/* a forked test, its buffered stdout, and how it ended */
+typedef struct {
+    pid_t pid;
+    int fd;  /* read end of the pipe the child's stdout goes to, -1 once closed */
+    char *output;
+    size_t output_len;
+    size_t output_capacity;
+    int status;
+    int finished;
+    int timed_out;
+    double started;  /* seconds, on the monotonic clock */
+    double wall_time;  /* seconds from fork to reaping */
+    struct rusage usage;  /* cpu time and max rss of the child */
+} TestRun;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double timeval_seconds(struct timeval tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void start_test(TestSuite *suite, unsigned int i, TestRun *run) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("run_test_suite: failed to create pipe for test output");
+        exit(EXIT_FAILURE);
+    }
+
+    fflush(stdout);
+    pid_t fork_result = fork();
+
+    if (fork_result < 0) {
+        fprintf(stderr, "run_test_suite: failed to create test environment (fork returned %d)\n", fork_result);
+        exit(EXIT_FAILURE);
+    } else if (fork_result == 0) {  /* child */
+        close(fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[1]);
+        setvbuf(stdout, NULL, _IOLBF, 0);  /* a pipe is fully buffered, which a crash or kill would lose */
+
+        int test_result = suite->tests[i]->run();
+        free_test_suite(suite);  /* not strictly necessary, but makes finding real memory leaks easier */
+        exit(test_result);
+    }
+
+    close(fds[1]);
+    run->started = now_seconds();
+    run->pid = fork_result;
+    run->fd = fds[0];
+}
+
+/* read what's available from a child, and reap it once its output ends */
+static int read_test_output(TestRun *run) {
+    if (run->output_len == run->output_capacity) {
+        run->output_capacity = run->output_capacity == 0 ? 4096 : run->output_capacity * 2;
+        run->output = realloc(run->output, run->output_capacity);
+        if (run->output == NULL) {
+            fprintf(stderr, "run_test_suite: failed to buffer test output (realloc failed)\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    ssize_t bytes_read = read(run->fd, run->output + run->output_len, run->output_capacity - run->output_len);
+    if (bytes_read > 0) {
+        run->output_len += bytes_read;
+        return 0;
+    }
+    if (bytes_read < 0 && errno == EINTR) {
+        return 0;
+    }
+
+    close(run->fd);
+    run->fd = -1;
+    while (wait4(run->pid, &run->status, 0, &run->usage) < 0 && errno == EINTR) {
+    }
+    run->wall_time = now_seconds() - run->started;
+    run->finished = 1;
+
+    return 1;
+}
+
+static void print_test_header(const char *name, int verbose) {
+    if (verbose) {
+        printf("\n");
+    }
+    printf(COLOR_TEXT(BLUE, "%s"), name);
+    if (verbose) {
+        printf(":\n");
+    } else {
+        printf("...");
+    }
+}
+
+/* returns 1 if the test passed */
+static int print_test_result(const TestRun *run, int verbose) {
+    int test_result;
+    if (WIFEXITED(run->status)) {
+        test_result = WEXITSTATUS(run->status);
+    } else {
+        if (verbose && WIFSIGNALED(run->status) && WTERMSIG(run->status) == 11) {  /* 11 is SIGSEGV */
+            printf("    test had a " COLOR_TEXT(RED, "segmentation fault") "\n");
+        }
+
+        test_result = FAILURE;
+    }
+
+    int test_passed = test_result == SUCCESS ? 1 : 0;
+    const char *result_text = (test_passed ? COLOR_TEXT(GREEN, "PASSED") : COLOR_TEXT(RED, "FAILED"));
+
+    if (verbose) {
+        printf("Result: %s", result_text);
+    } else {
+        printf("%s", result_text);
+    }
+
+    if (run->timed_out) {
+        printf(" (" COLOR_TEXT(RED, "timed out") " after %.3f s)\n", run->wall_time);
+    } else if (verbose) {
+        printf(" (%.3f s wall, %.3f s user, %.3f s sys, %ld KB max rss)\n", run->wall_time,
+               timeval_seconds(run->usage.ru_utime), timeval_seconds(run->usage.ru_stime), run->usage.ru_maxrss);
+    } else {
+        printf(" (%.3f s)\n", run->wall_time);
+    }
+
+    return test_passed;
+}
+
+static void record_result(Test *test, const TestRun *run, int passed) {
+    test->ran = 1;
+    test->passed = passed;
+    test->timed_out = run->timed_out;
+    test->status = run->status;
+    test->wall_time = run->wall_time;
+    test->usage = run->usage;
+}
+
+static int compare_wall_times(const void *a, const void *b) {
+    double x = (*(Test * const *) a)->wall_time, y = (*(Test * const *) b)->wall_time;
+    return (x < y) - (x > y);  /* slowest first */
+}
+
+static void print_slowest_tests(const TestSuite *suite) {
+    if (suite->num_tests == 0) {
+        return;
+    }
+
+    Test **by_time = malloc(suite->num_tests * sizeof(Test *));
+    if (by_time == NULL) {
+        fprintf(stderr, "run_test_suite: failed to sort test times\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(by_time, suite->tests, suite->num_tests * sizeof(Test *));
+    qsort(by_time, suite->num_tests, sizeof(Test *), compare_wall_times);
+
+    printf("Slowest tests:\n");
+    unsigned int i;
+    for (i = 0; i < suite->num_tests && i < SLOWEST_TESTS_SHOWN; i++) {
+        const Test *test = by_time[i];
+        printf("    %8.3f s  " COLOR_TEXT(BLUE, "%s") "  (%.3f s user, %.3f s sys, %ld KB max rss)\n",
+               test->wall_time, test->name, timeval_seconds(test->usage.ru_utime),
+               timeval_seconds(test->usage.ru_stime), test->usage.ru_maxrss);
+    }
+
+    free(by_time);
+}
+
+void suite_set_jobs(TestSuite *suite, unsigned int jobs) {
+    suite->jobs = jobs;
+}
+
+void suite_set_timeout(TestSuite *suite, double seconds) {
+    suite->timeout = seconds > 0 ? seconds : 0;
+}
+
+/* kill tests past the suite's timeout, returns ms until the next one is due or -1 for none */
+static int enforce_timeout(TestSuite *suite, TestRun *runs, const unsigned int *polled, unsigned int num_fds) {
+    if (suite->timeout == 0) {
+        return -1;
+    }
+
+    int poll_timeout = -1;
+    double now = now_seconds();
+    unsigned int i;
+    for (i = 0; i < num_fds; i++) {
+        TestRun *run = &runs[polled[i]];
+        if (run->timed_out) {
+            continue;  /* already killed, poll sees its pipe close */
+        }
+
+        double remaining = run->started + suite->timeout - now;
+        if (remaining <= 0) {
+            kill(run->pid, SIGKILL);
+            run->timed_out = 1;
+            continue;
+        }
+
+        int ms = (int) (remaining * 1000) + 1;
+        if (poll_timeout < 0 || ms < poll_timeout) {
+            poll_timeout = ms;
+        }
+    }
+
+    return poll_timeout;
+}
+
 void run_test_suite(TestSuite *suite, int verbose) {
     unsigned int i, num_passed = 0;
 
     printf("=== " COLOR_TEXT(BLUE_HL, "%s") " ===\n", suite->name);
 
-    for (i = 0; i < suite->num_tests; i++) {
-        int test_result;
-        pid_t fork_result;
+    unsigned int jobs = suite->jobs;
+    if (jobs == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = cores > 0 ? cores : 1;
+    }
+
+    TestRun *runs = calloc(suite->num_tests, sizeof(TestRun));
+    struct pollfd *fds = malloc(jobs * sizeof(struct pollfd));
+    unsigned int *polled = malloc(jobs * sizeof(unsigned int));  /* index of the test behind each pollfd */
+    if ((runs == NULL && suite->num_tests > 0) || fds == NULL || polled == NULL) {
+        fprintf(stderr, "run_test_suite: failed to allocate test runs\n");
+        exit(EXIT_FAILURE);
+    }
 
-        if (verbose) {
-            printf("\n");
+    /*
+     * Up to jobs tests run at once, but results are printed in the order the
+     * tests were added. The earliest unreported test's output is printed as
+     * it arrives, later tests' output waits in their buffers until it's their
+     * turn, so each test's output stays together.
+     */
+    unsigned int next_start = 0, next_report = 0, num_running = 0;
+    int header_printed = 0;
+    while (next_report < suite->num_tests) {
+        while (num_running < jobs && next_start < suite->num_tests) {
+            start_test(suite, next_start, &runs[next_start]);
+            next_start++;
+            num_running++;
         }
-        printf(COLOR_TEXT(BLUE, "%s"), suite->tests[i]->name);
-        if (verbose) {
-            printf(":\n");
-        } else {
-            printf("...");
+
+        while (next_report < suite->num_tests) {
+            TestRun *run = &runs[next_report];
+            if (!header_printed) {
+                print_test_header(suite->tests[next_report]->name, verbose);
+                header_printed = 1;
+            }
+
+            fwrite(run->output, 1, run->output_len, stdout);
+            run->output_len = 0;
+            fflush(stdout);
+
+            if (!run->finished) {
+                break;
+            }
+
+            int passed = print_test_result(run, verbose);
+            record_result(suite->tests[next_report], run, passed);
+            num_passed += passed;
+            free(run->output);
+            run->output = NULL;
+            next_report++;
+            header_printed = 0;
         }
 
-        fflush(stdout);
-        fork_result = fork();
+        unsigned int num_fds = 0;
+        for (i = next_report; i < next_start; i++) {
+            if (!runs[i].finished) {
+                fds[num_fds].fd = runs[i].fd;
+                fds[num_fds].events = POLLIN;
+                polled[num_fds] = i;
+                num_fds++;
+            }
+        }
 
-        if (fork_result < 0) {
-            fprintf(stderr, "run_test_suite: failed to create test environment (fork returned %d)\n", fork_result);
+        if (num_fds == 0) {
+            continue;
+        }
+
+        int poll_timeout = enforce_timeout(suite, runs, polled, num_fds);
+        if (poll(fds, num_fds, poll_timeout) < 0 && errno != EINTR) {
+            perror("run_test_suite: poll failed");
             exit(EXIT_FAILURE);
-        } else if (fork_result != 0) {  /* parent */
-            int status;
-            wait(&status);
-
-            if (WIFEXITED(status)) {
-                test_result = WEXITSTATUS(status);
-            } else {
-                if (verbose && WIFSIGNALED(status) && WTERMSIG(status) == 11) {  /* 11 is SIGSEGV */
-                    printf("    test had a " COLOR_TEXT(RED, "segmentation fault") "\n");
-                }
-
-                test_result = FAILURE;
+        }
+
+        for (i = 0; i < num_fds; i++) {
+            if (fds[i].revents != 0 && read_test_output(&runs[polled[i]])) {
+                num_running--;
             }
-        } else {  /* child */
-            test_result = suite->tests[i]->run();
-            free_test_suite(suite);  /* not strictly necessary, but makes finding real memory leaks easier */
-            exit(test_result);
         }
+    }
+
+    printf("\n" COLOR_TEXT(BLUE_HL, "%s") ": %d of %d tests passed\n", suite->name, num_passed, suite->num_tests);
+    print_slowest_tests(suite);
+
+    free(runs);
+    free(fds);
+    free(polled);
+
+    FILE *tap = open_report_file(suite->name, "tap");
+    if (tap != NULL) {
+        suite_write_tap(suite, tap);
+        fclose(tap);
+    }
+
+    FILE *junit = open_report_file(suite->name, "xml");
+    if (junit != NULL) {
+        suite_write_junit(suite, junit);
+        fclose(junit);
+    }
+}
+
+/* why a test failed, in a few words */
+static void describe_failure(const Test *test, char *buf, size_t size) {
+    if (test->timed_out) {
+        snprintf(buf, size, "timed out");
+    } else if (WIFSIGNALED(test->status) && WTERMSIG(test->status) == SIGSEGV) {
+        snprintf(buf, size, "segmentation fault");
+    } else if (WIFSIGNALED(test->status)) {
+        snprintf(buf, size, "killed by signal %d", WTERMSIG(test->status));
+    } else {
+        snprintf(buf, size, "exited with status %d", WEXITSTATUS(test->status));
+    }
+}
+
+void suite_write_tap(const TestSuite *suite, FILE *out) {
+    fprintf(out, "TAP version 13\n");
+    fprintf(out, "1..%u\n", suite->num_tests);
+
+    unsigned int i;
+    for (i = 0; i < suite->num_tests; i++) {
+        const Test *test = suite->tests[i];
+        if (!test->ran) {
+            fprintf(out, "not ok %u - %s # SKIP not run\n", i + 1, test->name);
+            continue;
+        }
+
+        fprintf(out, "%s %u - %s\n", test->passed ? "ok" : "not ok", i + 1, test->name);
+        fprintf(out, "  ---\n");
+        if (!test->passed) {
+            char reason[64];
+            describe_failure(test, reason, sizeof(reason));
+            fprintf(out, "  message: \"%s\"\n", reason);
+        }
+        fprintf(out, "  duration_ms: %.3f\n", test->wall_time * 1e3);
+        fprintf(out, "  user_ms: %.3f\n", timeval_seconds(test->usage.ru_utime) * 1e3);
+        fprintf(out, "  sys_ms: %.3f\n", timeval_seconds(test->usage.ru_stime) * 1e3);
+        fprintf(out, "  max_rss_kb: %ld\n", test->usage.ru_maxrss);
+        fprintf(out, "  ...\n");
+    }
+}
+
+static void write_xml_escaped(FILE *out, const char *text) {
+    for (; *text != '\0'; text++) {
+        switch (*text) {
+            case '&': fputs("&amp;", out); break;
+            case '<': fputs("&lt;", out); break;
+            case '>': fputs("&gt;", out); break;
+            case '"': fputs("&quot;", out); break;
+            case '\'': fputs("&apos;", out); break;
+            default: fputc(*text, out);
+        }
+    }
+}
+
+void suite_write_junit(const TestSuite *suite, FILE *out) {
+    unsigned int i, num_failed = 0, num_skipped = 0;
+    double total_time = 0;
+    for (i = 0; i < suite->num_tests; i++) {
+        if (!suite->tests[i]->ran) {
+            num_skipped++;
+        } else if (!suite->tests[i]->passed) {
+            num_failed++;
+        }
+        total_time += suite->tests[i]->ran ? suite->tests[i]->wall_time : 0;
+    }
 
-        int test_passed = test_result == SUCCESS ? 1 : 0;
-        num_passed += test_passed;
-        const char *result_text = (test_passed ? COLOR_TEXT(GREEN, "PASSED") : COLOR_TEXT(RED, "FAILED"));
+    fprintf(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(out, "<testsuites>\n");
+    fprintf(out, "  <testsuite name=\"");
+    write_xml_escaped(out, suite->name);
+    fprintf(out, "\" tests=\"%u\" failures=\"%u\" skipped=\"%u\" time=\"%.3f\">\n",
+            suite->num_tests, num_failed, num_skipped, total_time);
 
-        if (verbose) {
-            printf("Result: %s\n", result_text);
+    for (i = 0; i < suite->num_tests; i++) {
+        const Test *test = suite->tests[i];
+        fprintf(out, "    <testcase classname=\"");
+        write_xml_escaped(out, suite->name);
+        fprintf(out, "\" name=\"");
+        write_xml_escaped(out, test->name);
+        fprintf(out, "\" time=\"%.3f\"", test->ran ? test->wall_time : 0);
+
+        if (!test->ran) {
+            fprintf(out, ">\n      <skipped/>\n    </testcase>\n");
+        } else if (!test->passed) {
+            char reason[64];
+            describe_failure(test, reason, sizeof(reason));
+            fprintf(out, ">\n      <failure message=\"%s\"/>\n    </testcase>\n", reason);
         } else {
-            printf("%s\n", result_text);
+            fprintf(out, "/>\n");
         }
     }
 
-    printf("\n" COLOR_TEXT(BLUE_HL, "%s") ": %d of %d tests passed\n", suite->name, num_passed, suite->num_tests);
+    fprintf(out, "  </testsuite>\n");
+    fprintf(out, "</testsuites>\n");
+}
+
+FILE *open_report_file(const char *suite_name, const char *extension) {
+    const char *dir = getenv(REPORT_DIR_ENV);
+    if (dir == NULL || *dir == '\0') {
+        return NULL;
+    }
+
+    mkdir(dir, 0777);  /* fopen says why if this didn't work and it doesn't already exist */
+
+    size_t path_size = strlen(dir) + strlen(suite_name) + strlen(extension) + 3;
+    char *path = malloc(path_size);
+    if (path == NULL) {
+        return NULL;
+    }
+
+    /* "string tests" in build/report becomes build/report/string_tests.xml */
+    int prefix_len = snprintf(path, path_size, "%s/", dir);
+    snprintf(path + prefix_len, path_size - prefix_len, "%s.%s", suite_name, extension);
+    size_t i;
+    for (i = prefix_len; i < prefix_len + strlen(suite_name); i++) {
+        if (path[i] == ' ' || path[i] == '/') {
+            path[i] = '_';
+        }
+    }
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "could not write report %s: %s\n", path, strerror(errno));
+    }
+
+    free(path);
+    return file;
 }
 
 int check_mem_equal(const void *actual, const void *expected, size_t size) {
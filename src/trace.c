@@ -0,0 +1,171 @@
+#define _POSIX_C_SOURCE 200809L  /* clock_gettime */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <ilc/trace.h>
+
+typedef struct {
+    const char *name;  /* NULL for an end */
+    uint64_t ns;
+} TraceEvent;
+
+/*
+ * One thread's events. Only the owning thread writes events and head, the
+ * writer publishes head with a release store after the event it covers, so
+ * a reader that loads head with acquire sees every event before it.
+ */
+typedef struct _trace_ring {
+    TraceEvent events[TRACE_RING_SIZE];
+    size_t head;  /* events ever recorded, the next goes in events[head % TRACE_RING_SIZE] */
+    unsigned int tid;  /* stays with the ring, so a reused ring is one lane in the viewer */
+    int in_use;  /* 1 while a live thread owns the ring */
+    struct _trace_ring *next;
+} TraceRing;
+
+static TraceRing *rings;  /* every ring ever made, newest first, never freed */
+static unsigned int num_rings;
+static pthread_key_t ring_key;
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static __thread TraceRing *my_ring;
+
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* the thread is exiting, its ring can go to the next new thread */
+static void release_ring(void *ring) {
+    __atomic_store_n(&((TraceRing *) ring)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void write_trace_file(void) {
+    const char *path = getenv(TRACE_FILE_ENV);
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        perror(path);
+        return;
+    }
+
+    trace_write_chrome_json(out);
+    fclose(out);
+}
+
+static void init_tracing(void) {
+    pthread_key_create(&ring_key, release_ring);
+
+    const char *path = getenv(TRACE_FILE_ENV);
+    if (path != NULL && *path != '\0') {
+        atexit(write_trace_file);
+    }
+}
+
+/* a released ring if there is one, otherwise a new one */
+static TraceRing *claim_ring(void) {
+    pthread_once(&init_once, init_tracing);
+
+    TraceRing *ring;
+    for (ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+        int free_ring = 0;
+        if (__atomic_compare_exchange_n(&ring->in_use, &free_ring, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (ring == NULL) {
+        ring = calloc(1, sizeof(TraceRing));
+        if (ring == NULL) {
+            return NULL;  /* this thread goes untraced */
+        }
+
+        ring->in_use = 1;
+        ring->tid = __atomic_fetch_add(&num_rings, 1, __ATOMIC_RELAXED);
+        ring->next = __atomic_load_n(&rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&rings, &ring->next, ring, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+
+    pthread_setspecific(ring_key, ring);
+    return ring;
+}
+
+static void record(const char *name) {
+    TraceRing *ring = my_ring;
+    if (ring == NULL) {
+        ring = my_ring = claim_ring();
+        if (ring == NULL) {
+            return;
+        }
+    }
+
+    size_t head = ring->head;
+    TraceEvent *event = &ring->events[head % TRACE_RING_SIZE];
+    event->name = name;
+    event->ns = now_ns();
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void trace_begin(const char *name) {
+    record(name);
+}
+
+void trace_end(void) {
+    record(NULL);
+}
+
+/* write one ring's events, skipping any the owner overwrote while they were copied */
+static void write_ring(FILE *out, const TraceRing *ring, int pid, int *first) {
+    size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    size_t start = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+
+    size_t i;
+    for (i = start; i < head; i++) {
+        TraceEvent event = ring->events[i % TRACE_RING_SIZE];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        /* the writer may have lapped us, in which case this slot holds a newer event */
+        size_t now_head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        if (now_head > TRACE_RING_SIZE && i < now_head - TRACE_RING_SIZE) {
+            continue;
+        }
+
+        fprintf(out, "%s\n", *first ? "" : ",");
+        *first = 0;
+        if (event.name != NULL) {
+            fprintf(out, "{\"name\": \"%s\", \"ph\": \"B\", \"pid\": %d, \"tid\": %u, \"ts\": %.3f}",
+                    event.name, pid, ring->tid, event.ns / 1e3);
+        } else {
+            fprintf(out, "{\"ph\": \"E\", \"pid\": %d, \"tid\": %u, \"ts\": %.3f}", pid, ring->tid, event.ns / 1e3);
+        }
+    }
+}
+
+int trace_write_chrome_json(FILE *out) {
+    if (out == NULL) {
+        errno = EFAULT;
+        return EFAULT;
+    }
+
+    int pid = getpid();
+    int first = 1;
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+
+    const TraceRing *ring;
+    for (ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+        write_ring(out, ring, pid, &first);
+    }
+
+    fprintf(out, "\n]}\n");
+
+    if (fflush(out) != 0 || ferror(out)) {
+        errno = EIO;
+        return EIO;
+    }
+
+    return 0;
+}
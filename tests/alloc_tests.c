@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ilc/alloc.h>
+#include <ilc/test.h>
+
+/* the tracked functions are called directly, so these run with or without TRACK_ALLOCS */
+#define NUM_THREADS 4
+#define ALLOCS_PER_THREAD 10000
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+static int alloc_counts_test() {
+    AllocStats before = alloc_stats();
+
+    char *block = alloc_tracked_malloc(100, __FILE__, __LINE__);
+    int *zeroed = alloc_tracked_calloc(4, 25, __FILE__, __LINE__);
+    block = alloc_tracked_realloc(block, 200, __FILE__, __LINE__);
+    char *from_null = alloc_tracked_realloc(NULL, 50, __FILE__, __LINE__);
+    AllocStats used = alloc_stats_diff(before, alloc_stats());
+
+    alloc_tracked_free(block);
+    alloc_tracked_free(zeroed);
+    alloc_tracked_free(from_null);
+    alloc_tracked_free(NULL);
+    AllocStats all = alloc_stats_diff(before, alloc_stats());
+
+    if (VERBOSE) {
+        printf("    allocations %lu, reallocations %lu, frees %lu, bytes requested %lu, live bytes %lu\n",
+               all.allocations, all.reallocations, all.frees, all.bytes_requested, used.live_bytes);
+    }
+
+    int test_results[] = {
+        check("malloc, calloc, and realloc(NULL) are allocations", all.allocations == 3),
+        check("realloc of a block is a reallocation", all.reallocations == 1),
+        check("free(NULL) isn't counted", all.frees == 3),
+        check("bytes requested", all.bytes_requested == 100 + 100 + 200 + 50),
+#ifdef __GLIBC__
+        check("live bytes while allocated", used.live_bytes >= 200 + 100 + 50),
+#endif
+        check("nothing live after freeing", all.live_bytes == 0),
+    };
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int alloc_peak_test() {
+    alloc_reset_peak();
+    AllocStats before = alloc_stats();
+
+    void *blocks[3];
+    int i;
+    for (i = 0; i < 3; i++) {
+        blocks[i] = alloc_tracked_malloc(1000, __FILE__, __LINE__);
+    }
+    for (i = 0; i < 3; i++) {
+        alloc_tracked_free(blocks[i]);
+    }
+
+    AllocStats used = alloc_stats_diff(before, alloc_stats());
+    if (VERBOSE) {
+        printf("    peak live bytes %lu\n", used.peak_live_bytes);
+    }
+
+    int test_results[] = {
+#ifdef __GLIBC__
+        check("peak covers all three blocks", used.peak_live_bytes >= 3000),
+#endif
+        check("peak stays after freeing", used.peak_live_bytes >= used.live_bytes),
+        check("reset peak", (alloc_reset_peak(), alloc_stats().peak_live_bytes == alloc_stats().live_bytes)),
+    };
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static void *allocate_and_free(void *arg) {
+    (void) arg;
+    int i;
+    for (i = 0; i < ALLOCS_PER_THREAD; i++) {
+        void *block = alloc_tracked_malloc(i % 64 + 1, __FILE__, __LINE__);
+        alloc_tracked_free(block);
+    }
+
+    return NULL;
+}
+
+static int alloc_threads_test() {
+    AllocStats before = alloc_stats();
+
+    pthread_t threads[NUM_THREADS];
+    int i;
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, allocate_and_free, NULL);
+    }
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    AllocStats used = alloc_stats_diff(before, alloc_stats());
+    if (VERBOSE) {
+        alloc_print_sites(stdout, 3);
+    }
+
+    int test_results[] = {
+        check("no allocations lost", used.allocations == NUM_THREADS * ALLOCS_PER_THREAD),
+        check("no frees lost", used.frees == NUM_THREADS * ALLOCS_PER_THREAD),
+        check("nothing live after", used.live_bytes == 0),
+    };
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *alloc_tests = create_test_suite("alloc tests");
+    suite_add_test(alloc_tests, "alloc counts", alloc_counts_test);
+    suite_add_test(alloc_tests, "alloc peak", alloc_peak_test);
+    suite_add_test(alloc_tests, "alloc threads", alloc_threads_test);
+    run_test_suite(alloc_tests, VERBOSE);
+    free_test_suite(alloc_tests);
+
+    return 0;
+}
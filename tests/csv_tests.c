@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/string.h>
+#include <ilc/dynarray.h>
+#include <ilc/csv.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+/* records flattened to "field|field;field|field;" so they're easy to compare */
+typedef struct {
+    char text[4096];
+    size_t len;
+    size_t max_records;
+    size_t num_records;
+} Flattened;
+
+static void flatten_chars(Flattened *flat, const char *chars, size_t len) {
+    if (flat->len + len < sizeof(flat->text)) {
+        memcpy(flat->text + flat->len, chars, len);
+        flat->len += len;
+    }
+}
+
+static int flatten_record(const String *fields, size_t num_fields, void *ctx) {
+    Flattened *flat = ctx;
+
+    size_t i;
+    for (i = 0; i < num_fields; i++) {
+        if (i > 0) {
+            flatten_chars(flat, "|", 1);
+        }
+        flatten_chars(flat, fields[i].chars, fields[i].len);
+    }
+    flatten_chars(flat, ";", 1);
+
+    flat->num_records++;
+    return flat->num_records == flat->max_records;
+}
+
+static int csv_parse_test_examples(char delim, const char *input, size_t max_records,
+                                   const char *expected, int expected_errno) {
+    CsvParser *parser = create_csv_parser(delim);
+
+    String str;
+    str.chars = (char *)input;
+    str.len = strlen(input);
+
+    Flattened flat;
+    flat.len = 0;
+    flat.max_records = max_records;
+    flat.num_records = 0;
+
+    errno = 0;
+    int result = csv_parse(parser, &str, flatten_record, &flat);
+    flat.text[flat.len] = '\0';
+
+    int test_ok = result == expected_errno && (expected_errno != 0 || strcmp(flat.text, expected) == 0);
+
+    if (VERBOSE) {
+        const char *status = test_ok ?
+            COLOR_TEXT(GREEN, "passed") :
+            COLOR_TEXT(RED, "failed");
+        printf("    csv_parse('%c', \"%s\") %s\n", delim, input, status);
+
+        if (!test_ok) {
+            printf("        " COLOR_TEXT(RED, "returned %d with \"%s\", expected %d with \"%s\"") "\n",
+                   result, flat.text, expected_errno, expected);
+        }
+    }
+
+    free_csv_parser(parser);
+
+    return test_ok;
+}
+
+static int csv_parse_test() {
+    int test_results[] = {
+        csv_parse_test_examples(',', "a,b,c\n1,2,3\n", 0, "a|b|c;1|2|3;", 0),
+        csv_parse_test_examples(',', "a,b,c\r\n1,2,3", 0, "a|b|c;1|2|3;", 0),
+        csv_parse_test_examples(',', "", 0, "", 0),
+        csv_parse_test_examples(',', "\n", 0, ";", 0),
+        csv_parse_test_examples(',', "a,,\n,b", 0, "a||;|b;", 0),
+        csv_parse_test_examples(',', "\"a,b\",\"c\nd\"\n", 0, "a,b|c\nd;", 0),
+        csv_parse_test_examples(',', "\"say \"\"hi\"\"\",x", 0, "say \"hi\"|x;", 0),
+        csv_parse_test_examples(',', "\"\",\"\"\"\"", 0, "|\";", 0),
+        csv_parse_test_examples(',', "\"crlf\"\r\nnext", 0, "crlf;next;", 0),
+        csv_parse_test_examples(',', "a,\"unterminated\nb", 0, NULL, EINVAL),
+        csv_parse_test_examples(',', "1\n2\n3\n", 2, "1;2;", 0),
+        csv_parse_test_examples('\t', "a\tb,c\n\"d\te\"\tf", 0, "a|b,c;d\te|f;", 0),
+    };
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+/* quotes, delimiters, and escapes landing on every position around 64 byte block edges */
+static int csv_block_boundary_test() {
+    char input[4096];
+    char expected[4096];
+    size_t input_len = 0, expected_len = 0;
+
+    int i;
+    for (i = 0; i < 100; i++) {
+        int padding = i % 7;
+        int j;
+        for (j = 0; j < padding; j++) {
+            input[input_len++] = 'x';
+            expected[expected_len++] = 'x';
+        }
+
+        const char *quoted = ",\"q,\"\"\n\",y\n";
+        memcpy(input + input_len, quoted, strlen(quoted));
+        input_len += strlen(quoted);
+
+        const char *flattened = "|q,\"\n|y;";
+        memcpy(expected + expected_len, flattened, strlen(flattened));
+        expected_len += strlen(flattened);
+    }
+    input[input_len] = '\0';
+    expected[expected_len] = '\0';
+
+    int test_results[] = {
+        csv_parse_test_examples(',', input, 0, expected, 0),
+    };
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int csv_columns_test() {
+    CsvParser *parser = create_csv_parser(',');
+
+    const char *cinput = "name,quote\nann,\"said \"\"hi\"\"\"\nbo,\"plain\"\n";
+    String input;
+    input.chars = (char *)cinput;
+    input.len = strlen(cinput);
+
+    DynArray *columns[2];
+    columns[0] = create_dynarray(sizeof(String));
+    columns[1] = create_dynarray(sizeof(String));
+
+    int result = csv_parse_columns(parser, &input, columns, 2);
+
+    String *said = dynarray_item_at(columns[1], 1);
+    String *plain = dynarray_item_at(columns[1], 2);
+    String *bo = dynarray_item_at(columns[0], 2);
+
+    int columns_ok = result == 0 && dynarray_length(columns[0]) == 3 &&
+                     dynarray_length(columns[1]) == 3 &&
+                     said->len == 9 && check_mem_equal(said->chars, "said \"hi\"", 9) &&
+                     plain->len == 5 && check_mem_equal(plain->chars, "plain", 5) &&
+                     bo->len == 2 && bo->chars == strstr(cinput, "bo,");
+
+    const char *cragged = "a,b\nc\n";
+    String ragged;
+    ragged.chars = (char *)cragged;
+    ragged.len = strlen(cragged);
+
+    errno = 0;
+    int ragged_ok = csv_parse_columns(parser, &ragged, columns, 2) == EINVAL && errno == EINVAL &&
+                    dynarray_length(columns[0]) == 4;
+
+    errno = 0;
+    int null_ok = csv_parse_columns(parser, NULL, columns, 2) == EFAULT && errno == EFAULT &&
+                  create_csv_parser('"') == NULL && errno == EINVAL;
+
+    int test_results[] = {
+        columns_ok,
+        ragged_ok,
+        null_ok,
+    };
+
+    if (VERBOSE) {
+        const char *names[] = {"parse into columns", "ragged record is EINVAL", "bad arguments"};
+        size_t i;
+        for (i = 0; i < sizeof(test_results) / sizeof(int); i++) {
+            printf("    %s %s\n", names[i],
+                   test_results[i] ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+        }
+    }
+
+    free_dynarray(columns[0]);
+    free_dynarray(columns[1]);
+    free_csv_parser(parser);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *csv_tests = create_test_suite("csv tests");
+    suite_add_test(csv_tests, "csv parse", csv_parse_test);
+    suite_add_test(csv_tests, "csv block boundaries", csv_block_boundary_test);
+    suite_add_test(csv_tests, "csv columns", csv_columns_test);
+    run_test_suite(csv_tests, VERBOSE);
+    free_test_suite(csv_tests);
+
+    return 0;
+}
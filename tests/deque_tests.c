@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/deque.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+static int deque_ends_test() {
+    Deque *deque = create_deque_sized(sizeof(int), 3);
+    int i;
+    int push_ok = 1;
+    for (i = 0; i < 10; i++) {
+        push_ok = push_ok && deque_push_back(deque, &i) == 0;
+    }
+    for (i = -1; i >= -10; i--) {
+        push_ok = push_ok && deque_push_front(deque, &i) == 0;
+    }
+
+    /* -10 ... -1 0 ... 9 */
+    int order_ok = deque_length(deque) == 20;
+    for (i = 0; i < 20 && order_ok; i++) {
+        int *item = deque_item_at(deque, i);
+        order_ok = item != NULL && *item == i - 10;
+    }
+
+    int front, back;
+    int pop_ok = deque_pop_front(deque, &front) == 0 && front == -10 &&
+                 deque_pop_back(deque, &back) == 0 && back == 9 &&
+                 deque_pop_back(deque, NULL) == 0 && deque_length(deque) == 17;
+
+    while (deque_length(deque) > 0) {
+        deque_pop_front(deque, NULL);
+    }
+
+    errno = 0;
+    int empty_ok = deque_pop_front(deque, &front) == EINVAL && deque_pop_back(deque, &back) == EINVAL &&
+                   errno == EINVAL;
+    errno = 0;
+    int oob_ok = deque_item_at(deque, 0) == NULL && errno == EINVAL;
+    errno = 0;
+    int null_ok = deque_push_back(NULL, &i) == EFAULT && errno == EFAULT;
+
+    int test_results[] = {
+        check("push both ends", push_ok),
+        check("items in order", order_ok),
+        check("pop both ends", pop_ok),
+        check("pop empty is EINVAL", empty_ok),
+        check("item at out of range is EINVAL", oob_ok),
+        check("NULL deque is EFAULT", null_ok),
+    };
+
+    free_deque(deque);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+/* random pushes and pops, checked against a plain array with room on both sides */
+static int deque_random_test() {
+    int model[20000];
+    size_t model_start = 10000, model_end = 10000;
+
+    Deque *deque = create_deque(sizeof(int));
+    srand(38);
+
+    int ok = 1;
+    int step;
+    for (step = 0; step < 8000 && ok; step++) {
+        int op = rand() % 5;  /* pushes a bit more likely than pops, so it grows and wraps */
+        int item = rand();
+        if (op == 0) {
+            ok = deque_push_front(deque, &item) == 0;
+            model[--model_start] = item;
+        } else if (op == 1 || op == 2) {
+            ok = deque_push_back(deque, &item) == 0;
+            model[model_end++] = item;
+        } else if (model_start < model_end) {
+            int popped;
+            if (op == 3) {
+                ok = deque_pop_front(deque, &popped) == 0 && popped == model[model_start++];
+            } else {
+                ok = deque_pop_back(deque, &popped) == 0 && popped == model[--model_end];
+            }
+        }
+
+        ok = ok && deque_length(deque) == model_end - model_start;
+    }
+
+    size_t i;
+    for (i = 0; i < model_end - model_start && ok; i++) {
+        ok = *(int *) deque_item_at(deque, i) == model[model_start + i];
+    }
+
+    int test_results[] = {
+        check("random pushes and pops", ok),
+    };
+
+    free_deque(deque);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *deque_tests = create_test_suite("deque tests");
+    suite_add_test(deque_tests, "deque ends", deque_ends_test);
+    suite_add_test(deque_tests, "deque random", deque_random_test);
+    run_test_suite(deque_tests, VERBOSE);
+    free_test_suite(deque_tests);
+
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/gap_buffer.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+static int gap_buffer_matches(const GapBuffer *buf, const char *expected) {
+    size_t len = strlen(expected);
+    if (gap_buffer_length(buf) != len) {
+        return 0;
+    }
+
+    size_t i;
+    for (i = 0; i < len; i++) {
+        if (*(char *) gap_buffer_item_at(buf, i) != expected[i]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int gap_buffer_edit_test() {
+    GapBuffer *buf = create_gap_buffer_sized(sizeof(char), 4);
+
+    int insert_ok = gap_buffer_insert(buf, "hello world", 11) == 0 && gap_buffer_cursor(buf) == 11;
+    int text_ok = gap_buffer_matches(buf, "hello world");
+
+    /* typing in the middle */
+    int edit_ok = gap_buffer_move_cursor(buf, 5) == 0 && gap_buffer_insert(buf, ",", 1) == 0 &&
+                  gap_buffer_cursor(buf) == 6 && gap_buffer_matches(buf, "hello, world");
+
+    int backspace_ok = gap_buffer_move_cursor(buf, 12) == 0 && gap_buffer_delete_before(buf, 5) == 0 &&
+                       gap_buffer_insert(buf, "there", 5) == 0 && gap_buffer_matches(buf, "hello, there");
+
+    int delete_ok = gap_buffer_move_cursor(buf, 0) == 0 && gap_buffer_delete_after(buf, 7) == 0 &&
+                    gap_buffer_cursor(buf) == 0 && gap_buffer_matches(buf, "there");
+
+    errno = 0;
+    int oob_ok = gap_buffer_move_cursor(buf, 6) == EINVAL && gap_buffer_delete_before(buf, 1) == EINVAL &&
+                 gap_buffer_delete_after(buf, 6) == EINVAL && gap_buffer_item_at(buf, 5) == NULL &&
+                 errno == EINVAL;
+    errno = 0;
+    int null_ok = gap_buffer_insert(NULL, "x", 1) == EFAULT && errno == EFAULT;
+
+    int test_results[] = {
+        check("insert", insert_ok),
+        check("items", text_ok),
+        check("insert in the middle", edit_ok),
+        check("delete before cursor", backspace_ok),
+        check("delete after cursor", delete_ok),
+        check("out of range is EINVAL", oob_ok),
+        check("NULL gap buffer is EFAULT", null_ok),
+    };
+
+    free_gap_buffer(buf);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+/* random cursor moves and edits, checked against a plain array */
+static int gap_buffer_random_test() {
+    int model[20000];
+    size_t model_len = 0, cursor = 0;
+
+    GapBuffer *buf = create_gap_buffer(sizeof(int));
+    srand(38);
+
+    int ok = 1;
+    int step;
+    for (step = 0; step < 5000 && ok; step++) {
+        int op = rand() % 4;
+        if (op == 0) {
+            cursor = rand() % (model_len + 1);
+            ok = gap_buffer_move_cursor(buf, cursor) == 0;
+        } else if (op == 1) {
+            int items[8];
+            size_t count = rand() % 8, i;
+            for (i = 0; i < count; i++) {
+                items[i] = rand();
+            }
+            ok = gap_buffer_insert(buf, items, count) == 0;
+
+            memmove(model + cursor + count, model + cursor, (model_len - cursor) * sizeof(int));
+            memcpy(model + cursor, items, count * sizeof(int));
+            model_len += count;
+            cursor += count;
+        } else if (op == 2) {
+            size_t count = rand() % (cursor + 1) % 5;
+            ok = gap_buffer_delete_before(buf, count) == 0;
+
+            memmove(model + cursor - count, model + cursor, (model_len - cursor) * sizeof(int));
+            model_len -= count;
+            cursor -= count;
+        } else {
+            size_t count = rand() % (model_len - cursor + 1) % 5;
+            ok = gap_buffer_delete_after(buf, count) == 0;
+
+            memmove(model + cursor, model + cursor + count, (model_len - cursor - count) * sizeof(int));
+            model_len -= count;
+        }
+
+        ok = ok && gap_buffer_length(buf) == model_len && gap_buffer_cursor(buf) == cursor;
+    }
+
+    size_t i;
+    for (i = 0; i < model_len && ok; i++) {
+        ok = *(int *) gap_buffer_item_at(buf, i) == model[i];
+    }
+
+    int test_results[] = {
+        check("random edits", ok),
+    };
+
+    free_gap_buffer(buf);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *gap_buffer_tests = create_test_suite("gap buffer tests");
+    suite_add_test(gap_buffer_tests, "gap buffer edit", gap_buffer_edit_test);
+    suite_add_test(gap_buffer_tests, "gap buffer random", gap_buffer_random_test);
+    run_test_suite(gap_buffer_tests, VERBOSE);
+    free_test_suite(gap_buffer_tests);
+
+    return 0;
+}
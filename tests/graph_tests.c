@@ -0,0 +1,318 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <ilc/graph.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+typedef struct {
+    size_t from;
+    size_t to;
+    double weight;
+} TestEdge;
+
+static Graph *create_test_graph(size_t num_vertices, int directed, const TestEdge *edges,
+                                size_t num_edges) {
+    GraphBuilder *builder = create_graph_builder(num_vertices, directed);
+
+    size_t i;
+    for (i = 0; i < num_edges; i++) {
+        graph_builder_add_edge(builder, edges[i].from, edges[i].to, edges[i].weight);
+    }
+
+    Graph *graph = graph_builder_freeze(builder);
+    free_graph_builder(builder);
+
+    return graph;
+}
+
+static int check_sizes_equal(const char *what, const size_t *actual, const size_t *expected,
+                             size_t len) {
+    int ok = check_mem_equal(actual, expected, len * sizeof(size_t));
+
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "match") : COLOR_TEXT(RED, "differ"));
+        if (!ok) {
+            size_t i;
+            printf("        " RED "actual:  ");
+            for (i = 0; i < len; i++) {
+                printf(" %ld", (long) actual[i]);
+            }
+            printf("\n        expected:");
+            for (i = 0; i < len; i++) {
+                printf(" %ld", (long) expected[i]);
+            }
+            printf(END_COLOR "\n");
+        }
+    }
+
+    return ok;
+}
+
+static int check_errno(const char *what, int actual, int expected) {
+    int ok = actual == expected;
+
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+        if (!ok) {
+            printf("        " COLOR_TEXT(RED, "errno is %d, expected %d") "\n", actual, expected);
+        }
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+static int neighbors_test_examples(const Graph *graph, size_t vertex, const size_t *expected,
+                                   size_t expected_degree) {
+    size_t degree = 0;
+    const size_t *neighbors = graph_neighbors(graph, vertex, NULL, &degree);
+
+    int degree_ok = degree == expected_degree;
+    if (VERBOSE && !degree_ok) {
+        printf("    " COLOR_TEXT(RED, "degree of %lu is %lu, expected %lu") "\n",
+               vertex, degree, expected_degree);
+    }
+
+    char what[64];
+    sprintf(what, "neighbors of %lu", vertex);
+
+    return degree_ok && check_sizes_equal(what, neighbors, expected, expected_degree);
+}
+
+static int graph_freeze_test() {
+    const TestEdge edges[] = {{2, 0, 1}, {0, 1, 1}, {2, 1, 1}, {0, 3, 1}};
+    Graph *graph = create_test_graph(4, 1, edges, 4);
+
+    const TestEdge undirected_edges[] = {{0, 1, 1}, {1, 2, 1}};
+    Graph *undirected = create_test_graph(3, 0, undirected_edges, 2);
+
+    const size_t from0[] = {1, 3};
+    const size_t from2[] = {0, 1};
+    const size_t undirected1[] = {0, 2};
+
+    size_t degree;
+    errno = 0;
+    graph_neighbors(graph, 4, NULL, &degree);
+    int bad_vertex_errno = errno;
+
+    GraphBuilder *builder = create_graph_builder(2, 0);
+    errno = 0;
+    graph_builder_add_edge(builder, 0, 2, 1);
+    int bad_edge_errno = errno;
+    free_graph_builder(builder);
+
+    int test_results[] = {
+        neighbors_test_examples(graph, 0, from0, 2),
+        neighbors_test_examples(graph, 1, NULL, 0),
+        neighbors_test_examples(graph, 2, from2, 2),
+        neighbors_test_examples(undirected, 1, undirected1, 2),
+        graph_num_vertices(graph) == 4,
+        graph_num_edges(graph) == 4,
+        graph_num_edges(undirected) == 4,
+        check_errno("graph_neighbors out of range", bad_vertex_errno, EINVAL),
+        check_errno("graph_builder_add_edge out of range", bad_edge_errno, EINVAL),
+    };
+
+    free_graph(graph);
+    free_graph(undirected);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int graph_bfs_test() {
+    /* 0 - 1 - 2 - 3 with a shortcut 0 - 2, and 4 disconnected */
+    const TestEdge edges[] = {{0, 1, 1}, {1, 2, 1}, {2, 3, 1}, {0, 2, 1}};
+    Graph *graph = create_test_graph(5, 0, edges, 4);
+    GraphScratch *scratch = create_graph_scratch(graph);
+
+    size_t dist[5], parent[5];
+    int bfs_ok = graph_bfs(graph, scratch, 0, dist, parent) == 0;
+
+    const size_t expected_dist[] = {0, 1, 1, 2, GRAPH_UNREACHABLE};
+    const size_t expected_parent[] = {GRAPH_UNREACHABLE, 0, 0, 2, GRAPH_UNREACHABLE};
+
+    errno = 0;
+    graph_bfs(graph, scratch, 5, NULL, NULL);
+    int bad_source_errno = errno;
+
+    int test_results[] = {
+        bfs_ok,
+        check_sizes_equal("bfs distances", dist, expected_dist, 5),
+        check_sizes_equal("bfs parents", parent, expected_parent, 5),
+        check_errno("graph_bfs out of range source", bad_source_errno, EINVAL),
+    };
+
+    free_graph_scratch(scratch);
+    free_graph(graph);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int graph_dijkstra_test() {
+    const TestEdge edges[] = {
+        {0, 1, 4}, {0, 2, 1}, {2, 1, 2}, {1, 3, 1}, {2, 3, 5}, {3, 4, 3}, {5, 0, 1},
+    };
+    Graph *graph = create_test_graph(6, 1, edges, 7);
+    GraphScratch *scratch = create_graph_scratch(graph);
+
+    double dist[6];
+    size_t parent[6];
+    int dijkstra_ok = graph_dijkstra(graph, scratch, 0, dist, parent) == 0;
+
+    const double expected_dist[] = {0, 3, 1, 4, 7};
+    int dist_ok = check_mem_equal(dist, expected_dist, sizeof(expected_dist)) && dist[5] == HUGE_VAL;
+    if (VERBOSE) {
+        printf("    dijkstra distances %s\n", dist_ok ? COLOR_TEXT(GREEN, "match") : COLOR_TEXT(RED, "differ"));
+    }
+
+    const size_t expected_parent[] = {GRAPH_UNREACHABLE, 2, 0, 1, 3, GRAPH_UNREACHABLE};
+
+    /* a longer chain to exercise the heap past a few levels */
+    GraphBuilder *builder = create_graph_builder(1000, 0);
+    size_t v;
+    for (v = 0; v + 1 < 1000; v++) {
+        graph_builder_add_edge(builder, v, v + 1, 1);
+        graph_builder_add_edge(builder, 0, v + 1, 1000.0 + (double) v);
+    }
+    Graph *chain = graph_builder_freeze(builder);
+    free_graph_builder(builder);
+
+    GraphScratch *chain_scratch = create_graph_scratch(chain);
+    double *chain_dist = malloc(1000 * sizeof(double));
+    graph_dijkstra(chain, chain_scratch, 0, chain_dist, NULL);
+
+    int chain_ok = 1;
+    for (v = 0; v < 1000; v++) {
+        if (chain_dist[v] != (double) v) {
+            chain_ok = 0;
+        }
+    }
+    if (VERBOSE) {
+        printf("    dijkstra on chain %s\n", chain_ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    int test_results[] = {
+        dijkstra_ok,
+        dist_ok,
+        check_sizes_equal("dijkstra parents", parent, expected_parent, 6),
+        chain_ok,
+    };
+
+    free(chain_dist);
+    free_graph_scratch(chain_scratch);
+    free_graph(chain);
+    free_graph_scratch(scratch);
+    free_graph(graph);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int graph_connected_components_test() {
+    const TestEdge edges[] = {{3, 1, 1}, {4, 5, 1}, {1, 0, 1}, {6, 4, 1}};
+    Graph *graph = create_test_graph(7, 1, edges, 4);
+    GraphScratch *scratch = create_graph_scratch(graph);
+
+    size_t component[7];
+    size_t num_components = graph_connected_components(graph, scratch, component);
+    const size_t expected[] = {0, 0, 1, 0, 2, 2, 2};
+
+    int test_results[] = {
+        num_components == 3,
+        check_sizes_equal("components", component, expected, 7),
+    };
+
+    free_graph_scratch(scratch);
+    free_graph(graph);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int graph_topological_sort_test() {
+    const TestEdge edges[] = {{3, 1, 1}, {1, 0, 1}, {2, 0, 1}, {3, 2, 1}, {4, 3, 1}};
+    Graph *dag = create_test_graph(5, 1, edges, 5);
+    GraphScratch *scratch = create_graph_scratch(dag);
+
+    size_t order[5];
+    int sort_ok = graph_topological_sort(dag, scratch, order) == 0;
+    const size_t expected[] = {4, 3, 1, 2, 0};
+
+    const TestEdge cycle_edges[] = {{0, 1, 1}, {1, 2, 1}, {2, 0, 1}};
+    Graph *cycle = create_test_graph(3, 1, cycle_edges, 3);
+    errno = 0;
+    graph_topological_sort(cycle, scratch, order);
+    int cycle_errno = errno;
+
+    Graph *undirected = create_test_graph(3, 0, cycle_edges, 2);
+    errno = 0;
+    graph_topological_sort(undirected, scratch, order);
+    int undirected_errno = errno;
+
+    int test_results[] = {
+        sort_ok,
+        check_sizes_equal("topological order", order, expected, 5),
+        check_errno("graph_topological_sort on cycle", cycle_errno, EDOM),
+        check_errno("graph_topological_sort on undirected", undirected_errno, EINVAL),
+    };
+
+    free_graph(undirected);
+    free_graph(cycle);
+    free_graph_scratch(scratch);
+    free_graph(dag);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *graph_tests = create_test_suite("graph tests");
+    suite_add_test(graph_tests, "graph freeze", graph_freeze_test);
+    suite_add_test(graph_tests, "graph bfs", graph_bfs_test);
+    suite_add_test(graph_tests, "graph dijkstra", graph_dijkstra_test);
+    suite_add_test(graph_tests, "graph connected components", graph_connected_components_test);
+    suite_add_test(graph_tests, "graph topological sort", graph_topological_sort_test);
+    run_test_suite(graph_tests, VERBOSE);
+    free_test_suite(graph_tests);
+
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <ilc/string.h>
+#include <ilc/line_reader.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+/* pipe with input already written and the write end closed, so reads see EOF after it */
+static int pipe_with_input(const char *input, size_t len) {
+    int fds[2];
+    if (pipe(fds) == -1) {
+        return -1;
+    }
+
+    /* inputs are small, they fit in the pipe buffer */
+    int ok = write(fds[1], input, len) == (ssize_t) len;
+    close(fds[1]);
+
+    if (!ok) {
+        close(fds[0]);
+        return -1;
+    }
+
+    return fds[0];
+}
+
+static int line_reader_test_examples(const char *input, const char *cdelim, size_t buffer_size,
+                                     const char **expected, size_t num_expected) {
+    int fd = pipe_with_input(input, strlen(input));
+
+    String delim;
+    delim.chars = (char *)cdelim;
+    delim.len = strlen(cdelim);
+
+    LineReader *reader = create_line_reader(fd, &delim, buffer_size);
+
+    size_t num_records = 0;
+    int records_ok = reader != NULL;
+    String record;
+    int result = 0;
+    while (records_ok && (result = line_reader_next(reader, &record)) == 0) {
+        records_ok = num_records < num_expected && record.len == strlen(expected[num_records]) &&
+                     check_mem_equal(record.chars, expected[num_records], record.len);
+        num_records++;
+    }
+
+    int test_ok = records_ok && result == ENODATA && num_records == num_expected &&
+                  line_reader_next(reader, &record) == ENODATA;
+
+    if (VERBOSE) {
+        const char *status = test_ok ?
+            COLOR_TEXT(GREEN, "passed") :
+            COLOR_TEXT(RED, "failed");
+        printf("    reading \"%s\" by \"%s\" with a %lu byte buffer %s\n", input, cdelim,
+               buffer_size, status);
+
+        if (!test_ok) {
+            printf("        " COLOR_TEXT(RED, "stopped after %lu of %lu records") "\n",
+                   num_records, num_expected);
+        }
+    }
+
+    free_line_reader(reader);
+    close(fd);
+
+    return test_ok;
+}
+
+static int line_reader_lines_test() {
+    const char *abc[] = {"a", "bb", "ccc"};
+    const char *empties[] = {"", "a", "", "b", ""};
+    const char *one[] = {"no newline at all"};
+
+    int test_results[] = {
+        line_reader_test_examples("a\nbb\nccc\n", "\n", 0, abc, 3),
+        line_reader_test_examples("a\nbb\nccc", "\n", 0, abc, 3),
+        line_reader_test_examples("\na\n\nb\n\n", "\n", 0, empties, 5),
+        line_reader_test_examples("no newline at all", "\n", 0, one, 1),
+        line_reader_test_examples("", "\n", 0, NULL, 0),
+
+        /* tiny buffers make records straddle refills and force growth */
+        line_reader_test_examples("a\nbb\nccc\n", "\n", 1, abc, 3),
+        line_reader_test_examples("a\nbb\nccc", "\n", 2, abc, 3),
+        line_reader_test_examples("no newline at all", "\n", 3, one, 1),
+    };
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int line_reader_delim_test() {
+    const char *crlf[] = {"GET / HTTP/1.1", "Host: x", "", "body\rwith\nstrays"};
+    const char *abab[] = {"x", "", "y"};
+    const char *partial[] = {"a\r"};
+
+    int test_results[] = {
+        line_reader_test_examples("GET / HTTP/1.1\r\nHost: x\r\n\r\nbody\rwith\nstrays", "\r\n", 0, crlf, 4),
+        line_reader_test_examples("GET / HTTP/1.1\r\nHost: x\r\n\r\nbody\rwith\nstrays", "\r\n", 3, crlf, 4),
+        line_reader_test_examples("xababyab", "ab", 1, abab, 3),
+        line_reader_test_examples("a\r", "\r\n", 2, partial, 1),
+    };
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int line_reader_errors_test() {
+    String empty;
+    empty.chars = (char *)"";
+    empty.len = 0;
+
+    String newline;
+    newline.chars = (char *)"\n";
+    newline.len = 1;
+
+    errno = 0;
+    int null_delim_ok = create_line_reader(0, NULL, 0) == NULL && errno == EFAULT;
+    errno = 0;
+    int empty_delim_ok = create_line_reader(0, &empty, 0) == NULL && errno == EINVAL;
+
+    LineReader *bad_fd = create_line_reader(-1, &newline, 0);
+    String record;
+    errno = 0;
+    int bad_fd_ok = line_reader_next(bad_fd, &record) == EBADF && errno == EBADF;
+    free_line_reader(bad_fd);
+
+    int test_results[] = {
+        null_delim_ok,
+        empty_delim_ok,
+        bad_fd_ok,
+    };
+
+    if (VERBOSE) {
+        const char *names[] = {"NULL delim is EFAULT", "empty delim is EINVAL", "bad fd is EBADF"};
+        size_t i;
+        for (i = 0; i < sizeof(test_results) / sizeof(int); i++) {
+            printf("    %s %s\n", names[i],
+                   test_results[i] ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+        }
+    }
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *line_reader_tests = create_test_suite("line reader tests");
+    suite_add_test(line_reader_tests, "line reader lines", line_reader_lines_test);
+    suite_add_test(line_reader_tests, "line reader delimiters", line_reader_delim_test);
+    suite_add_test(line_reader_tests, "line reader errors", line_reader_errors_test);
+    run_test_suite(line_reader_tests, VERBOSE);
+    free_test_suite(line_reader_tests);
+
+    return 0;
+}
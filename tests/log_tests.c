@@ -0,0 +1,273 @@
+#define _POSIX_C_SOURCE 200809L  /* fileno, sched_yield */
+
+#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#define LOGGER_COMPILE_LEVEL LOGGER_LEVEL_INFO  /* so LOGGER_DEBUG calls are compiled out below */
+#include <ilc/log.h>
+#include <ilc/test.h>
+
+#define NUM_THREADS 4
+#define RECORDS_PER_THREAD 2000
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+/* everything written to out so far, as one string */
+static char *read_log(FILE *out) {
+    fseek(out, 0, SEEK_END);
+    long size = ftell(out);
+    char *text = malloc(size + 1);
+    rewind(out);
+    if (text == NULL || fread(text, 1, size, out) != (size_t) size) {
+        free(text);
+        return NULL;
+    }
+
+    text[size] = '\0';
+    return text;
+}
+
+static size_t count_occurrences(const char *haystack, const char *needle) {
+    size_t count = 0;
+    const char *at;
+    for (at = strstr(haystack, needle); at != NULL; at = strstr(at + 1, needle)) {
+        count++;
+    }
+
+    return count;
+}
+
+static int log_format_test() {
+    FILE *out = tmpfile();
+    Logger *logger = create_logger(fileno(out), 16);
+    if (logger == NULL) {
+        return FAILURE;
+    }
+
+    char name[] = "rows.csv";
+    LOGGER_INFO(logger, "read %zu rows from %s", (size_t) 120, name);
+    strcpy(name, "changed!");  /* the copy taken when logging is what's written */
+    LOGGER_WARN(logger, "[%5d|%-4u|%x|%c|%.2f|%hhd|%lld%%]", 42, 7u, 255u, 'z', 3.14159, 300, -5LL);
+    LOGGER_ERROR(logger, "no arguments");
+    LOGGER_INFO(logger, "unsupported %*d and %d after", 3, 4, 5);
+    logger_flush(logger);
+
+    char *text = read_log(out);
+    if (VERBOSE && text != NULL) {
+        printf("%s", text);
+    }
+
+    int test_results[] = {
+        check("log written", text != NULL),
+        check("integers and strings", text != NULL && strstr(text, " INFO  [thread 0] read 120 rows from rows.csv\n") != NULL),
+        check("flags, widths, and length modifiers", text != NULL && strstr(text, " WARN  [thread 0] [   42|7   |ff|z|3.14|44|-5%]\n") != NULL),
+        check("no arguments", text != NULL && strstr(text, " ERROR [thread 0] no arguments\n") != NULL),
+        check("unsupported spec written as is", text != NULL && strstr(text, "unsupported %*d and %d after\n") != NULL),
+        check("timestamp", text != NULL && text[4] == '-' && text[10] == 'T' && text[26] == 'Z'),
+        check("NULL logger fails", logger_log(NULL, LOGGER_LEVEL_INFO, "x") == EFAULT),
+    };
+
+    free(text);
+    free_logger(logger);
+    fclose(out);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int log_levels_test() {
+    FILE *out = tmpfile();
+    Logger *logger = create_logger(fileno(out), 16);
+    if (logger == NULL) {
+        return FAILURE;
+    }
+
+    int evaluated = 0;
+    LOGGER_DEBUG(logger, "compiled out %d", ++evaluated);
+    LOGGER_INFO(logger, "shown %d", 1);
+
+    logger_set_level(logger, LOGGER_LEVEL_WARN);
+    LOGGER_INFO(logger, "filtered %d", 2);
+    LOGGER_WARN(logger, "shown %d", 3);
+    logger_flush(logger);
+
+    char *text = read_log(out);
+    int test_results[] = {
+        check("compiled out call not evaluated", evaluated == 0),
+        check("compiled out call not written", text != NULL && strstr(text, "compiled out") == NULL),
+        check("filtered call not written", text != NULL && strstr(text, "filtered") == NULL),
+        check("others written", text != NULL && count_occurrences(text, "shown") == 2),
+    };
+
+    free(text);
+    free_logger(logger);
+    fclose(out);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int log_drops_test() {
+    FILE *out = tmpfile();
+    Logger *logger = create_logger(fileno(out), 4);
+    if (logger == NULL) {
+        return FAILURE;
+    }
+
+    size_t failed = 0;
+    int i;
+    for (i = 0; i < 1000; i++) {
+        failed += LOGGER_INFO(logger, "record %d", i) != 0;
+    }
+    logger_flush(logger);
+
+    size_t dropped = logger_dropped(logger);
+    free_logger(logger);  /* writes the last dropped note */
+
+    char *text = read_log(out);
+    size_t written = text != NULL ? count_occurrences(text, "] record ") : 0;
+    if (VERBOSE) {
+        printf("    %lu written, %lu dropped\n", written, dropped);
+    }
+
+    int test_results[] = {
+        check("every record written or dropped", written + dropped == 1000),
+        check("drops counted", failed == dropped),
+        check("drops noted in the log", dropped == 0 || (text != NULL && strstr(text, "records, the queue was full") != NULL)),
+    };
+
+    free(text);
+    fclose(out);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static void *log_records(void *arg) {
+    Logger *logger = arg;
+    int i;
+    for (i = 0; i < RECORDS_PER_THREAD; i++) {
+        while (LOGGER_INFO(logger, "sequence %d", i) == EAGAIN) {
+            sched_yield();  /* full, retried so every record arrives (let the writer run on one core) */
+        }
+    }
+
+    return NULL;
+}
+
+/* each thread's lines must keep their order, whatever the interleaving */
+static int lines_in_order(const char *text) {
+    int next[NUM_THREADS * 2] = {0};  /* threads may reuse an exited thread's buffer */
+    const char *line;
+    for (line = text; *line != '\0'; line = strchr(line, '\n') + 1) {
+        unsigned int thread;
+        int sequence;
+        const char *fields = strstr(line, "[thread ");
+        if (fields != NULL && strstr(fields, "] dropped ") == strchr(fields, ']')) {
+            continue;  /* a note about the retried records */
+        }
+        if (fields == NULL || sscanf(fields, "[thread %u] sequence %d", &thread, &sequence) != 2 ||
+            thread >= NUM_THREADS * 2) {
+            return 0;
+        }
+
+        if (sequence != next[thread] % RECORDS_PER_THREAD) {
+            return 0;
+        }
+        next[thread]++;
+    }
+
+    return 1;
+}
+
+static int log_threads_test() {
+    FILE *out = tmpfile();
+    Logger *logger = create_logger(fileno(out), 64);
+    if (logger == NULL) {
+        return FAILURE;
+    }
+
+    pthread_t threads[NUM_THREADS];
+    int i;
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, log_records, logger);
+    }
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free_logger(logger);
+
+    char *text = read_log(out);
+    size_t written = text != NULL ? count_occurrences(text, "] sequence ") : 0;
+    if (VERBOSE) {
+        printf("    %lu lines written\n", written);
+    }
+
+    int test_results[] = {
+        check("every record written", written == NUM_THREADS * RECORDS_PER_THREAD),
+        check("each thread's records in order", text != NULL && lines_in_order(text)),
+    };
+
+    free(text);
+    fclose(out);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *log_tests = create_test_suite("log tests");
+    suite_add_test(log_tests, "log format", log_format_test);
+    suite_add_test(log_tests, "log levels", log_levels_test);
+    suite_add_test(log_tests, "log drops", log_drops_test);
+    suite_add_test(log_tests, "log threads", log_threads_test);
+    run_test_suite(log_tests, VERBOSE);
+    free_test_suite(log_tests);
+
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <ilc/string.h>
+#include <ilc/packed_string_list.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+static String cstr_view(const char *cstr) {
+    String s;
+    s.chars = (char *)cstr;
+    s.len = strlen(cstr);
+    return s;
+}
+
+static int list_matches(const PackedStringList *list, const char **expected, size_t num_expected) {
+    if (packed_string_list_length(list) != num_expected) {
+        return 0;
+    }
+
+    size_t i;
+    for (i = 0; i < num_expected; i++) {
+        String s;
+        if (packed_string_list_get(list, i, &s) != 0 || s.len != strlen(expected[i]) ||
+            !check_mem_equal(s.chars, expected[i], s.len)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int packed_string_list_append_test() {
+    PackedStringList *list = create_packed_string_list();
+    const char *words[] = {"tokenized", "", "corpora", "x", ""};
+
+    int append_ok = 1;
+    size_t i;
+    for (i = 0; i < 5; i++) {
+        String s = cstr_view(words[i]);
+        append_ok = append_ok && packed_string_list_append(list, &s) == 0;
+    }
+
+    /* enough to grow both the offsets and the chars a few times */
+    char word[8];
+    for (i = 0; i < 1000; i++) {
+        String s;
+        s.chars = word;
+        s.len = (size_t) sprintf(word, "w%lu", i);
+        append_ok = append_ok && packed_string_list_append(list, &s) == 0;
+    }
+
+    String s;
+    int last_ok = packed_string_list_get(list, 1004, &s) == 0 && s.len == 4 &&
+                  check_mem_equal(s.chars, "w999", 4);
+
+    errno = 0;
+    int oob_ok = packed_string_list_get(list, 1005, &s) == EDOM && errno == EDOM;
+    errno = 0;
+    int null_ok = packed_string_list_append(NULL, &s) == EFAULT && errno == EFAULT;
+
+    PackedStringList *first_five = create_packed_string_list();
+    for (i = 0; i < 5; i++) {
+        String w = cstr_view(words[i]);
+        packed_string_list_append(first_five, &w);
+    }
+
+    int test_results[] = {
+        check("append", append_ok),
+        check("get first strings", list_matches(first_five, words, 5)),
+        check("get last string", last_ok),
+        check("length", packed_string_list_length(list) == 1005),
+        check("bytes", packed_string_list_bytes(first_five) == 17),
+        check("get out of range is EDOM", oob_ok),
+        check("NULL list is EFAULT", null_ok),
+    };
+
+    free_packed_string_list(list);
+    free_packed_string_list(first_five);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int packed_string_list_convert_test() {
+    const char *csv = "id,name,,notes";
+    String str = cstr_view(csv);
+    String comma = cstr_view(",");
+    StringList *fields = string_split(&str, &comma);
+
+    PackedStringList *packed = packed_string_list_from_string_list(fields);
+    StringList *unpacked = packed_string_list_to_string_list(packed);
+
+    int round_trip_ok = unpacked != NULL && string_list_equal(fields, unpacked);
+
+    /* views share one buffer, back to back */
+    int contiguous = unpacked != NULL && unpacked->strs[1].chars == unpacked->strs[0].chars + 2 &&
+                     unpacked->strs[3].chars == unpacked->strs[2].chars;
+
+    PackedStringList *empty = create_packed_string_list();
+    StringList *empty_unpacked = packed_string_list_to_string_list(empty);
+    int empty_ok = empty_unpacked != NULL && empty_unpacked->len == 0;
+
+    /* save the two buffers and load them back, as writing them to a file would */
+    size_t offset_size = 0;
+    const void *offsets = packed_string_list_offsets(packed, &offset_size);
+    char *saved_offsets = malloc(5 * offset_size);
+    char *saved_chars = malloc(packed_string_list_bytes(packed));
+    memcpy(saved_offsets, offsets, 5 * offset_size);
+    memcpy(saved_chars, packed_string_list_chars(packed), packed_string_list_bytes(packed));
+
+    PackedStringList *loaded = create_packed_string_list_from_buffers(saved_chars, saved_offsets, offset_size, 4);
+    const char *expected_fields[] = {"id", "name", "", "notes"};
+    String extra = cstr_view("more");
+    const char *expected_appended[] = {"id", "name", "", "notes", "more"};
+    int buffers_ok = offset_size == 4 && loaded != NULL && list_matches(loaded, expected_fields, 4) &&
+                     packed_string_list_append(loaded, &extra) == 0 &&
+                     list_matches(loaded, expected_appended, 5);
+
+    uint32_t decreasing[] = {0, 3, 2};
+    errno = 0;
+    int invalid_ok = create_packed_string_list_from_buffers("abc", decreasing, 4, 2) == NULL && errno == EINVAL &&
+                     create_packed_string_list_from_buffers("abc", saved_offsets, 2, 4) == NULL && errno == EINVAL;
+
+    int test_results[] = {
+        check("round trip through StringList", round_trip_ok),
+        check("views are contiguous", contiguous),
+        check("empty list", empty_ok),
+        check("round trip through chars and offsets", buffers_ok),
+        check("invalid offsets are EINVAL", invalid_ok),
+    };
+
+    free(saved_offsets);
+    free(saved_chars);
+    free_packed_string_list(loaded);
+
+    free(fields->strs);
+    free(fields);
+    free(unpacked->strs);
+    free(unpacked);
+    free(empty_unpacked->strs);
+    free(empty_unpacked);
+    free_packed_string_list(packed);
+    free_packed_string_list(empty);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int packed_string_list_sort_test() {
+    const char *words[] = {"pear", "apple", "", "applesauce", "applesauc", "\xff", "b", "apple", "a"};
+    const char *sorted[] = {"", "a", "apple", "apple", "applesauc", "applesauce", "b", "pear", "\xff"};
+
+    PackedStringList *list = create_packed_string_list();
+    size_t i;
+    for (i = 0; i < 9; i++) {
+        String s = cstr_view(words[i]);
+        packed_string_list_append(list, &s);
+    }
+
+    int sort_ok = packed_string_list_sort(list) == 0 && list_matches(list, sorted, 9);
+
+    /* list still appends normally after being laid out again */
+    String last = cstr_view("zz");
+    packed_string_list_append(list, &last);
+    String s;
+    int append_ok = packed_string_list_get(list, 9, &s) == 0 && s.len == 2 &&
+                    check_mem_equal(s.chars, "zz", 2);
+
+    int test_results[] = {
+        check("sort in byte order", sort_ok),
+        check("append after sort", append_ok),
+    };
+
+    free_packed_string_list(list);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *packed_string_list_tests = create_test_suite("packed string list tests");
+    suite_add_test(packed_string_list_tests, "packed string list append", packed_string_list_append_test);
+    suite_add_test(packed_string_list_tests, "packed string list convert", packed_string_list_convert_test);
+    suite_add_test(packed_string_list_tests, "packed string list sort", packed_string_list_sort_test);
+    run_test_suite(packed_string_list_tests, VERBOSE);
+    free_test_suite(packed_string_list_tests);
+
+    return 0;
+}
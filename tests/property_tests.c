@@ -0,0 +1,449 @@
+#include <stdio.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ilc/string.h>
+#include <ilc/dynarray.h>
+#include <ilc/property.h>
+#include <ilc/test.h>
+
+/*
+ * Each property checks a library function against a naive reference on
+ * generated inputs. Built with -DFUZZ_PROPERTY=<property> (see "make fuzz"),
+ * this file is instead a libFuzzer target for that one property.
+ */
+
+#define RUNS 500
+#define MAX_OPS 60  /* operations per dynarray_matches_model run */
+
+
+int VERBOSE = 0;
+
+
+static void print_string(const char *label, const String *str) {
+    printf("        %s: \"%.*s\" (length %lu)\n", label, (int) str->len, str->chars, str->len);
+}
+
+static void print_string_list(const char *label, const StringList *list) {
+    printf("        %s: [", label);
+    size_t i;
+    for (i = 0; i < list->len; i++) {
+        printf("%s\"%.*s\"", i == 0 ? "" : ", ", (int) list->strs[i].len, list->strs[i].chars);
+    }
+    printf("]\n");
+}
+
+static void free_split(StringList *list) {
+    if (list != NULL) {
+        free(list->strs);
+        free(list);
+    }
+}
+
+/* the obvious split: scan left to right, a delimeter match skips past itself */
+static StringList *naive_split(const String *str, const String *delim) {
+    StringList *list = malloc(sizeof(StringList));
+    list->strs = malloc((str->len + 1) * sizeof(String));
+    list->len = 0;
+
+    size_t start = 0, i = 0;
+    while (i + delim->len <= str->len) {
+        if (memcmp(str->chars + i, delim->chars, delim->len) == 0) {
+            list->strs[list->len].chars = str->chars + start;
+            list->strs[list->len].len = i - start;
+            list->len++;
+
+            i += delim->len;
+            start = i;
+        } else {
+            i++;
+        }
+    }
+
+    list->strs[list->len].chars = str->chars + start;
+    list->strs[list->len].len = str->len - start;
+    list->len++;
+
+    return list;
+}
+
+static int string_split_matches_naive(PropSource *src) {
+    String *str = draw_string(src, 40, "ab,");
+    String *delim = draw_string(src, 3, "ab,");
+    if (str == NULL || delim == NULL || delim->len == 0) {
+        return 1;  /* nothing to split by */
+    }
+
+    StringList *list = string_split(str, delim);
+    if (delim->len > str->len) {
+        int rejected = list == NULL && errno == EINVAL;
+        if (!rejected && prop_reporting(src)) {
+            print_string("str", str);
+            print_string("delim", delim);
+            printf("        " COLOR_TEXT(RED, "longer delimeter not rejected with EINVAL") "\n");
+        }
+        free_split(list);
+        return rejected;
+    }
+
+    StringList *expected = naive_split(str, delim);
+    String *joined = list != NULL ? string_join(delim, list) : NULL;
+    int same_list = list != NULL && string_list_equal(list, expected);
+    int round_trip = joined != NULL && string_equal(joined, str);
+
+    if (prop_reporting(src)) {
+        print_string("str", str);
+        print_string("delim", delim);
+        print_string_list("expected", expected);
+        if (list != NULL) {
+            print_string_list("string_split", list);
+        }
+        if (!round_trip) {
+            printf("        " COLOR_TEXT(RED, "joining the split doesn't give str back") "\n");
+        }
+    }
+
+    free_string(joined);
+    free_split(list);
+    free_split(expected);
+
+    return same_list && round_trip;
+}
+
+/*
+ * The parallel split only kicks in past 64 KiB per chunk, so the input is a
+ * short drawn string repeated to over 256 KiB with a few drawn bytes changed,
+ * which keeps delimeters (and overlapping ones) near every chunk boundary.
+ */
+static int string_split_parallel_matches_naive(PropSource *src) {
+    String *unit = draw_string(src, 12, "aab,");
+    String *delim = draw_string(src, 3, "aab,");
+    if (unit == NULL || delim == NULL || unit->len == 0 || delim->len == 0) {
+        return 1;
+    }
+
+    size_t len = 256 * 1024 + draw_uint(src, 64);
+    char *chars = malloc(len);
+    size_t i;
+    for (i = 0; i < len; i++) {
+        chars[i] = unit->chars[i % unit->len];
+    }
+
+    size_t changes = draw_uint(src, 8);
+    for (i = 0; i < changes; i++) {
+        chars[draw_uint(src, len - 1)] = draw_char(src, "aab,");
+    }
+
+    String str = {chars, len};
+    size_t num_threads = 2 + draw_uint(src, 3);
+    StringList *list = string_split_parallel(&str, delim, num_threads);
+    StringList *expected = naive_split(&str, delim);
+    int same_list = list != NULL && string_list_equal(list, expected);
+
+    if (prop_reporting(src)) {
+        print_string("repeated unit", unit);
+        print_string("delim", delim);
+        printf("        %lu bytes, %lu changed, %lu threads, %lu strings expected, %lu from string_split_parallel\n",
+               len, changes, num_threads, expected->len, list != NULL ? list->len : 0);
+    }
+
+    free_split(list);
+    free_split(expected);
+    free(chars);
+
+    return same_list;
+}
+
+static int string_count_matches_naive(PropSource *src) {
+    String *str = draw_string(src, 40, "ab");
+    String *substr = draw_string(src, 3, "ab");
+    if (str == NULL || substr == NULL || substr->len == 0) {
+        return 1;
+    }
+
+    DynArray *expected = create_dynarray(sizeof(size_t));
+    size_t i = 0;
+    while (i + substr->len <= str->len) {
+        if (memcmp(str->chars + i, substr->chars, substr->len) == 0) {
+            dynarray_append(expected, &i);
+            i += substr->len;
+        } else {
+            i++;
+        }
+    }
+
+    DynArray *offsets = create_dynarray(sizeof(size_t));
+    int found_ok = string_find_all(str, substr, offsets) == 0 &&
+                   dynarray_length(offsets) == dynarray_length(expected);
+    for (i = 0; found_ok && i < dynarray_length(expected); i++) {
+        found_ok = *(size_t *) dynarray_item_at(offsets, i) == *(size_t *) dynarray_item_at(expected, i);
+    }
+    int count_ok = string_count(str, substr) == dynarray_length(expected);
+
+    if (prop_reporting(src)) {
+        print_string("str", str);
+        print_string("substr", substr);
+        printf("        %lu occurrences expected, string_find_all found %lu, string_count counted %lu\n",
+               dynarray_length(expected), dynarray_length(offsets), string_count(str, substr));
+    }
+
+    free_dynarray(expected);
+    free_dynarray(offsets);
+
+    return found_ok && count_ok;
+}
+
+/*
+ * Length of the longest prefix (or suffix) of chars made of non-empty patterns,
+ * trying every pattern from every offset some run of them reaches.
+ */
+static size_t naive_trimmed_len(const StringList *to_trim, const char *chars, size_t len, int at_end) {
+    char *reachable = calloc(len + 1, 1);
+    reachable[0] = 1;
+
+    size_t longest = 0;
+    size_t i, j;
+    for (i = 0; i <= len; i++) {
+        if (!reachable[i]) {
+            continue;
+        }
+        longest = i;
+
+        for (j = 0; j < to_trim->len; j++) {
+            const String *p = &to_trim->strs[j];
+            const char *at = at_end ? chars + len - i - p->len : chars + i;
+            if (p->len > 0 && i + p->len <= len && memcmp(at, p->chars, p->len) == 0) {
+                reachable[i + p->len] = 1;
+            }
+        }
+    }
+
+    free(reachable);
+    return longest;
+}
+
+static int string_trim_matches_naive(PropSource *src) {
+    String *str = draw_string(src, 30, "ab ");
+    StringList *to_trim = draw_string_list(src, 3, 3, "ab ");
+    if (str == NULL || to_trim == NULL) {
+        return 1;
+    }
+
+    /* each side is trimmed as if alone, and where they cross nothing is left */
+    size_t start = naive_trimmed_len(to_trim, str->chars, str->len, 0);
+    size_t end = str->len - naive_trimmed_len(to_trim, str->chars, str->len, 1);
+
+    String expected = {str->chars + start, end > start ? end - start : 0};
+    String expected_left = {str->chars + start, str->len - start};
+    String expected_right = {str->chars, end};
+
+    String *trimmed = string_trim(str, to_trim);
+    String *left = string_ltrim(str, to_trim);
+    String *right = string_rtrim(str, to_trim);
+    int ok = trimmed != NULL && string_equal(trimmed, &expected) &&
+             left != NULL && string_equal(left, &expected_left) &&
+             right != NULL && string_equal(right, &expected_right);
+
+    if (prop_reporting(src)) {
+        print_string("str", str);
+        print_string_list("to_trim", to_trim);
+        print_string("expected", &expected);
+        if (trimmed != NULL) {
+            print_string("string_trim", trimmed);
+        }
+        if (left != NULL) {
+            print_string("string_ltrim", left);
+        }
+        if (right != NULL) {
+            print_string("string_rtrim", right);
+        }
+    }
+
+    free_string(trimmed);
+    free_string(left);
+    free_string(right);
+
+    return ok;
+}
+
+static int int_equal(const void *a, const void *b) {
+    return *(const int *) a == *(const int *) b;
+}
+
+/*
+ * A random sequence of DynArray operations, checked after each one against
+ * the same operations done by hand on a plain array.
+ */
+static int dynarray_matches_model(PropSource *src) {
+    DynArray *arr = draw_int_dynarray(src, 8, 3);
+    if (arr == NULL) {
+        return 1;
+    }
+
+    int model[8 + MAX_OPS];
+    size_t len = dynarray_length(arr);
+    size_t i;
+    for (i = 0; i < len; i++) {
+        model[i] = *(int *) dynarray_item_at(arr, i);
+    }
+
+    if (prop_reporting(src)) {
+        printf("        starting from [");
+        for (i = 0; i < len; i++) {
+            printf("%s%d", i == 0 ? "" : ", ", model[i]);
+        }
+        printf("]\n");
+    }
+
+    static const char *OP_NAMES[] = {"append", "insert", "remove_at", "replace_at", "remove", "remove all",
+                                     "replace", "replace all"};
+    size_t num_ops = draw_uint(src, MAX_OPS);
+    size_t op_num;
+    for (op_num = 0; op_num < num_ops; op_num++) {
+        int op = (int) draw_uint(src, 7);
+        int value = (int) draw_uint(src, 3);
+        int other = (int) draw_uint(src, 3);
+        size_t index = draw_uint(src, len);  /* one past the end too, which only insert accepts */
+
+        int result = 0, expected_result = 0;
+        size_t j;
+        switch (op) {
+        case 0:
+            result = dynarray_append(arr, &value);
+            model[len++] = value;
+            break;
+        case 1:
+            result = dynarray_insert(arr, &value, index);
+            memmove(model + index + 1, model + index, (len - index) * sizeof(int));
+            model[index] = value;
+            len++;
+            break;
+        case 2:
+            result = dynarray_remove_at(arr, index);
+            if (index < len) {
+                memmove(model + index, model + index + 1, (len - index - 1) * sizeof(int));
+                len--;
+            } else {
+                expected_result = EINVAL;
+            }
+            break;
+        case 3:
+            result = dynarray_replace_at(arr, index, &value);
+            if (index < len) {
+                model[index] = value;
+            } else {
+                expected_result = EINVAL;
+            }
+            break;
+        case 4: case 5:
+            result = dynarray_remove(arr, &value, int_equal, op == 5);
+            for (i = 0, j = 0; i < len; i++) {
+                if (model[i] != value || (op == 4 && j < i)) {
+                    model[j++] = model[i];
+                }
+            }
+            len = j;
+            break;
+        default:
+            result = dynarray_replace(arr, &value, &other, int_equal, op == 7);
+            for (i = 0, j = 0; i < len; i++) {
+                if (model[i] == value && (op == 7 || j == 0)) {
+                    model[i] = other;
+                    j = 1;
+                }
+            }
+            break;
+        }
+
+        int same = result == expected_result && dynarray_length(arr) == len;
+        for (i = 0; same && i < len; i++) {
+            same = *(int *) dynarray_item_at(arr, i) == model[i];
+        }
+
+        if (prop_reporting(src)) {
+            printf("        %s(value %d, other %d, index %lu) returned %d, expected %d, model now [",
+                   OP_NAMES[op], value, other, index, result, expected_result);
+            for (i = 0; i < len; i++) {
+                printf("%s%d", i == 0 ? "" : ", ", model[i]);
+            }
+            printf("]%s\n", same ? "" : COLOR_TEXT(RED, " but the array differs"));
+        }
+
+        if (!same) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+#ifdef FUZZ_PROPERTY
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (!run_property_on_bytes(FUZZ_PROPERTY, data, size)) {
+        abort();
+    }
+
+    return 0;
+}
+
+#else
+
+static int string_split_property_test() {
+    return check_property("string_split matches naive split", string_split_matches_naive, RUNS, VERBOSE);
+}
+
+static int string_split_parallel_property_test() {
+    return check_property("string_split_parallel matches naive split", string_split_parallel_matches_naive, 20, VERBOSE);
+}
+
+static int string_count_property_test() {
+    return check_property("string_find_all and string_count match naive search", string_count_matches_naive, RUNS, VERBOSE);
+}
+
+static int string_trim_property_test() {
+    return check_property("string_trim matches naive trim", string_trim_matches_naive, RUNS, VERBOSE);
+}
+
+static int dynarray_property_test() {
+    return check_property("dynarray operations match a plain array", dynarray_matches_model, RUNS, VERBOSE);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n"
+                "Set " PROP_SEED_ENV " to replay a failure and " PROP_RUNS_ENV " to run more inputs.\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *property_tests = create_test_suite("property tests");
+    suite_add_test(property_tests, "string split property", string_split_property_test);
+    suite_add_test(property_tests, "string split parallel property", string_split_parallel_property_test);
+    suite_add_test(property_tests, "string count property", string_count_property_test);
+    suite_add_test(property_tests, "string trim property", string_trim_property_test);
+    suite_add_test(property_tests, "dynarray property", dynarray_property_test);
+    run_test_suite(property_tests, VERBOSE);
+    free_test_suite(property_tests);
+
+    return 0;
+}
+
+#endif
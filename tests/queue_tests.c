@@ -0,0 +1,313 @@
+#define _POSIX_C_SOURCE 200809L  /* sched_yield */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/queue.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+static int spsc_queue_basic_test() {
+    SpscQueue *queue = create_spsc_queue(sizeof(int), 5);  /* rounds up to 8 */
+
+    int i, item;
+    int push_ok = 1;
+    for (i = 0; i < 8; i++) {
+        push_ok = push_ok && spsc_queue_push(queue, &i) == 0;
+    }
+    errno = 0;
+    int full_ok = spsc_queue_push(queue, &i) == EAGAIN && errno == EAGAIN;
+
+    int pop_ok = spsc_queue_pop(queue, &item) == 0 && item == 0 &&
+                 spsc_queue_pop(queue, &item) == 0 && item == 1;
+
+    /* wraps around the end of the ring */
+    int batch[6] = {8, 9, 10, 11, 12, 13};
+    int out[16];
+    int batch_ok = spsc_queue_push_batch(queue, batch, 6) == 2 &&
+                   spsc_queue_pop_batch(queue, out, 16) == 8;
+    for (i = 0; i < 8 && batch_ok; i++) {
+        batch_ok = out[i] == i + 2;
+    }
+
+    errno = 0;
+    int empty_ok = spsc_queue_pop(queue, &item) == EAGAIN && spsc_queue_pop_batch(queue, out, 4) == 0 &&
+                   errno == EAGAIN;
+    errno = 0;
+    int null_ok = spsc_queue_push(NULL, &item) == EFAULT && errno == EFAULT;
+    errno = 0;
+    int zero_ok = create_spsc_queue(sizeof(int), 0) == NULL && errno == EINVAL;
+
+    int test_results[] = {
+        check("push", push_ok),
+        check("push full is EAGAIN", full_ok),
+        check("pop in order", pop_ok),
+        check("batches wrap around", batch_ok),
+        check("pop empty is EAGAIN", empty_ok),
+        check("NULL queue is EFAULT", null_ok),
+        check("capacity 0 is EINVAL", zero_ok),
+    };
+
+    free_spsc_queue(queue);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+#define NUM_QUEUE_ITEMS 200000
+
+static void *spsc_produce(void *arg) {
+    SpscQueue *queue = arg;
+    size_t i = 0;
+    while (i < NUM_QUEUE_ITEMS) {
+        if (i % 3 == 0) {
+            size_t batch[5] = {i, i + 1, i + 2, i + 3, i + 4};
+            size_t count = NUM_QUEUE_ITEMS - i < 5 ? NUM_QUEUE_ITEMS - i : 5;
+            size_t pushed = spsc_queue_push_batch(queue, batch, count);
+            if (pushed == 0) {
+                sched_yield();  /* full, let the consumer run (matters on one core) */
+            }
+            i += pushed;
+        } else if (spsc_queue_push(queue, &i) == 0) {
+            i++;
+        } else {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static int spsc_queue_threads_test() {
+    SpscQueue *queue = create_spsc_queue(sizeof(size_t), 64);
+
+    pthread_t producer;
+    pthread_create(&producer, NULL, spsc_produce, queue);
+
+    size_t expected = 0;
+    int order_ok = 1;
+    while (expected < NUM_QUEUE_ITEMS && order_ok) {
+        size_t items[7];
+        size_t count = spsc_queue_pop_batch(queue, items, 7);
+        if (count == 0) {
+            sched_yield();
+        }
+        size_t i;
+        for (i = 0; i < count; i++) {
+            order_ok = order_ok && items[i] == expected++;
+        }
+    }
+
+    pthread_join(producer, NULL);
+
+    int test_results[] = {
+        check("every item in order", order_ok && expected == NUM_QUEUE_ITEMS),
+    };
+
+    free_spsc_queue(queue);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int mpmc_queue_basic_test() {
+    MpmcQueue *queue = create_mpmc_queue(sizeof(int), 8);
+
+    int i, item;
+    int push_ok = 1;
+    for (i = 0; i < 8; i++) {
+        push_ok = push_ok && mpmc_queue_push(queue, &i) == 0;
+    }
+    errno = 0;
+    int full_ok = mpmc_queue_push(queue, &i) == EAGAIN && errno == EAGAIN;
+
+    int pop_ok = mpmc_queue_pop(queue, &item) == 0 && item == 0 &&
+                 mpmc_queue_pop(queue, &item) == 0 && item == 1;
+
+    int batch[6] = {8, 9, 10, 11, 12, 13};
+    int out[16];
+    int batch_ok = mpmc_queue_push_batch(queue, batch, 6) == 2 &&
+                   mpmc_queue_pop_batch(queue, out, 16) == 8;
+    for (i = 0; i < 8 && batch_ok; i++) {
+        batch_ok = out[i] == i + 2;
+    }
+
+    errno = 0;
+    int empty_ok = mpmc_queue_pop(queue, &item) == EAGAIN && errno == EAGAIN;
+    int zero_count_ok = mpmc_queue_push_batch(queue, batch, 0) == 0 && mpmc_queue_pop_batch(queue, out, 0) == 0;
+    errno = 0;
+    int null_ok = mpmc_queue_pop(NULL, &item) == EFAULT && errno == EFAULT;
+
+    int test_results[] = {
+        check("push", push_ok),
+        check("push full is EAGAIN", full_ok),
+        check("pop in order", pop_ok),
+        check("batches wrap around", batch_ok),
+        check("pop empty is EAGAIN", empty_ok),
+        check("batches of 0 return 0", zero_count_ok),
+        check("NULL queue is EFAULT", null_ok),
+    };
+
+    free_mpmc_queue(queue);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+#define NUM_MPMC_THREADS 4
+#define ITEMS_PER_MPMC_PRODUCER 50000
+
+typedef struct {
+    MpmcQueue *queue;
+    size_t id;
+    size_t num_popped;
+    size_t sum;
+    int order_ok;
+} MpmcWorker;
+
+static void *mpmc_produce(void *arg) {
+    MpmcWorker *worker = arg;
+    size_t i = 0;
+    while (i < ITEMS_PER_MPMC_PRODUCER) {
+        size_t batch[3];
+        size_t count = ITEMS_PER_MPMC_PRODUCER - i < 3 ? ITEMS_PER_MPMC_PRODUCER - i : 3;
+        size_t j;
+        for (j = 0; j < count; j++) {
+            batch[j] = worker->id * ITEMS_PER_MPMC_PRODUCER + i + j;
+        }
+        size_t pushed = mpmc_queue_push_batch(worker->queue, batch, count);
+        if (pushed == 0) {
+            sched_yield();
+        }
+        i += pushed;
+    }
+
+    return NULL;
+}
+
+static size_t total_popped = 0;
+
+static void *mpmc_consume(void *arg) {
+    MpmcWorker *worker = arg;
+    size_t last_seen[NUM_MPMC_THREADS];
+    size_t i;
+    for (i = 0; i < NUM_MPMC_THREADS; i++) {
+        last_seen[i] = (size_t) -1;
+    }
+
+    worker->order_ok = 1;
+    while (__atomic_load_n(&total_popped, __ATOMIC_RELAXED) < NUM_MPMC_THREADS * ITEMS_PER_MPMC_PRODUCER) {
+        size_t items[4];
+        size_t count = mpmc_queue_pop_batch(worker->queue, items, 4);
+        if (count == 0) {
+            sched_yield();
+        }
+        for (i = 0; i < count; i++) {
+            /* one consumer sees each producer's items in the order they were pushed */
+            size_t producer = items[i] / ITEMS_PER_MPMC_PRODUCER;
+            worker->order_ok = worker->order_ok && producer < NUM_MPMC_THREADS &&
+                               (last_seen[producer] == (size_t) -1 || items[i] > last_seen[producer]);
+            last_seen[producer] = items[i];
+            worker->sum += items[i];
+        }
+        worker->num_popped += count;
+        __atomic_add_fetch(&total_popped, count, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+static int mpmc_queue_threads_test() {
+    MpmcQueue *queue = create_mpmc_queue(sizeof(size_t), 256);
+
+    pthread_t producers[NUM_MPMC_THREADS], consumers[NUM_MPMC_THREADS];
+    MpmcWorker producer_args[NUM_MPMC_THREADS], consumer_args[NUM_MPMC_THREADS];
+    size_t i;
+    for (i = 0; i < NUM_MPMC_THREADS; i++) {
+        MpmcWorker worker = {queue, i, 0, 0, 1};
+        producer_args[i] = worker;
+        consumer_args[i] = worker;
+        pthread_create(&consumers[i], NULL, mpmc_consume, &consumer_args[i]);
+        pthread_create(&producers[i], NULL, mpmc_produce, &producer_args[i]);
+    }
+
+    size_t num_popped = 0, sum = 0;
+    int order_ok = 1;
+    for (i = 0; i < NUM_MPMC_THREADS; i++) {
+        pthread_join(producers[i], NULL);
+        pthread_join(consumers[i], NULL);
+        num_popped += consumer_args[i].num_popped;
+        sum += consumer_args[i].sum;
+        order_ok = order_ok && consumer_args[i].order_ok;
+    }
+
+    size_t n = NUM_MPMC_THREADS * ITEMS_PER_MPMC_PRODUCER;
+
+    int test_results[] = {
+        check("every item popped once", num_popped == n && sum == n * (n - 1) / 2),
+        check("each producer's items in order", order_ok),
+    };
+
+    free_mpmc_queue(queue);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *queue_tests = create_test_suite("queue tests");
+    suite_add_test(queue_tests, "spsc queue basic", spsc_queue_basic_test);
+    suite_add_test(queue_tests, "spsc queue threads", spsc_queue_threads_test);
+    suite_add_test(queue_tests, "mpmc queue basic", mpmc_queue_basic_test);
+    suite_add_test(queue_tests, "mpmc queue threads", mpmc_queue_threads_test);
+    run_test_suite(queue_tests, VERBOSE);
+    free_test_suite(queue_tests);
+
+    return 0;
+}
@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/string.h>
+#include <ilc/radix_tree.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+static String cstr_view(const char *cstr) {
+    String s;
+    s.chars = (char *)cstr;
+    s.len = strlen(cstr);
+    return s;
+}
+
+static int insert_cstr(RadixTree *tree, const char *key, void *value) {
+    String s = cstr_view(key);
+    return radix_tree_insert(tree, &s, value);
+}
+
+static int get_cstr(const RadixTree *tree, const char *key, void **value) {
+    String s = cstr_view(key);
+    return radix_tree_get(tree, &s, value);
+}
+
+static int longest_prefix_test_examples(const RadixTree *tree, const char *path,
+                                        int expected_found, size_t expected_len) {
+    String s = cstr_view(path);
+    size_t len = 0;
+    int found = radix_tree_longest_prefix(tree, &s, &len, NULL);
+
+    int ok = found == expected_found && (!found || len == expected_len);
+
+    if (VERBOSE) {
+        printf("    radix_tree_longest_prefix(\"%s\") %s\n", path,
+               ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+        if (!ok) {
+            printf("        " COLOR_TEXT(RED, "found %d (length %lu), expected %d (length %lu)") "\n",
+                   found, len, expected_found, expected_len);
+        }
+    }
+
+    return ok;
+}
+
+typedef struct {
+    char keys[16][16];
+    size_t num_keys;
+} Collected;
+
+static int collect_key(const String *key, void *value, void *ctx) {
+    Collected *collected = ctx;
+    (void) value;
+
+    memcpy(collected->keys[collected->num_keys], key->chars, key->len);
+    collected->keys[collected->num_keys][key->len] = '\0';
+    collected->num_keys++;
+
+    return collected->num_keys == 16;
+}
+
+static int iterate_prefix_test_examples(const RadixTree *tree, const char *prefix,
+                                        const char **expected, size_t num_expected) {
+    Collected collected;
+    collected.num_keys = 0;
+
+    String s = cstr_view(prefix);
+    int result = radix_tree_iterate_prefix(tree, &s, collect_key, &collected);
+
+    int ok = result == 0 && collected.num_keys == num_expected;
+    size_t i;
+    for (i = 0; ok && i < num_expected; i++) {
+        ok = strcmp(collected.keys[i], expected[i]) == 0;
+    }
+
+    if (VERBOSE) {
+        printf("    radix_tree_iterate_prefix(\"%s\") %s\n", prefix,
+               ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+        if (!ok) {
+            printf("        " RED "visited:");
+            for (i = 0; i < collected.num_keys; i++) {
+                printf(" \"%s\"", collected.keys[i]);
+            }
+            printf(END_COLOR "\n");
+        }
+    }
+
+    return ok;
+}
+
+static int radix_tree_get_test() {
+    RadixTree *tree = create_radix_tree();
+    int a = 1, b = 2, c = 3, d = 4;
+
+    insert_cstr(tree, "romane", &a);
+    insert_cstr(tree, "romanus", &b);
+    insert_cstr(tree, "rom", &c);
+    insert_cstr(tree, "", &d);
+    insert_cstr(tree, "rom", &a);  /* replaces */
+
+    void *value = NULL;
+    int test_results[] = {
+        check("length counts distinct keys", radix_tree_length(tree) == 4),
+        check("get romane", get_cstr(tree, "romane", &value) && value == &a),
+        check("get romanus", get_cstr(tree, "romanus", &value) && value == &b),
+        check("get replaced rom", get_cstr(tree, "rom", &value) && value == &a),
+        check("get empty key", get_cstr(tree, "", &value) && value == &d),
+        check("roman is only a path", !get_cstr(tree, "roman", NULL)),
+        check("romanes is missing", !get_cstr(tree, "romanes", NULL)),
+        check("ro is missing", !get_cstr(tree, "ro", NULL)),
+    };
+
+    free_radix_tree(tree);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int radix_tree_node_growth_test() {
+    RadixTree *tree = create_radix_tree();
+
+    /* 256 children under one node walks through every node size */
+    int ok = 1;
+    int i;
+    for (i = 255; i >= 0; i--) {
+        char key[2];
+        key[0] = 'x';
+        key[1] = (char) i;
+
+        String s;
+        s.chars = key;
+        s.len = 2;
+        ok = ok && radix_tree_insert(tree, &s, (void *)(long) (i + 1)) == 0;
+    }
+
+    for (i = 0; i < 256; i++) {
+        char key[2];
+        key[0] = 'x';
+        key[1] = (char) i;
+
+        String s;
+        s.chars = key;
+        s.len = 2;
+
+        void *value = NULL;
+        ok = ok && radix_tree_get(tree, &s, &value) && value == (void *)(long) (i + 1);
+    }
+
+    int test_results[] = {
+        check("insert and get 256 siblings", ok),
+        check("length is 256", radix_tree_length(tree) == 256),
+    };
+
+    free_radix_tree(tree);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int radix_tree_longest_prefix_test() {
+    const char *routes[] = {"/", "/api", "/api/v1/", "/static/"};
+    StringList list;
+    String strs[4];
+    size_t i;
+    for (i = 0; i < 4; i++) {
+        strs[i] = cstr_view(routes[i]);
+    }
+    list.strs = strs;
+    list.len = 4;
+
+    RadixTree *tree = create_radix_tree();
+    int insert_ok = radix_tree_insert_all(tree, &list, NULL) == 0;
+
+    int test_results[] = {
+        check("insert_all", insert_ok && radix_tree_length(tree) == 4),
+        longest_prefix_test_examples(tree, "/api/v1/users", 1, 8),
+        longest_prefix_test_examples(tree, "/api/v2/users", 1, 4),
+        longest_prefix_test_examples(tree, "/api", 1, 4),
+        longest_prefix_test_examples(tree, "/static", 1, 1),
+        longest_prefix_test_examples(tree, "/static/app.js", 1, 8),
+        longest_prefix_test_examples(tree, "api", 0, 0),
+        longest_prefix_test_examples(tree, "", 0, 0),
+    };
+
+    free_radix_tree(tree);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int radix_tree_iterate_prefix_test() {
+    RadixTree *tree = create_radix_tree();
+    const char *keys[] = {"team", "tea", "ten", "test", "toast", "to", "a", "tester"};
+    size_t i;
+    for (i = 0; i < 8; i++) {
+        insert_cstr(tree, keys[i], NULL);
+    }
+
+    const char *all[] = {"a", "tea", "team", "ten", "test", "tester", "to", "toast"};
+    const char *te[] = {"tea", "team", "ten", "test", "tester"};
+    const char *tes[] = {"test", "tester"};
+    const char *toa[] = {"toast"};
+
+    int test_results[] = {
+        iterate_prefix_test_examples(tree, "", all, 8),
+        iterate_prefix_test_examples(tree, "te", te, 5),
+        iterate_prefix_test_examples(tree, "tes", tes, 2),
+        iterate_prefix_test_examples(tree, "toa", toa, 1),
+        iterate_prefix_test_examples(tree, "tx", NULL, 0),
+        iterate_prefix_test_examples(tree, "toaster", NULL, 0),
+    };
+
+    free_radix_tree(tree);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *radix_tree_tests = create_test_suite("radix tree tests");
+    suite_add_test(radix_tree_tests, "radix tree get", radix_tree_get_test);
+    suite_add_test(radix_tree_tests, "radix tree node growth", radix_tree_node_growth_test);
+    suite_add_test(radix_tree_tests, "radix tree longest prefix", radix_tree_longest_prefix_test);
+    suite_add_test(radix_tree_tests, "radix tree iterate prefix", radix_tree_iterate_prefix_test);
+    run_test_suite(radix_tree_tests, VERBOSE);
+    free_test_suite(radix_tree_tests);
+
+    return 0;
+}
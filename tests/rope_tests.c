@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/string.h>
+#include <ilc/rope.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+static String cstr_view(const char *cstr) {
+    String s;
+    s.chars = (char *)cstr;
+    s.len = strlen(cstr);
+    return s;
+}
+
+static int rope_equals(const Rope *rope, const char *expected, size_t expected_len) {
+    String *flat = rope_to_string(rope);
+    int equal = flat != NULL && flat->len == expected_len &&
+                check_mem_equal(flat->chars, expected, expected_len);
+    free_string(flat);
+    return equal;
+}
+
+static int rope_edit_test() {
+    Rope *rope = create_rope();
+
+    String hello = cstr_view("hello world");
+    String comma = cstr_view(",");
+    String big = cstr_view("big ");
+
+    int edits_ok = rope_append(rope, &hello) == 0 &&
+                   rope_insert(rope, 5, &comma) == 0 &&
+                   rope_insert(rope, 7, &big) == 0;
+    int after_insert = rope_equals(rope, "hello, big world", 16);
+
+    edits_ok = edits_ok && rope_delete(rope, 0, 7) == 0 && rope_delete(rope, 3, 3) == 0;
+    int after_delete = rope_equals(rope, "big world", 9);
+
+    char c = 0;
+    int char_ok = rope_char_at(rope, 4, &c) == 0 && c == 'w';
+
+    String *sub = rope_substring(rope, 2, 6);
+    int sub_ok = sub != NULL && sub->len == 4 && check_mem_equal(sub->chars, "g wo", 4);
+    free_string(sub);
+
+    errno = 0;
+    int insert_oob = rope_insert(rope, 10, &comma) == EDOM && errno == EDOM;
+    errno = 0;
+    int delete_oob = rope_delete(rope, 5, 4) == EDOM && rope_delete(rope, 0, 10) == EDOM;
+    errno = 0;
+    int char_oob = rope_char_at(rope, 9, &c) == EDOM;
+    errno = 0;
+    int null_ok = rope_append(NULL, &comma) == EFAULT && errno == EFAULT;
+
+    int test_results[] = {
+        check("edits succeed", edits_ok),
+        check("insert", after_insert),
+        check("delete", after_delete),
+        check("char at", char_ok),
+        check("substring", sub_ok),
+        check("insert past end is EDOM", insert_oob),
+        check("bad delete ranges are EDOM", delete_oob),
+        check("char at end is EDOM", char_oob),
+        check("NULL rope is EFAULT", null_ok),
+    };
+
+    free_rope(rope);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+/* random edits big enough for many leaves and rebalancing, checked against a flat buffer */
+static int rope_random_edits_test() {
+    size_t capacity = 1 << 18;
+    char *model = malloc(capacity);
+    size_t model_len = 0;
+
+    char insert_chars[5000];
+    size_t i;
+    for (i = 0; i < sizeof(insert_chars); i++) {
+        insert_chars[i] = 'a' + i % 26;
+    }
+
+    Rope *rope = create_rope();
+    srand(4253);
+
+    int ok = 1;
+    int step;
+    for (step = 0; step < 2000 && ok; step++) {
+        if (model_len > 0 && rand() % 3 == 0) {
+            size_t start = rand() % model_len;
+            size_t end = start + rand() % (model_len - start + 1) % 3000;
+            ok = rope_delete(rope, start, end) == 0;
+
+            memmove(model + start, model + end, model_len - end);
+            model_len -= end - start;
+        } else {
+            String str;
+            str.chars = insert_chars + rand() % 26;
+            str.len = rand() % 4 == 0 ? rand() % 4000 : rand() % 20;
+            if (model_len + str.len > capacity) {
+                continue;
+            }
+
+            size_t index = rand() % (model_len + 1);
+            ok = rope_insert(rope, index, &str) == 0;
+
+            memmove(model + index + str.len, model + index, model_len - index);
+            memcpy(model + index, str.chars, str.len);
+            model_len += str.len;
+        }
+
+        ok = ok && rope_length(rope) == model_len;
+    }
+
+    int flat_ok = rope_equals(rope, model, model_len);
+
+    /* chunks concatenate back to the whole rope */
+    size_t cursor = 0, seen = 0;
+    String chunk;
+    int chunks_ok = 1;
+    while (rope_next_chunk(rope, &cursor, &chunk)) {
+        chunks_ok = chunks_ok && chunk.len > 0 && chunk.len <= ROPE_LEAF_SIZE &&
+                    check_mem_equal(chunk.chars, model + seen, chunk.len);
+        seen += chunk.len;
+    }
+    chunks_ok = chunks_ok && seen == model_len;
+
+    /* a chunk from the middle of a leaf starts at the cursor */
+    cursor = model_len / 2;
+    int mid_chunk_ok = model_len == 0 ||
+                       (rope_next_chunk(rope, &cursor, &chunk) && chunk.chars[0] == model[model_len / 2]);
+
+    int chars_ok = 1;
+    for (i = 0; i < model_len; i += 97) {
+        char c;
+        chars_ok = chars_ok && rope_char_at(rope, i, &c) == 0 && c == model[i];
+    }
+
+    int test_results[] = {
+        check("random edits", ok),
+        check("flatten matches", flat_ok),
+        check("iterate chunks", chunks_ok),
+        check("chunk from the middle", mid_chunk_ok),
+        check("char at", chars_ok),
+    };
+
+    free_rope(rope);
+    free(model);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *rope_tests = create_test_suite("rope tests");
+    suite_add_test(rope_tests, "rope edit", rope_edit_test);
+    suite_add_test(rope_tests, "rope random edits", rope_random_edits_test);
+    run_test_suite(rope_tests, VERBOSE);
+    free_test_suite(rope_tests);
+
+    return 0;
+}
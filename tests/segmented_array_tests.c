@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/segmented_array.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+static int segmented_array_append_test() {
+    SegmentedArray *arr = create_segmented_array(sizeof(size_t));
+
+    size_t first = 0;
+    int append_ok = segmented_array_append(arr, &first) == 0;
+    size_t *first_item = segmented_array_item_at(arr, 0);
+
+    size_t i;
+    for (i = 1; i < 100000; i++) {
+        append_ok = append_ok && segmented_array_append(arr, &i) == 0;
+    }
+
+    int items_ok = segmented_array_length(arr) == 100000;
+    for (i = 0; i < 100000 && items_ok; i++) {
+        size_t *item = segmented_array_item_at(arr, i);
+        items_ok = item != NULL && *item == i;
+    }
+
+    /* runs cover each block exactly once, in order */
+    size_t count, covered = 0, num_runs = 0;
+    int runs_ok = 1;
+    while (covered < 100000 && runs_ok) {
+        size_t *run = segmented_array_run(arr, covered, &count);
+        runs_ok = run != NULL && count > 0 && run[0] == covered && run[count - 1] == covered + count - 1;
+        covered += count;
+        num_runs++;
+    }
+    /* 16 + 32 + ... + 65536 = 131056 > 100000, that's 13 blocks */
+    runs_ok = runs_ok && covered == 100000 && num_runs == 13;
+
+    size_t mid_count;
+    int mid_ok = segmented_array_run(arr, 20, &mid_count) != NULL && mid_count == 28;
+
+    errno = 0;
+    int oob_ok = segmented_array_item_at(arr, 100000) == NULL && errno == EINVAL;
+    errno = 0;
+    int null_ok = segmented_array_append(NULL, &i) == EFAULT && errno == EFAULT;
+
+    int test_results[] = {
+        check("append", append_ok),
+        check("items", items_ok),
+        check("address stays the same", first_item == segmented_array_item_at(arr, 0) && *first_item == 0),
+        check("runs", runs_ok),
+        check("run from the middle of a block", mid_ok),
+        check("item at out of range is EINVAL", oob_ok),
+        check("NULL array is EFAULT", null_ok),
+    };
+
+    free_segmented_array(arr);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+#define NUM_CONCURRENT_ITEMS 200000
+
+static void *read_while_appending(void *arg) {
+    const SegmentedArray *arr = arg;
+    size_t *ok = malloc(sizeof(size_t));
+    *ok = 1;
+
+    size_t length = 0;
+    while (length < NUM_CONCURRENT_ITEMS && *ok) {
+        length = segmented_array_length(arr);
+        if (length > 0) {
+            size_t *last = segmented_array_item_at(arr, length - 1);
+            size_t *middle = segmented_array_item_at(arr, length / 2);
+            *ok = *last == length - 1 && *middle == length / 2;
+        }
+    }
+
+    return ok;
+}
+
+static int segmented_array_concurrent_read_test() {
+    SegmentedArray *arr = create_segmented_array(sizeof(size_t));
+
+    pthread_t readers[3];
+    size_t i;
+    for (i = 0; i < 3; i++) {
+        pthread_create(&readers[i], NULL, read_while_appending, arr);
+    }
+
+    int append_ok = 1;
+    for (i = 0; i < NUM_CONCURRENT_ITEMS; i++) {
+        append_ok = append_ok && segmented_array_append(arr, &i) == 0;
+    }
+
+    int readers_ok = 1;
+    for (i = 0; i < 3; i++) {
+        size_t *ok;
+        pthread_join(readers[i], (void **) &ok);
+        readers_ok = readers_ok && *ok;
+        free(ok);
+    }
+
+    int test_results[] = {
+        check("append", append_ok),
+        check("readers only see written items", readers_ok),
+    };
+
+    free_segmented_array(arr);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+#define NUM_PRODUCERS 4
+#define ITEMS_PER_PRODUCER 50000
+
+typedef struct {
+    SegmentedArray *arr;
+    size_t producer;
+} Producer;
+
+static void *produce(void *arg) {
+    Producer *producer = arg;
+    size_t *ok = malloc(sizeof(size_t));
+    *ok = 1;
+
+    size_t i;
+    for (i = 0; i < ITEMS_PER_PRODUCER; i++) {
+        size_t item = producer->producer * ITEMS_PER_PRODUCER + i;
+        *ok = *ok && segmented_array_append_concurrent(producer->arr, &item) == 0;
+    }
+
+    return ok;
+}
+
+static void *read_while_producing(void *arg) {
+    const SegmentedArray *arr = arg;
+    size_t *ok = malloc(sizeof(size_t));
+    *ok = 1;
+
+    size_t length = 0;
+    while (length < NUM_PRODUCERS * ITEMS_PER_PRODUCER && *ok) {
+        length = segmented_array_length(arr);
+        size_t i;
+        /* every item is below the total, so anything else means a reader saw an unwritten slot */
+        for (i = length > 64 ? length - 64 : 0; i < length && *ok; i++) {
+            *ok = *(size_t *) segmented_array_item_at(arr, i) < NUM_PRODUCERS * ITEMS_PER_PRODUCER;
+        }
+    }
+
+    return ok;
+}
+
+static int segmented_array_concurrent_append_test() {
+    SegmentedArray *arr = create_segmented_array(sizeof(size_t));
+
+    int reserve_ok = segmented_array_reserve(arr, 100) == 0 && segmented_array_length(arr) == 0;
+
+    pthread_t reader;
+    pthread_create(&reader, NULL, read_while_producing, arr);
+
+    pthread_t threads[NUM_PRODUCERS];
+    Producer producers[NUM_PRODUCERS];
+    size_t i;
+    for (i = 0; i < NUM_PRODUCERS; i++) {
+        producers[i].arr = arr;
+        producers[i].producer = i;
+        pthread_create(&threads[i], NULL, produce, &producers[i]);
+    }
+
+    int append_ok = 1;
+    for (i = 0; i < NUM_PRODUCERS; i++) {
+        size_t *ok;
+        pthread_join(threads[i], (void **) &ok);
+        append_ok = append_ok && *ok;
+        free(ok);
+    }
+
+    size_t *reader_ok;
+    pthread_join(reader, (void **) &reader_ok);
+
+    /* every item once, each producer's in order */
+    size_t next[NUM_PRODUCERS] = {0};
+    int items_ok = segmented_array_length(arr) == NUM_PRODUCERS * ITEMS_PER_PRODUCER;
+    for (i = 0; i < NUM_PRODUCERS * ITEMS_PER_PRODUCER && items_ok; i++) {
+        size_t item = *(size_t *) segmented_array_item_at(arr, i);
+        size_t producer = item / ITEMS_PER_PRODUCER;
+        items_ok = producer < NUM_PRODUCERS && item % ITEMS_PER_PRODUCER == next[producer]++;
+    }
+
+    int test_results[] = {
+        check("reserve", reserve_ok),
+        check("concurrent appends", append_ok),
+        check("readers only see written items", *reader_ok),
+        check("every item once and in order per thread", items_ok),
+    };
+
+    free(reader_ok);
+    free_segmented_array(arr);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *segmented_array_tests = create_test_suite("segmented array tests");
+    suite_add_test(segmented_array_tests, "segmented array append", segmented_array_append_test);
+    suite_add_test(segmented_array_tests, "segmented array concurrent read", segmented_array_concurrent_read_test);
+    suite_add_test(segmented_array_tests, "segmented array concurrent append",
+                   segmented_array_concurrent_append_test);
+    run_test_suite(segmented_array_tests, VERBOSE);
+    free_test_suite(segmented_array_tests);
+
+    return 0;
+}
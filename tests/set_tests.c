@@ -0,0 +1,337 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <ilc/hashset.h>
+#include <ilc/bitset.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+static size_t int_hash(const void *item) {
+    return hash_bytes(item, sizeof(int));
+}
+
+/* deliberately terrible hash so everything lands in one probe run */
+static size_t colliding_hash(const void *item) {
+    (void) item;
+    return 42;
+}
+
+static int int_equal(const void *item1, const void *item2) {
+    return *((const int *) item1) == *((const int *) item2);
+}
+
+static int hashset_add_test() {
+    HashSet *set = create_hashset(sizeof(int), int_hash, int_equal);
+
+    int added_all = 1;
+    int i;
+    for (i = 0; i < 1000; i++) {
+        added_all = added_all && hashset_add(set, &i) == 0;
+    }
+
+    int duplicate = 7;
+    int duplicate_result = hashset_add(set, &duplicate);
+
+    int contains_all = 1;
+    for (i = 0; i < 1000; i++) {
+        contains_all = contains_all && hashset_contains(set, &i);
+    }
+
+    int missing = 1000;
+
+    errno = 0;
+    hashset_add(NULL, &missing);
+    int null_errno = errno;
+
+    int test_results[] = {
+        check("add 1000 ints", added_all),
+        check("add duplicate returns EEXIST", duplicate_result == EEXIST),
+        check("length is 1000", hashset_length(set) == 1000),
+        check("contains every added int", contains_all),
+        check("doesn't contain missing int", !hashset_contains(set, &missing)),
+        check("NULL set sets EFAULT", null_errno == EFAULT),
+    };
+
+    free_hashset(set);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int hashset_remove_test_with(hash_fn hash) {
+    HashSet *set = create_hashset(sizeof(int), hash, int_equal);
+
+    int i;
+    for (i = 0; i < 100; i++) {
+        hashset_add(set, &i);
+    }
+
+    /* remove every third item, the rest must stay reachable after backward shifts */
+    for (i = 0; i < 100; i += 3) {
+        hashset_remove(set, &i);
+    }
+
+    int ok = hashset_length(set) == 66;
+    for (i = 0; i < 100; i++) {
+        ok = ok && hashset_contains(set, &i) == (i % 3 != 0);
+    }
+
+    size_t cursor = 0, seen = 0;
+    while (hashset_next(set, &cursor) != NULL) {
+        seen++;
+    }
+    ok = ok && seen == 66;
+
+    hashset_clear(set);
+    ok = ok && hashset_length(set) == 0 && !hashset_contains(set, &i);
+
+    free_hashset(set);
+    return ok;
+}
+
+static int hashset_remove_test() {
+    int test_results[] = {
+        check("remove with good hash", hashset_remove_test_with(int_hash)),
+        check("remove with colliding hash", hashset_remove_test_with(colliding_hash)),
+    };
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int bitset_ops_test() {
+    Bitset *a = create_bitset(200);
+    Bitset *b = create_bitset(200);
+    Bitset *small = create_bitset(10);
+
+    size_t i;
+    for (i = 0; i < 200; i += 2) {
+        bitset_set(a, i);
+    }
+    for (i = 0; i < 200; i += 3) {
+        bitset_set(b, i);
+    }
+
+    int count_ok = bitset_count(a) == 100 && bitset_count(b) == 67;
+
+    errno = 0;
+    bitset_set(a, 200);
+    int oob_errno = errno;
+
+    int size_mismatch = bitset_and(a, small) == EINVAL;
+
+    bitset_and(a, b);  /* multiples of 6 */
+    int and_ok = bitset_count(a) == 34 && bitset_test(a, 198) && !bitset_test(a, 3);
+
+    bitset_or(a, b);  /* multiples of 3 */
+    int or_ok = bitset_count(a) == 67;
+
+    bitset_xor(a, b);
+    int xor_ok = bitset_count(a) == 0;
+
+    bitset_clear(b, 3);
+    int clear_ok = !bitset_test(b, 3) && bitset_count(b) == 66;
+
+    int test_results[] = {
+        check("count", count_ok),
+        check("set out of range is EDOM", oob_errno == EDOM),
+        check("mismatched sizes are EINVAL", size_mismatch),
+        check("and", and_ok),
+        check("or", or_ok),
+        check("xor", xor_ok),
+        check("clear", clear_ok),
+    };
+
+    free_bitset(a);
+    free_bitset(b);
+    free_bitset(small);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int bitset_rank_select_test() {
+    Bitset *bits = create_bitset(5000);
+
+    size_t i;
+    for (i = 0; i < 5000; i += 7) {
+        bitset_set(bits, i);
+    }
+
+    int rank_ok = 1;
+    for (i = 0; i <= 5000; i++) {
+        rank_ok = rank_ok && bitset_rank(bits, i) == (i + 6) / 7;
+    }
+
+    int select_ok = 1;
+    size_t k;
+    for (k = 0; k < bitset_count(bits); k++) {
+        size_t pos;
+        select_ok = select_ok && bitset_select(bits, k, &pos) == 0 && pos == k * 7;
+    }
+
+    size_t pos;
+    int select_oob = bitset_select(bits, bitset_count(bits), &pos) == EDOM;
+
+    /* directory must be rebuilt after a change */
+    bitset_set(bits, 1);
+    int rebuilt_ok = bitset_rank(bits, 4999) == 715 + 1 && bitset_select(bits, 1, &pos) == 0 && pos == 1;
+
+    int test_results[] = {
+        check("rank", rank_ok),
+        check("select", select_ok),
+        check("select past last bit is EDOM", select_oob),
+        check("rank/select after modification", rebuilt_ok),
+    };
+
+    free_bitset(bits);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int roaring_test() {
+    RoaringBitmap *sparse = create_roaring_bitmap();
+    RoaringBitmap *dense = create_roaring_bitmap();
+
+    uint32_t v;
+    for (v = 0; v < 1000000; v += 1000) {
+        roaring_add(sparse, v);
+    }
+    /* over 4096 values in container 0 forces a bitmap container */
+    for (v = 0; v < 10000; v++) {
+        roaring_add(dense, v);
+    }
+    roaring_add(dense, 3000000);
+
+    int card_ok = roaring_cardinality(sparse) == 1000 && roaring_cardinality(dense) == 10001;
+    int contains_ok = roaring_contains(sparse, 5000) && !roaring_contains(sparse, 5001) &&
+                      roaring_contains(dense, 9999) && roaring_contains(dense, 3000000) &&
+                      !roaring_contains(dense, 10000);
+
+    RoaringBitmap *both = roaring_and(sparse, dense);
+    RoaringBitmap *either = roaring_or(sparse, dense);
+
+    uint32_t expected_and[] = {0, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000};
+    uint32_t actual_and[10];
+    int and_ok = roaring_cardinality(both) == 10 &&
+                 roaring_to_array(both, actual_and) == 10 &&
+                 check_mem_equal(actual_and, expected_and, sizeof(expected_and));
+
+    int or_ok = roaring_cardinality(either) == 10001 + 990 && roaring_contains(either, 999000);
+
+    uint32_t *values = malloc(roaring_cardinality(either) * sizeof(uint32_t));
+    size_t n = roaring_to_array(either, values);
+    size_t i;
+    int sorted = n == roaring_cardinality(either);
+    for (i = 1; i < n; i++) {
+        sorted = sorted && values[i - 1] < values[i];
+    }
+    free(values);
+
+    /* shrinking to 4000 keeps the bitmap container, below 3072 converts it to an array */
+    for (v = 0; v < 6000; v++) {
+        roaring_remove(dense, v);
+    }
+    roaring_remove(dense, 3000000);
+    int remove_ok = roaring_cardinality(dense) == 4000 && !roaring_contains(dense, 5999) &&
+                    roaring_contains(dense, 6000) && !roaring_contains(dense, 3000000);
+
+    for (v = 6000; v < 7000; v++) {
+        roaring_remove(dense, v);
+    }
+    remove_ok = remove_ok && roaring_cardinality(dense) == 3000 && !roaring_contains(dense, 6999) &&
+                roaring_contains(dense, 7000) && roaring_contains(dense, 9999);
+
+    /* adding and removing a value at the array limit, which switches containers */
+    RoaringBitmap *edge = create_roaring_bitmap();
+    for (v = 0; v < 4096; v++) {
+        roaring_add(edge, v * 2);
+    }
+    int edge_ok = 1;
+    int round;
+    for (round = 0; round < 100; round++) {
+        roaring_add(edge, 1);
+        edge_ok = edge_ok && roaring_cardinality(edge) == 4097 && roaring_contains(edge, 1);
+        roaring_remove(edge, 1);
+        edge_ok = edge_ok && roaring_cardinality(edge) == 4096 && !roaring_contains(edge, 1) &&
+                  roaring_contains(edge, 8190);
+    }
+
+    int test_results[] = {
+        check("cardinality", card_ok),
+        check("contains", contains_ok),
+        check("and", and_ok),
+        check("or", or_ok),
+        check("to_array is sorted", sorted),
+        check("remove", remove_ok),
+        check("add and remove at the array limit", edge_ok),
+    };
+
+    free_roaring_bitmap(edge);
+
+    free_roaring_bitmap(sparse);
+    free_roaring_bitmap(dense);
+    free_roaring_bitmap(both);
+    free_roaring_bitmap(either);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *set_tests = create_test_suite("set tests");
+    suite_add_test(set_tests, "hashset add", hashset_add_test);
+    suite_add_test(set_tests, "hashset remove", hashset_remove_test);
+    suite_add_test(set_tests, "bitset ops", bitset_ops_test);
+    suite_add_test(set_tests, "bitset rank/select", bitset_rank_select_test);
+    suite_add_test(set_tests, "roaring bitmap", roaring_test);
+    run_test_suite(set_tests, VERBOSE);
+    free_test_suite(set_tests);
+
+    return 0;
+}
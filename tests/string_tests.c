@@ -5,6 +5,7 @@
 #include <string.h>
 #include <ilc/string.h>
 #include <ilc/test.h>
+#include <ilc/alloc.h>
 
 
 int VERBOSE = 0;
@@ -593,6 +594,80 @@ static int string_contains_at_test_examples(const char *cstr, size_t len,
     return test_ok;
 }
 
+static int string_replace_all_test_examples(const char *cstr, const char *csubstr,
+                                            const char *creplacement, const char *cexpected,
+                                            size_t expected_count, int expected_errno) {
+    String *str = cstr == NULL ? NULL : create_string(cstr, strlen(cstr));
+    String *substr = create_string(csubstr, strlen(csubstr));
+    String *replacement = create_string(creplacement, strlen(creplacement));
+    String *expected = cexpected == NULL ? NULL : create_string(cexpected, strlen(cexpected));
+
+    errno = 0;
+    String *replaced = string_replace_all(str, substr, replacement);
+    int errno_val = errno;
+
+    errno = 0;
+    size_t count = string_count(str, substr);
+    int count_errno = errno;
+
+    DynArray *offsets = create_dynarray(sizeof(size_t));
+    int find_result = string_find_all(str, substr, offsets);
+
+    int str_ok = (expected_errno == 0) ? string_equal(replaced, expected) : replaced == NULL;
+    int errno_ok = errno_val == expected_errno && count_errno == expected_errno &&
+                   find_result == expected_errno;
+    int count_ok = count == expected_count && dynarray_length(offsets) == expected_count;
+
+    /* offsets must be real, increasing, and non-overlapping occurrences */
+    int offsets_ok = 1;
+    size_t i;
+    for (i = 0; i < dynarray_length(offsets); i++) {
+        size_t offset = *(size_t *) dynarray_item_at(offsets, i);
+        offsets_ok = offsets_ok && offset + substr->len <= str->len &&
+                     check_mem_equal(str->chars + offset, substr->chars, substr->len);
+        if (i > 0) {
+            size_t previous = *(size_t *) dynarray_item_at(offsets, i - 1);
+            offsets_ok = offsets_ok && previous + substr->len <= offset;
+        }
+    }
+
+    int test_ok = str_ok && errno_ok && count_ok && offsets_ok;
+
+    if (VERBOSE) {
+        const char *result = test_ok ?
+            COLOR_TEXT(GREEN, "passed") :
+            COLOR_TEXT(RED, "failed");
+        printf("    string_replace_all(\"%s\", \"%s\", \"%s\") %s\n",
+               cstr, csubstr, creplacement, result);
+
+        if (!str_ok) {
+            printf("        " RED "returned ");
+            string_print(replaced);
+            printf(", expected %s" END_COLOR "\n", cexpected);
+        }
+        if (!errno_ok) {
+            printf("        " COLOR_TEXT(RED, "errnos were %d, %d, %d, expected %d") "\n",
+                   errno_val, count_errno, find_result, expected_errno);
+        }
+        if (!count_ok) {
+            printf("        " COLOR_TEXT(RED, "counted %lu (find_all %lu), expected %lu") "\n",
+                   count, dynarray_length(offsets), expected_count);
+        }
+        if (!offsets_ok) {
+            printf("        " COLOR_TEXT(RED, "find_all reported a bad offset") "\n");
+        }
+    }
+
+    free_dynarray(offsets);
+    free_string(str);
+    free_string(substr);
+    free_string(replacement);
+    free_string(expected);
+    free_string(replaced);
+
+    return test_ok;
+}
+
 static int string_concat_prop_helper(const char *prop_name,
                                      const String *first, const String *second,
                                      const String *expected, int expected_errno) {
@@ -944,6 +1019,62 @@ static int string_split_test_examples(const char *cstr, size_t len,
     return test_ok;
 }
 
+/* builds unit repeated until at least min_len chars, then checks parallel and serial splits agree */
+static int string_split_parallel_test_examples(const char *unit, size_t min_len,
+                                               const char *cdelim, size_t num_threads) {
+    size_t unit_len = strlen(unit);
+    size_t len = 0;
+    char *chars = malloc(min_len + unit_len);
+    while (len < min_len) {
+        memcpy(chars + len, unit, unit_len);
+        len += unit_len;
+    }
+
+    String str;
+    str.chars = chars;
+    str.len = len;
+
+    String delim;
+    delim.chars = (char *)cdelim;
+    delim.len = strlen(cdelim);
+
+    StringList *serial = string_split(&str, &delim);
+    StringList *parallel = string_split_parallel(&str, &delim, num_threads);
+
+    /* identical means the same views, not just equal strings */
+    int test_ok = serial != NULL && parallel != NULL && serial->len == parallel->len;
+    size_t i;
+    for (i = 0; test_ok && i < serial->len; i++) {
+        test_ok = serial->strs[i].chars == parallel->strs[i].chars &&
+                  serial->strs[i].len == parallel->strs[i].len;
+    }
+
+    if (VERBOSE) {
+        const char *result = test_ok ?
+            COLOR_TEXT(GREEN, "passed") :
+            COLOR_TEXT(RED, "failed");
+        printf("    string_split_parallel(\"%s\"..., \"%s\", %lu) %s\n", unit, cdelim, num_threads,
+               result);
+
+        if (!test_ok && serial != NULL && parallel != NULL) {
+            printf("        " COLOR_TEXT(RED, "%lu strings, expected %lu (first difference at %lu)") "\n",
+                   parallel->len, serial->len, i - 1);
+        }
+    }
+
+    if (serial != NULL) {
+        free(serial->strs);
+        free(serial);
+    }
+    if (parallel != NULL) {
+        free(parallel->strs);
+        free(parallel);
+    }
+    free(chars);
+
+    return test_ok;
+}
+
 static int string_join_test_examples(const char *cdelim, size_t delim_len,
                                      const StringList *list,
                                      const char *cexpected, size_t expected_len,
@@ -1059,6 +1190,107 @@ static int string_trim_test_examples(const char *cstr, size_t len,
                                    expected_errno);
 }
 
+/* adapts string_trim_whitespace to string_trim_test_helper */
+static String *trim_whitespace_ignoring_list(const String *str, const StringList *to_trim) {
+    (void) to_trim;
+    return string_trim_whitespace(str);
+}
+
+static int string_trim_whitespace_test_examples(const char *cstr, size_t len,
+                                                const char *cexpected, size_t expected_len,
+                                                int expected_errno) {
+    return string_trim_test_helper(trim_whitespace_ignoring_list, "string_trim_whitespace",
+                                   cstr, len, NULL, cexpected, expected_len,
+                                   expected_errno);
+}
+
+static int string_trim_view_test_examples(const StringTrimmer *trimmer, const char *cstr,
+                                          int sides, const char *cexpected) {
+    String str;
+    str.chars = (char *)cstr;
+    str.len = strlen(cstr);
+
+    String view = {NULL, 0};
+    int result = string_trim_view(&str, trimmer, sides, &view);
+
+    int test_ok = result == 0 && view.len == strlen(cexpected) &&
+                  check_mem_equal(view.chars, cexpected, view.len) &&
+                  view.chars >= str.chars && view.chars + view.len <= str.chars + str.len;
+
+    if (VERBOSE) {
+        const char *status = test_ok ?
+            COLOR_TEXT(GREEN, "passed") :
+            COLOR_TEXT(RED, "failed");
+        printf("    string_trim_view(\"%s\", %d) %s\n", cstr, sides, status);
+
+        if (!test_ok) {
+            printf("        " RED "returned %d with view ", result);
+            string_print(&view);
+            printf(", expected \"%s\"" END_COLOR "\n", cexpected);
+        }
+    }
+
+    return test_ok;
+}
+
+static int string_matcher_test_examples(const StringList *patterns,
+                                        const char *cstr, size_t len,
+                                        int expected_found, size_t expected_start,
+                                        size_t expected_pattern, size_t expected_count) {
+    String *str = create_string(cstr, len);
+    StringMatcher *matcher = create_string_matcher(patterns);
+
+    StringMatch match = {0, 0};
+    int found = string_matcher_find(matcher, str, &match);
+    size_t count = string_matcher_count(matcher, str);
+
+    DynArray *matches = create_dynarray(sizeof(StringMatch));
+    string_matcher_find_all(matcher, str, matches);
+
+    int found_ok = found == expected_found;
+    int match_ok = !found || (match.start == expected_start && match.pattern == expected_pattern);
+    int count_ok = count == expected_count && dynarray_length(matches) == expected_count;
+
+    /* every reported match must really be there */
+    int matches_ok = 1;
+    size_t i;
+    for (i = 0; i < dynarray_length(matches); i++) {
+        StringMatch *m = dynarray_item_at(matches, i);
+        const String *p = &patterns->strs[m->pattern];
+        matches_ok = matches_ok && m->start + p->len <= str->len &&
+                     check_mem_equal(str->chars + m->start, p->chars, p->len);
+    }
+
+    int test_ok = found_ok && match_ok && count_ok && matches_ok;
+
+    if (VERBOSE) {
+        const char *result = test_ok ?
+            COLOR_TEXT(GREEN, "passed") :
+            COLOR_TEXT(RED, "failed");
+        printf("    matching ");
+        string_list_print(patterns);
+        printf(" in \"%s\" %s\n", cstr, result);
+
+        if (!found_ok || !match_ok) {
+            printf("        " COLOR_TEXT(RED, "found %d at %lu (pattern %lu), expected %d at %lu (pattern %lu)") "\n",
+                   found, match.start, match.pattern, expected_found, expected_start, expected_pattern);
+        }
+        if (!count_ok) {
+            printf("        " COLOR_TEXT(RED, "counted %lu (find_all %lu), expected %lu") "\n",
+                   count, dynarray_length(matches), expected_count);
+        }
+        if (!matches_ok) {
+            printf("        " COLOR_TEXT(RED, "find_all reported a match that isn't there") "\n");
+        }
+    }
+
+    free_dynarray(matches);
+    free_string_matcher(matcher);
+    free_string(str);
+
+    return test_ok;
+}
+
 static int tally_test_results(int *results, int num_tests) {
     int final_result = 1;
     int i;
@@ -1205,6 +1437,24 @@ static int string_contains_test() {
     return tally_test_results(test_results, num_tests);
 }
 
+static int string_replace_all_test() {
+    int test_results[] = {
+        string_replace_all_test_examples(NULL, "a", "b", NULL, 0, EFAULT),
+        string_replace_all_test_examples("abc", "", "b", NULL, 0, EINVAL),
+        string_replace_all_test_examples("", "a", "b", "", 0, 0),
+        string_replace_all_test_examples("abc", "abcd", "x", "abc", 0, 0),
+        string_replace_all_test_examples("a,b,,c", ",", ", ", "a, b, , c", 3, 0),
+        string_replace_all_test_examples("a, b, , c", ", ", "", "abc", 3, 0),
+        string_replace_all_test_examples("aaaaa", "aa", "b", "bba", 2, 0),
+        string_replace_all_test_examples("abababc", "abc", "X", "ababX", 1, 0),
+        string_replace_all_test_examples("aabaabaaab", "aab", "_", "__a_", 3, 0),
+        string_replace_all_test_examples("I <3 C", "I <3 C", "", "", 1, 0),
+    };
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
 static int string_concat_test() {
     int test_results[] = {
         string_concat_test_properties(NULL, 0),
@@ -1310,6 +1560,75 @@ static int string_split_test() {
     return tally_test_results(test_results, num_tests);
 }
 
+#ifdef ILC_TRACK_ALLOCS
+/* the list and its strings are the only blocks left, the strings' chars point into str */
+static int string_split_allocations_test() {
+    String *str = create_string("list of words", 13);
+    String *space = create_string(" ", 1);
+
+    AllocStats before = alloc_stats();
+    StringList *list = string_split(str, space);
+    AllocStats split = alloc_stats_diff(before, alloc_stats());
+
+    free(list->strs);
+    free(list);
+    AllocStats freed = alloc_stats_diff(before, alloc_stats());
+
+    int kept_ok = split.allocations - split.frees == 2;
+    int freed_ok = freed.allocations == freed.frees;
+    if (VERBOSE) {
+        printf("    string_split keeps 2 blocks %s (%lu allocations, %lu frees)\n",
+               kept_ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"),
+               split.allocations, split.frees);
+        printf("    freeing the list and its strings frees them all %s\n",
+               freed_ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    free_string(str);
+    free_string(space);
+
+    return kept_ok && freed_ok ? SUCCESS : FAILURE;
+}
+#endif
+
+static int string_split_parallel_test() {
+    String wads = {NULL, 4};
+    String comma = {NULL, 1};
+    char wads_chars[] = "wads";
+    char comma_char = ',';
+    wads.chars = wads_chars;
+    comma.chars = &comma_char;
+
+    errno = 0;
+    int null_ok = string_split_parallel(NULL, &comma, 2) == NULL && errno == EFAULT;
+    errno = 0;
+    int bigger_ok = string_split_parallel(&comma, &wads, 2) == NULL && errno == EINVAL;
+
+    if (VERBOSE) {
+        printf("    string_split_parallel errors %s\n",
+               null_ok && bigger_ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    int test_results[] = {
+        null_ok && bigger_ok,
+        string_split_parallel_test_examples("a,b,,c\n", 1 << 20, ",", 4),
+        string_split_parallel_test_examples("a,b,,c\n", 1 << 20, ",", 0),
+        string_split_parallel_test_examples("a,b,,c\n", 100, ",", 4),
+        string_split_parallel_test_examples("key: value\r\n", 1 << 19, "\r\n", 3),
+        string_split_parallel_test_examples("nothing to see here ", 1 << 19, "|", 5),
+
+        /* delims that overlap themselves straddle chunk edges in every way */
+        string_split_parallel_test_examples("aaab", 1 << 19, "aa", 3),
+        string_split_parallel_test_examples("aaaaaab", 1 << 19, "aaa", 7),
+        string_split_parallel_test_examples("a", (1 << 19) + 1, "aa", 3),
+        string_split_parallel_test_examples("a", (1 << 19) + 1, "aa", 8),
+        string_split_parallel_test_examples("abab", 1 << 19, "aba", 6),
+    };
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
 static int string_join_test() {
     const char *words[] = {"list", "of", "words"};
     size_t word_lens[] = {4, 2, 5};
@@ -1358,6 +1677,20 @@ static int string_ltrim_test() {
     size_t one[] = {1};
     StringList *one_space = create_string_list(space, one, 1);
 
+    const char *prefixes[] = {"ab", "abc"};
+    size_t prefix_lens[] = {2, 3};
+    StringList *ab_abc = create_string_list(prefixes, prefix_lens, 2);
+
+    /* the longest prefix made of patterns isn't found by taking the longest pattern each step */
+    const char *overlapping[] = {"a", "ab", "bc"};
+    size_t overlapping_lens[] = {1, 2, 2};
+    StringList *a_ab_bc = create_string_list(overlapping, overlapping_lens, 3);
+
+    /* longer than the ring trimming keeps on the stack */
+    const char *long_patterns[] = {"0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef", "-"};
+    size_t long_lens[] = {64, 1};
+    StringList *long_pattern = create_string_list(long_patterns, long_lens, 2);
+
     int test_results[] = {
         string_ltrim_test_examples(NULL, 0, one_space, NULL, 0, EFAULT),
         string_ltrim_test_examples("wads", 4, NULL, NULL, 0, EFAULT),
@@ -1367,6 +1700,11 @@ static int string_ltrim_test() {
         string_ltrim_test_examples("a  wads", 7, one_space, "a  wads", 7, 0),
         string_ltrim_test_examples("abcabcwords hereabc", 19, abc, "words hereabc", 13, 0),
         string_ltrim_test_examples("aabbccwords hereabc", 19, abc, "words hereabc", 13, 0),
+        string_ltrim_test_examples("abcabxyz", 8, ab_abc, "xyz", 3, 0),
+        string_ltrim_test_examples("abc", 3, a_ab_bc, "", 0, 0),
+        string_ltrim_test_examples("ababcd", 6, a_ab_bc, "d", 1, 0),
+        string_ltrim_test_examples("0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef-0x", 67,
+                                   long_pattern, "0x", 2, 0),
     };
 
     int num_tests = sizeof(test_results) / sizeof(int);
@@ -1382,6 +1720,14 @@ static int string_rtrim_test() {
     size_t one[] = {1};
     StringList *one_space = create_string_list(space, one, 1);
 
+    const char *suffixes[] = {"bc", "ab"};
+    size_t suffix_lens[] = {2, 2};
+    StringList *bc_ab = create_string_list(suffixes, suffix_lens, 2);
+
+    const char *overlapping[] = {"c", "bc", "ab"};
+    size_t overlapping_lens[] = {1, 2, 2};
+    StringList *c_bc_ab = create_string_list(overlapping, overlapping_lens, 3);
+
     int test_results[] = {
         string_rtrim_test_examples(NULL, 0, one_space, NULL, 0, EFAULT),
         string_rtrim_test_examples("wads", 4, NULL, NULL, 0, EFAULT),
@@ -1391,6 +1737,8 @@ static int string_rtrim_test() {
         string_rtrim_test_examples("wads  a", 7, one_space, "wads  a", 7, 0),
         string_rtrim_test_examples("abcwords hereabcabc", 19, abc, "abcwords here", 13, 0),
         string_rtrim_test_examples("abcwords hereaabbcc", 19, abc, "abcwords here", 13, 0),
+        string_rtrim_test_examples("xyzbcab", 7, bc_ab, "xyz", 3, 0),
+        string_rtrim_test_examples("xyzabc", 6, c_bc_ab, "xyz", 3, 0),
     };
 
     int num_tests = sizeof(test_results) / sizeof(int);
@@ -1406,6 +1754,10 @@ static int string_trim_test() {
     size_t one[] = {1};
     StringList *one_space = create_string_list(space, one, 1);
 
+    const char *overlapping[] = {"a", "ab", "bc"};
+    size_t overlapping_lens[] = {1, 2, 2};
+    StringList *a_ab_bc = create_string_list(overlapping, overlapping_lens, 3);
+
     int test_results[] = {
         string_trim_test_examples(NULL, 0, one_space, NULL, 0, EFAULT),
         string_trim_test_examples("wads", 4, NULL, NULL, 0, EFAULT),
@@ -1415,12 +1767,195 @@ static int string_trim_test() {
         string_trim_test_examples("wads  a", 7, one_space, "wads  a", 7, 0),
         string_trim_test_examples("abcwords hereabcabc", 19, abc, "words here", 10, 0),
         string_trim_test_examples("abcwords hereaabbcc", 19, abc, "words here", 10, 0),
+        string_trim_test_examples("abcxyzabc", 9, a_ab_bc, "xyz", 3, 0),
     };
 
     int num_tests = sizeof(test_results) / sizeof(int);
     return tally_test_results(test_results, num_tests);
 }
 
+static int string_matcher_test() {
+    const char *words[] = {"he", "she", "his", "hers"};
+    size_t word_lens[] = {2, 3, 3, 4};
+    StringList *hers = create_string_list(words, word_lens, 4);
+
+    const char *nested[] = {"bc", "abcd", "c"};
+    size_t nested_lens[] = {2, 4, 1};
+    StringList *overlapping = create_string_list(nested, nested_lens, 3);
+
+    const char *with_empty[] = {"", "aa"};
+    size_t with_empty_lens[] = {0, 2};
+    StringList *empty_and_aa = create_string_list(with_empty, with_empty_lens, 2);
+
+    errno = 0;
+    StringMatcher *null_matcher = create_string_matcher(NULL);
+    int null_ok = null_matcher == NULL && errno == EFAULT;
+    if (VERBOSE) {
+        printf("    create_string_matcher(NULL) %s\n",
+               null_ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    int test_results[] = {
+        null_ok,
+        string_matcher_test_examples(hers, "ushers", 6, 1, 1, 1, 3),
+        string_matcher_test_examples(hers, "ahishers", 8, 1, 1, 2, 4),
+        string_matcher_test_examples(hers, "nothing", 7, 0, 0, 0, 0),
+        string_matcher_test_examples(hers, "", 0, 0, 0, 0, 0),
+        string_matcher_test_examples(overlapping, "xabcd", 5, 1, 1, 1, 3),
+        string_matcher_test_examples(overlapping, "cbc", 3, 1, 0, 2, 3),
+        string_matcher_test_examples(empty_and_aa, "aaaa", 4, 1, 0, 1, 3),
+    };
+
+    free_string_list(hers);
+    free_string_list(overlapping);
+    free_string_list(empty_and_aa);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int string_trimmer_test() {
+    const char *punct[] = {" ", ",", ";"};
+    size_t punct_lens[] = {1, 1, 1};
+    StringList *separators = create_string_list(punct, punct_lens, 3);
+
+    const char *pairs[] = {"ab", "ba", "-"};
+    size_t pair_lens[] = {2, 2, 1};
+    StringList *ab_ba = create_string_list(pairs, pair_lens, 3);
+
+    /* longer than the trimmer's ring on the stack */
+    char long_x[70], long_input[150];
+    memset(long_x, 'x', sizeof(long_x));
+    memset(long_input, 'x', 140);
+    strcpy(long_input + 140, "xyxz");
+    const char *long_patterns[] = {long_x, "y"};
+    size_t long_lens[] = {sizeof(long_x), 1};
+    StringList *long_list = create_string_list(long_patterns, long_lens, 2);
+
+    StringTrimmer *byte_trimmer = create_string_trimmer(separators);
+    StringTrimmer *pair_trimmer = create_string_trimmer(ab_ba);
+    StringTrimmer *long_trimmer = create_string_trimmer(long_list);
+
+    String *padded = create_string(" ,x y;; ", 8);
+    String *trimmed = string_trim_with(padded, byte_trimmer);
+    String *expected = create_string("x y", 3);
+    int trim_with_ok = string_equal(trimmed, expected);
+    if (VERBOSE) {
+        printf("    string_trim_with(\" ,x y;; \") %s\n",
+               trim_with_ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    errno = 0;
+    StringTrimmer *null_trimmer = create_string_trimmer(NULL);
+    int null_ok = null_trimmer == NULL && errno == EFAULT &&
+                  string_trim_view(padded, NULL, STRING_TRIM_BOTH, NULL) == EFAULT;
+    if (VERBOSE) {
+        printf("    NULL trimmer arguments %s\n",
+               null_ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    int test_results[] = {
+        trim_with_ok,
+        null_ok,
+        string_trim_view_test_examples(byte_trimmer, ";; a,b ,", STRING_TRIM_BOTH, "a,b"),
+        string_trim_view_test_examples(byte_trimmer, ";; a,b ,", STRING_TRIM_LEFT, "a,b ,"),
+        string_trim_view_test_examples(byte_trimmer, ";; a,b ,", STRING_TRIM_RIGHT, ";; a,b"),
+        string_trim_view_test_examples(byte_trimmer, " ;,", STRING_TRIM_BOTH, ""),
+        string_trim_view_test_examples(pair_trimmer, "ab-baxaab", STRING_TRIM_BOTH, "xa"),
+        string_trim_view_test_examples(pair_trimmer, "aba", STRING_TRIM_BOTH, ""),
+        string_trim_view_test_examples(pair_trimmer, "aba", STRING_TRIM_LEFT, "a"),
+        string_trim_view_test_examples(long_trimmer, long_input, STRING_TRIM_LEFT, "xyxz"),
+        string_trim_view_test_examples(long_trimmer, long_input + 71, STRING_TRIM_LEFT, "xz"),
+        string_trim_whitespace_test_examples(NULL, 0, NULL, 0, EFAULT),
+        string_trim_whitespace_test_examples(" \t\r\nwads here\v\f ", 16, "wads here", 9, 0),
+        string_trim_whitespace_test_examples("wads", 4, "wads", 4, 0),
+        string_trim_whitespace_test_examples(" \n ", 3, "", 0, 0),
+        string_trim_whitespace_test_examples("", 0, "", 0, 0),
+    };
+
+    free_string(padded);
+    free_string(trimmed);
+    free_string(expected);
+    free_string_trimmer(byte_trimmer);
+    free_string_trimmer(pair_trimmer);
+    free_string_trimmer(long_trimmer);
+    free_string_list(separators);
+    free_string_list(ab_ba);
+    free_string_list(long_list);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static int write_test_file(const char *path, const char *contents, size_t len) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return 0;
+    }
+
+    int ok = fwrite(contents, 1, len, f) == len;
+    return fclose(f) == 0 && ok;
+}
+
+static int string_map_file_test() {
+    const char *path = "string_map_file_test.tmp";
+    const char *contents = "first line\nsecond line\nthird line\n";
+    size_t len = strlen(contents);
+
+    int wrote = write_test_file(path, contents, len);
+    String *mapped = string_map_file(path, STRING_MAP_SEQUENTIAL | STRING_MAP_WILLNEED);
+    int map_ok = wrote && mapped != NULL && mapped->len == len &&
+                 check_mem_equal(mapped->chars, contents, len);
+
+    char newline_char = '\n';
+    String newline = {&newline_char, 1};
+    StringList *lines = map_ok ? string_split(mapped, &newline) : NULL;
+    int split_ok = lines != NULL && lines->len == 4 && lines->strs[1].len == 11 &&
+                   lines->strs[1].chars == mapped->chars + 11;
+    if (lines != NULL) {
+        free(lines->strs);
+        free(lines);
+    }
+
+    int unmap_ok = string_unmap_file(mapped) == 0;
+
+    wrote = write_test_file(path, "", 0);
+    String *empty = string_map_file(path, STRING_MAP_HUGEPAGE);
+    int empty_ok = wrote && empty != NULL && empty->len == 0 && string_unmap_file(empty) == 0;
+
+    remove(path);
+
+    errno = 0;
+    int missing_ok = string_map_file(path, 0) == NULL && errno == ENOENT;
+    errno = 0;
+    int dir_ok = string_map_file(".", 0) == NULL && errno == EINVAL;
+    errno = 0;
+    int null_ok = string_map_file(NULL, 0) == NULL && errno == EFAULT;
+
+    int test_results[] = {
+        map_ok,
+        split_ok,
+        unmap_ok,
+        empty_ok,
+        missing_ok,
+        dir_ok,
+        null_ok,
+    };
+
+    if (VERBOSE) {
+        const char *names[] = {"map file", "split mapped file in place", "unmap file", "map empty file",
+                               "missing file is ENOENT", "directory is EINVAL", "NULL path is EFAULT"};
+        size_t i;
+        for (i = 0; i < sizeof(test_results) / sizeof(int); i++) {
+            printf("    %s %s\n", names[i],
+                   test_results[i] ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+        }
+    }
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
 int main(int argc, char **argv) {
     if (argc == 2) {
         if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
@@ -1452,13 +1987,21 @@ int main(int argc, char **argv) {
     suite_add_test(string_tests, "string equal", string_equal_test);
     suite_add_test(string_tests, "string compare", string_compare_test);
     suite_add_test(string_tests, "string contains", string_contains_test);
+    suite_add_test(string_tests, "string replace all", string_replace_all_test);
     suite_add_test(string_tests, "string concat", string_concat_test);
     suite_add_test(string_tests, "string append", string_append_test);
     suite_add_test(string_tests, "string split", string_split_test);
+    suite_add_test(string_tests, "string split parallel", string_split_parallel_test);
     suite_add_test(string_tests, "string join", string_join_test);
     suite_add_test(string_tests, "string ltrim", string_ltrim_test);
     suite_add_test(string_tests, "string rtrim", string_rtrim_test);
     suite_add_test(string_tests, "string trim", string_trim_test);
+    suite_add_test(string_tests, "string matcher", string_matcher_test);
+    suite_add_test(string_tests, "string trimmer", string_trimmer_test);
+    suite_add_test(string_tests, "string map file", string_map_file_test);
+#ifdef ILC_TRACK_ALLOCS
+    suite_add_test(string_tests, "string split allocations", string_split_allocations_test);
+#endif
     run_test_suite(string_tests, VERBOSE);
     free_test_suite(string_tests);
 
@@ -0,0 +1,136 @@
+#define _POSIX_C_SOURCE 200809L  /* fileno, dup, dup2, pause */
+
+#include <stdio.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ilc/test.h>
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+static int crashing_test() {
+    printf("printed before crashing\n");
+    raise(SIGSEGV);
+    return SUCCESS;
+}
+
+static int hanging_test() {
+    printf("printed before hanging\n");
+    for (;;) {
+        pause();  /* until killed by the timeout */
+    }
+    return SUCCESS;
+}
+
+/* run suite verbosely, returning everything it wrote to stdout as one string */
+static char *run_suite_output(TestSuite *suite) {
+    FILE *out = tmpfile();
+    if (out == NULL) {
+        return NULL;
+    }
+
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(fileno(out), STDOUT_FILENO);
+
+    run_test_suite(suite, 1);
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    fseek(out, 0, SEEK_END);
+    long size = ftell(out);
+    char *text = malloc(size + 1);
+    rewind(out);
+    if (text == NULL || fread(text, 1, size, out) != (size_t) size) {
+        free(text);
+        fclose(out);
+        return NULL;
+    }
+
+    text[size] = '\0';
+    fclose(out);
+
+    if (VERBOSE) {
+        printf("%s", text);
+    }
+
+    return text;
+}
+
+static int runner_output_test() {
+    TestSuite *crashing = create_test_suite("crashing");
+    suite_add_test(crashing, "crash", crashing_test);
+    char *crash_text = run_suite_output(crashing);
+    free_test_suite(crashing);
+
+    TestSuite *hanging = create_test_suite("hanging");
+    suite_add_test(hanging, "hang", hanging_test);
+    suite_set_timeout(hanging, 0.2);
+    char *hang_text = run_suite_output(hanging);
+    free_test_suite(hanging);
+
+    int test_results[] = {
+        check("output of a crashed test shown", crash_text != NULL && strstr(crash_text, "printed before crashing") != NULL),
+        check("output of a timed out test shown", hang_text != NULL && strstr(hang_text, "printed before hanging") != NULL),
+    };
+
+    free(crash_text);
+    free(hang_text);
+
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *test_tests = create_test_suite("test runner tests");
+    suite_add_test(test_tests, "runner output", runner_output_test);
+    run_test_suite(test_tests, VERBOSE);
+    free_test_suite(test_tests);
+
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ilc/trace.h>
+#include <ilc/test.h>
+
+/* trace_begin and trace_end are called directly, so these run with or without TRACE */
+#define NUM_THREADS 4
+#define SPANS_PER_THREAD 100
+
+
+int VERBOSE = 0;
+
+
+static int check(const char *what, int ok) {
+    if (VERBOSE) {
+        printf("    %s %s\n", what, ok ? COLOR_TEXT(GREEN, "passed") : COLOR_TEXT(RED, "failed"));
+    }
+
+    return ok;
+}
+
+static int tally_test_results(int *results, int num_tests) {
+    int final_result = 1;
+    int i;
+    for (i = 0; i < num_tests; i++) {
+        final_result = final_result && results[i];
+    }
+
+    return final_result ? SUCCESS : FAILURE;
+}
+
+/* the whole dump as one string, or NULL if it couldn't be written */
+static char *dump_trace(void) {
+    FILE *out = tmpfile();
+    if (out == NULL || trace_write_chrome_json(out) != 0) {
+        return NULL;
+    }
+
+    long size = ftell(out);
+    char *json = malloc(size + 1);
+    rewind(out);
+    if (json == NULL || fread(json, 1, size, out) != (size_t) size) {
+        free(json);
+        fclose(out);
+        return NULL;
+    }
+
+    json[size] = '\0';
+    fclose(out);
+    return json;
+}
+
+static size_t count_occurrences(const char *haystack, const char *needle) {
+    size_t count = 0;
+    const char *at;
+    for (at = strstr(haystack, needle); at != NULL; at = strstr(at + 1, needle)) {
+        count++;
+    }
+
+    return count;
+}
+
+static int trace_spans_test() {
+    trace_begin("outer span");
+    trace_begin("inner span");
+    trace_end();
+    trace_end();
+
+    char *json = dump_trace();
+    if (json == NULL) {
+        return FAILURE;
+    }
+
+    if (VERBOSE) {
+        printf("    %lu byte dump\n", strlen(json));
+    }
+
+    const char *outer = strstr(json, "\"outer span\"");
+    const char *inner = strstr(json, "\"inner span\"");
+    int test_results[] = {
+        check("dump is an object of trace events", strncmp(json, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [", 42) == 0),
+        check("both begins recorded", outer != NULL && inner != NULL),
+        check("begins in order", outer != NULL && inner != NULL && outer < inner),
+        check("begins and ends match", count_occurrences(json, "\"ph\": \"B\"") == count_occurrences(json, "\"ph\": \"E\"")),
+        check("dump ends the array", strstr(json, "\n]}\n") != NULL),
+        check("NULL out fails", trace_write_chrome_json(NULL) == EFAULT),
+    };
+
+    free(json);
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static void *trace_spans(void *arg) {
+    (void) arg;
+    int i;
+    for (i = 0; i < SPANS_PER_THREAD; i++) {
+        trace_begin("thread span");
+        trace_end();
+    }
+
+    return NULL;
+}
+
+static int trace_threads_test() {
+    pthread_t threads[NUM_THREADS];
+    int i;
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_create(&threads[i], NULL, trace_spans, NULL);
+    }
+    for (i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    char *json = dump_trace();
+    if (json == NULL) {
+        return FAILURE;
+    }
+
+    /* threads may reuse an exited thread's ring, so count the lanes spans landed in */
+    int lanes[NUM_THREADS + 1] = {0};
+    int num_lanes = 0;
+    const char *at;
+    for (at = strstr(json, "\"thread span\""); at != NULL; at = strstr(at + 1, "\"thread span\"")) {
+        int tid = atoi(strstr(at, "\"tid\": ") + 7);
+        int seen = 0;
+        for (i = 0; i < num_lanes; i++) {
+            seen = seen || lanes[i] == tid;
+        }
+        if (!seen && num_lanes <= NUM_THREADS) {
+            lanes[num_lanes++] = tid;
+        }
+    }
+
+    size_t spans = count_occurrences(json, "\"thread span\"");
+    if (VERBOSE) {
+        printf("    %lu spans in %d lanes\n", spans, num_lanes);
+    }
+
+    int test_results[] = {
+        check("every span recorded", spans == NUM_THREADS * SPANS_PER_THREAD),
+        check("no more lanes than threads", num_lanes >= 1 && num_lanes <= NUM_THREADS),
+    };
+
+    free(json);
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+static void *overflow_ring(void *arg) {
+    (void) arg;
+    trace_begin("lost span");
+    trace_end();
+
+    int i;
+    for (i = 0; i < TRACE_RING_SIZE; i++) {
+        trace_begin("kept span");
+        trace_end();
+    }
+
+    return NULL;
+}
+
+static int trace_wraparound_test() {
+    pthread_t thread;
+    pthread_create(&thread, NULL, overflow_ring, NULL);
+    pthread_join(thread, NULL);
+
+    char *json = dump_trace();
+    if (json == NULL) {
+        return FAILURE;
+    }
+
+    size_t kept = count_occurrences(json, "\"kept span\"");
+    if (VERBOSE) {
+        printf("    %lu of %d spans kept\n", kept, TRACE_RING_SIZE);
+    }
+
+    int test_results[] = {
+        check("oldest events overwritten", strstr(json, "\"lost span\"") == NULL),
+        check("ring holds its size in events", kept == TRACE_RING_SIZE / 2),
+    };
+
+    free(json);
+    int num_tests = sizeof(test_results) / sizeof(int);
+    return tally_test_results(test_results, num_tests);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 2) {
+        if (strcmp(argv[1], "-v") == 0 || strcmp(argv[1], "--verbose") == 0) {
+            VERBOSE = 1;
+        } else if (strcmp(argv[1], "--help") == 0) {
+            printf(
+                "Usage: %s [-v|--verbose|--help]\n"
+                "    -v, --verbose\n"
+                "        Show more details about each test\n"
+                "    --help\n"
+                "        Print this help message and exit\n",
+                argv[0]
+            );
+            exit(EXIT_SUCCESS);
+        } else {
+            fprintf(stderr, "%s: Invalid argument \"%s\"\n", argv[0], argv[1]);
+            exit(EXIT_FAILURE);
+        }
+    } else if (argc > 2) {
+        fprintf(stderr, "%s: Too many arguments\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    TestSuite *trace_tests = create_test_suite("trace tests");
+    suite_add_test(trace_tests, "trace spans", trace_spans_test);
+    suite_add_test(trace_tests, "trace threads", trace_threads_test);
+    suite_add_test(trace_tests, "trace wraparound", trace_wraparound_test);
+    run_test_suite(trace_tests, VERBOSE);
+    free_test_suite(trace_tests);
+
+    return 0;
+}